@@ -11,6 +11,7 @@
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <stdexcept>
 #include <csignal>
 
@@ -73,8 +74,10 @@ int nextcomposite(int n) {
 BufferSetImpl::BufferSetImpl(Type architecture)
     : m_taper(aocommon::xt::CreateSpan<float, 2>(nullptr, {0, 0})),
       m_stokes_I_only(false),
+      m_real_fft(true),
       m_nr_correlations(4),
       m_nr_polarizations(4),
+      m_architecture(architecture),
       m_proxy(create_proxy(architecture)),
       m_shift({0, 0}),
       m_get_image_watch(Stopwatch::create()),
@@ -153,14 +156,76 @@ std::unique_ptr<proxy::Proxy> BufferSetImpl::create_proxy(Type architecture) {
   return proxy;
 }
 
+std::unique_ptr<Plan> BufferSetImpl::make_plan(
+    const int kernel_size, const aocommon::xt::Span<float, 1>& frequencies,
+    const aocommon::xt::Span<UVW<float>, 2>& uvw,
+    const aocommon::xt::Span<std::pair<unsigned int, unsigned int>, 1>&
+        baselines,
+    const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
+    const Plan::Options& options) const {
+  Plan::Options plan_options = options;
+  plan_options.subgrid_order = m_subgrid_order;
+  plan_options.subgrid_order_nr_baselines = m_subgrid_order_nr_baselines;
+
+  if (!m_plan_cache) {
+    return m_proxy->make_plan(kernel_size, frequencies, uvw, baselines,
+                              aterm_offsets, plan_options);
+  }
+
+  // Planning is serialized, since it may update the state of the w-tiles
+  std::lock_guard<std::mutex> lock(m_plan_cache_mutex);
+  WTiles* wtiles = m_proxy->get_plan_wtiles();
+
+  // The plan depends on the inputs, on the settings of the grid and the
+  // subgrids, and on the state of the w-tiles
+  PlanKey key;
+  key.add(m_architecture);
+  key.add(kernel_size);
+  key.add(frequencies.data(), frequencies.size() * sizeof(float));
+  key.add(uvw.shape(0));
+  key.add(uvw.shape(1));
+  key.add(uvw.data(), uvw.size() * sizeof(UVW<float>));
+  key.add(baselines.data(),
+          baselines.size() * sizeof(std::pair<unsigned int, unsigned int>));
+  key.add(aterm_offsets.data(), aterm_offsets.size() * sizeof(unsigned int));
+  key.add(plan_options.w_step);
+  key.add(plan_options.nr_w_layers);
+  key.add(plan_options.plan_strict);
+  key.add(plan_options.max_nr_timesteps_per_subgrid);
+  key.add(plan_options.max_nr_channels_per_subgrid);
+  key.add(plan_options.mode);
+  key.add(plan_options.subgrid_order);
+  key.add(plan_options.subgrid_order_nr_baselines);
+  const auto& grid = m_proxy->get_grid();
+  for (size_t dimension = 0; dimension < 4; dimension++) {
+    key.add(grid.shape(dimension));
+  }
+  key.add(m_subgridsize);
+  key.add(m_cell_size);
+  key.add(m_w_step);
+  key.add(m_shift);
+  if (wtiles) {
+    // WTiles::clear resets the state, such that the buffers of the next major
+    // cycle find the same states, and thereby the same keys, again
+    std::ostringstream wtiles_state;
+    wtiles->save(wtiles_state);
+    const std::string state = wtiles_state.str();
+    key.add(state.data(), state.size());
+  }
+
+  std::unique_ptr<Plan> plan = m_plan_cache->find(key.get(), wtiles);
+  if (!plan) {
+    plan = m_proxy->make_plan(kernel_size, frequencies, uvw, baselines,
+                              aterm_offsets, plan_options);
+    m_plan_cache->insert(key.get(), *plan, wtiles);
+  }
+  return plan;
+}
+
 aocommon::xt::Span<std::complex<float>, 4> BufferSetImpl::allocate_grid() {
   m_proxy->free_grid();
-  aocommon::xt::Span<std::complex<float>, 4> grid =
-      m_proxy->allocate_span<std::complex<float>, 4>(
-          {static_cast<size_t>(m_nr_w_layers),
-           static_cast<size_t>(m_nr_polarizations), m_padded_size,
-           m_padded_size});
-  grid.fill(std::complex<float>(0, 0));
+  aocommon::xt::Span<std::complex<float>, 4> grid = m_proxy->allocate_grid(
+      m_nr_w_layers, m_nr_polarizations, m_padded_size, m_padded_size);
   m_proxy->set_grid(grid);
   return grid;
 }
@@ -174,6 +239,28 @@ void BufferSetImpl::init(size_t size, float cell_size, float max_w,
     m_stokes_I_only = options["stokes_I_only"];
   }
 
+  m_real_fft = true;
+  if (options.count("real_fft")) {
+    m_real_fft = options["real_fft"];
+  }
+
+  m_subgrid_order = Plan::BASELINE_ORDER;
+  if (options.count("subgrid_order")) {
+    const std::string subgrid_order =
+        options["subgrid_order"].as<std::string>();
+    if (subgrid_order == "morton") {
+      m_subgrid_order = Plan::MORTON_ORDER;
+    } else if (subgrid_order == "hilbert") {
+      m_subgrid_order = Plan::HILBERT_ORDER;
+    } else if (subgrid_order != "baseline") {
+      throw std::invalid_argument("Unknown subgrid order: " + subgrid_order);
+    }
+  }
+  m_subgrid_order_nr_baselines = 0;
+  if (options.count("subgrid_order_nr_baselines")) {
+    m_subgrid_order_nr_baselines = (int)options["subgrid_order_nr_baselines"];
+  }
+
   if (m_stokes_I_only) {
     m_nr_correlations = 2;
     m_nr_polarizations = 1;
@@ -214,6 +301,64 @@ void BufferSetImpl::init(size_t size, float cell_size, float max_w,
                                  options["disable_wstacking"]);
   m_proxy->set_disable_wtiling(options.count("disable_wtiling") &&
                                options["disable_wtiling"]);
+  const int wtile_size =
+      options.count("wtile_size") ? (int)options["wtile_size"] : 0;
+  const size_t wtile_buffer_bytes =
+      options.count("wtile_buffer_bytes")
+          ? (size_t)options["wtile_buffer_bytes"]
+          : 0;
+  m_proxy->set_wtile_options(wtile_size, wtile_buffer_bytes);
+  if (options.count("wtile_flush_queue_size")) {
+    m_proxy->set_wtile_flush_queue_size(
+        (int)options["wtile_flush_queue_size"]);
+  }
+  if (options.count("wtile_prefetch_depth")) {
+    m_proxy->set_wtile_prefetch_depth((int)options["wtile_prefetch_depth"]);
+  }
+
+  auxiliary::NumaPolicy numa_policy = auxiliary::NumaPolicy::kDefault;
+  if (options.count("numa_policy")) {
+    const std::string policy = options["numa_policy"].as<std::string>();
+    if (policy == "interleaved") {
+      numa_policy = auxiliary::NumaPolicy::kInterleaved;
+    } else if (policy == "row_bands") {
+      numa_policy = auxiliary::NumaPolicy::kRowBands;
+    } else if (policy != "default") {
+      throw std::invalid_argument("Unknown NUMA policy: " + policy);
+    }
+  }
+  auxiliary::HugePages huge_pages = auxiliary::HugePages::kNone;
+  if (options.count("huge_pages")) {
+    const std::string pages = options["huge_pages"].as<std::string>();
+    if (pages == "transparent") {
+      huge_pages = auxiliary::HugePages::kTransparent;
+    } else if (pages == "explicit") {
+      huge_pages = auxiliary::HugePages::kExplicit;
+    } else if (pages != "none") {
+      throw std::invalid_argument("Unknown huge pages option: " + pages);
+    }
+  }
+  m_proxy->set_memory_policy(numa_policy, huge_pages);
+
+  std::string scratch_directory;
+  if (options.count("scratch_directory")) {
+    scratch_directory = options["scratch_directory"].as<std::string>();
+  }
+  size_t scratch_buffer_size = size_t(1) << 30;
+  if (options.count("scratch_buffer_size")) {
+    scratch_buffer_size = (size_t)options["scratch_buffer_size"];
+  }
+  m_proxy->set_scratch_directory(scratch_directory, scratch_buffer_size);
+
+  const bool plan_cache = options.count("plan_cache") && options["plan_cache"];
+  std::string plan_cache_directory;
+  if (options.count("plan_cache_directory")) {
+    plan_cache_directory = options["plan_cache_directory"].as<std::string>();
+  }
+  m_plan_cache.reset();
+  if (plan_cache || !plan_cache_directory.empty()) {
+    m_plan_cache.reset(new PlanCache(plan_cache_directory));
+  }
 
   //
   m_cell_size = cell_size;
@@ -383,13 +528,15 @@ void BufferSetImpl::set_image(const double* image, bool do_scale) {
   const size_t nr_w_layers = grid.shape(0);
   const size_t y0 = (m_padded_size - m_size) / 2;
   const size_t x0 = (m_padded_size - m_size) / 2;
+  const bool real_fft = use_real_fft();
+  const size_t real_stride = get_real_fft_stride(m_padded_size);
 
   // Convert from stokes to linear into w plane 0
 #if ENABLE_VERBOSE_TIMING
   std::cout << "set grid from image" << std::endl;
 #endif
+  // The grid was already zeroed by allocate_grid
   double runtime_stacking = -omp_get_wtime();
-  grid.fill(std::complex<float>(0, 0));
 #pragma omp parallel
   {
     typedef float arr_float_1D_t[m_size];
@@ -516,14 +663,28 @@ void BufferSetImpl::set_image(const double* image, bool do_scale) {
           }    // end for pol
         }
 
-        // Set m_grid
-        for (int pol = 0; pol < m_nr_polarizations; pol++) {
+        // Set m_grid, the fftshift is folded into this copy, see fft2f
+        const size_t grid_y = get_shifted_index(y + y0, m_padded_size);
+        if (real_fft) {
+          // Real image, in the layout of the in-place real-to-complex FFT
+          float* image_row = reinterpret_cast<float*>(&grid(w, 0, 0, 0)) +
+                             grid_y * real_stride;
           for (int x = 0; x < m_size; x++) {
-            float value_real = w_row_real[pol][x];
-            float value_imag = w_row_imag[pol][x];
-            grid(w, pol, y + y0, x + x0) = {value_real, value_imag};
+            const size_t grid_x = get_shifted_index(x + x0, m_padded_size);
+            image_row[grid_x] =
+                get_checkerboard_sign(grid_y, grid_x) * w_row_real[0][x];
           }  // end for x
-        }    // end for pol
+        } else {
+          for (int pol = 0; pol < m_nr_polarizations; pol++) {
+            for (int x = 0; x < m_size; x++) {
+              const size_t grid_x = get_shifted_index(x + x0, m_padded_size);
+              const float sign = get_checkerboard_sign(grid_y, grid_x);
+              float value_real = sign * w_row_real[pol][x];
+              float value_imag = sign * w_row_imag[pol][x];
+              grid(w, pol, grid_y, grid_x) = {value_real, value_imag};
+            }  // end for x
+          }    // end for pol
+        }
       }      // end for w
     }        // end for y
     free(w0_row_real);
@@ -544,9 +705,25 @@ void BufferSetImpl::set_image(const double* image, bool do_scale) {
 #if ENABLE_VERBOSE_TIMING
   std::cout << "fft w_layers";
 #endif
+  // Only the rows that contain the image are non-zero
   int batch = nr_w_layers * m_nr_polarizations;
+  const int first_row = get_shifted_index(y0, m_padded_size);
   double runtime_fft = -omp_get_wtime();
-  fft2f(batch, m_padded_size, m_padded_size, grid.data());
+  if (m_proxy->is_grid_out_of_core()) {
+    fft2f_out_of_core(batch, m_padded_size, m_padded_size, grid.data(), -1,
+                      false, {1.0f, 1.0f}, m_proxy->get_scratch_buffer_size());
+  } else {
+    for (int i = 0; i < batch; i++) {
+      std::complex<float>* data =
+          grid.data() + i * m_padded_size * m_padded_size;
+      if (real_fft) {
+        fft2f_real_pruned(m_padded_size, m_padded_size, data, first_row,
+                          m_size);
+      } else {
+        fft2f_pruned(m_padded_size, m_padded_size, data, first_row, m_size);
+      }
+    }
+  }
   runtime_fft += omp_get_wtime();
 #if ENABLE_VERBOSE_TIMING
   std::cout << ", runtime: " << runtime_fft << std::endl;
@@ -593,14 +770,35 @@ void BufferSetImpl::get_image(double* image) {
 
   const size_t y0 = (m_padded_size - m_size) / 2;
   const size_t x0 = (m_padded_size - m_size) / 2;
+  const bool real_fft = use_real_fft();
+  const size_t real_stride = get_real_fft_stride(m_padded_size);
 
   // Fourier transform w layers
 #if ENABLE_VERBOSE_TIMING
   std::cout << "ifft w_layers";
 #endif
+  // Only the rows that contain the image are computed, and for Stokes I only
+  // the real part of the image
   int batch = nr_w_layers * nr_polarizations;
+  const int first_row = get_shifted_index(y0, m_padded_size);
   double runtime_fft = -omp_get_wtime();
-  idg::ifft2f(batch, m_padded_size, m_padded_size, grid.data());
+  if (m_proxy->is_grid_out_of_core()) {
+    idg::fft2f_out_of_core(batch, m_padded_size, m_padded_size, grid.data(), 1,
+                           false, {1.0f, 1.0f},
+                           m_proxy->get_scratch_buffer_size());
+  } else {
+    for (int i = 0; i < batch; i++) {
+      std::complex<float>* data =
+          grid.data() + i * m_padded_size * m_padded_size;
+      if (real_fft) {
+        idg::ifft2f_real_pruned(m_padded_size, m_padded_size, data, first_row,
+                                m_size);
+      } else {
+        idg::ifft2f_pruned(m_padded_size, m_padded_size, data, first_row,
+                           m_size);
+      }
+    }
+  }
   runtime_fft += omp_get_wtime();
 #if ENABLE_VERBOSE_TIMING
   std::cout << ", runtime: " << runtime_fft << std::endl;
@@ -642,11 +840,28 @@ void BufferSetImpl::get_image(double* image) {
         inverse_taper[x] = m_inv_taper[y] * m_inv_taper[x];
       }
 
-      if (!m_apply_wstack_correction) {
+      // The fftshift is folded into the copies from the grid, see ifft2f
+      const size_t grid_y = get_shifted_index(y + y0, m_padded_size);
+
+      if (real_fft) {
+        // Compute current row of w-plane, from the real image
+        const float* image_row =
+            reinterpret_cast<const float*>(&grid(0, 0, 0, 0)) +
+            grid_y * real_stride;
+        for (int x = 0; x < m_size; x++) {
+          const size_t grid_x = get_shifted_index(x + x0, m_padded_size);
+          const float value =
+              get_checkerboard_sign(grid_y, grid_x) * image_row[grid_x];
+          w0_row_real[0][x] = value * inverse_taper[x];
+          w0_row_imag[0][x] = 0.0f;
+        }  // end for x
+      } else if (!m_apply_wstack_correction) {
         // Compute current row of w-plane
         for (int pol = 0; pol < nr_polarizations; pol++) {
           for (int x = 0; x < m_size; x++) {
-            auto value = grid(0, pol, y + y0, x + x0);
+            const size_t grid_x = get_shifted_index(x + x0, m_padded_size);
+            auto value = get_checkerboard_sign(grid_y, grid_x) *
+                         grid(0, pol, grid_y, grid_x);
             w0_row_real[pol][x] = value.real() * inverse_taper[x];
             w0_row_imag[pol][x] = value.imag() * inverse_taper[x];
           }  // end for x
@@ -661,7 +876,9 @@ void BufferSetImpl::get_image(double* image) {
           // Copy current row of w-plane
           for (int pol = 0; pol < nr_polarizations; pol++) {
             for (int x = 0; x < m_size; x++) {
-              auto value = grid(w, pol, y + y0, x + x0);
+              const size_t grid_x = get_shifted_index(x + x0, m_padded_size);
+              auto value = get_checkerboard_sign(grid_y, grid_x) *
+                           grid(w, pol, grid_y, grid_x);
               w_row_real[pol][x] = value.real();
               w_row_imag[pol][x] = value.imag();
             }  // end for pol
@@ -957,6 +1174,10 @@ void BufferSetImpl::unset_matrix_inverse_beam() {
 void BufferSetImpl::report_runtime() {
   std::clog << "avg beam:   " << m_avg_beam_watch->ToString() << std::endl;
   std::clog << "plan:       " << m_plan_watch->ToString() << std::endl;
+  if (m_plan_cache) {
+    std::clog << "plan cache: " << m_plan_cache->get_nr_hits() << " hits, "
+              << m_plan_cache->get_nr_misses() << " misses" << std::endl;
+  }
   std::clog << "gridding:   " << m_gridding_watch->ToString() << std::endl;
   std::clog << "degridding: " << m_degridding_watch->ToString() << std::endl;
   std::clog << "set image:  " << m_set_image_watch->ToString() << std::endl;
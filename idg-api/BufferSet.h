@@ -54,6 +54,54 @@ class BufferSet {
    *                       "max_nr_w_layers"
    *                       "padded_size"
    *                       "padding"
+   *                       "real_fft" (use real-to-complex grid FFTs for
+   *                       Stokes I imaging, enabled by default)
+   *                       "scratch_directory" (keep the grid in a
+   *                       memory-mapped file in this directory, e.g. on
+   *                       local NVMe, and transform it out of core)
+   *                       "scratch_buffer_size" (memory in bytes used by
+   *                       the out-of-core transform, 1 GiB by default)
+   *                       "plan_cache" (reuse the plans of buffers with
+   *                       the same uvw coordinates, baselines and
+   *                       frequencies, e.g. in later major cycles)
+   *                       "plan_cache_directory" (enables the plan cache,
+   *                       and stores the plans in this directory, such that
+   *                       later runs can reuse them as well)
+   *                       "subgrid_order" ("baseline" (default),
+   *                       "morton" or "hilbert", the order of the subgrids
+   *                       along a space-filling curve over the grid, for
+   *                       the locality of the adder and the w-tiles)
+   *                       "subgrid_order_nr_baselines" (number of
+   *                       consecutive baselines whose subgrids are
+   *                       reordered together, all baselines by default)
+   *                       "wtile_size" (size of the w-tiles in pixels,
+   *                       128 by default, w-tiling on the CPU only)
+   *                       "wtile_buffer_bytes" (memory budget for the
+   *                       w-tile buffer in bytes, at least four w-tiles,
+   *                       by default the w-tiles cover half of the grid,
+   *                       w-tiling on the CPU only. Every pending flush
+   *                       and prefetch, see below, keeps a copy of the
+   *                       w-tiles of one update event on top of this
+   *                       budget, usually a tenth of the w-tiles)
+   *                       "wtile_flush_queue_size" (number of w-tile
+   *                       flushes that are added to the grid in the
+   *                       background while gridding continues, 2 by
+   *                       default, 0 to flush synchronously)
+   *                       "wtile_prefetch_depth" (number of w-tile
+   *                       initializations that are computed in the
+   *                       background ahead of degridding, 1 by default,
+   *                       0 to disable prefetching)
+   *                       "numa_policy" ("default", "interleaved" or
+   *                       "row_bands", the placement of the grid and
+   *                       buffers on the NUMA nodes: by the thread that
+   *                       first touches them, interleaved over all nodes,
+   *                       or for the grid in bands of rows, each touched
+   *                       by one thread)
+   *                       "huge_pages" ("none" (default), "transparent"
+   *                       or "explicit", back the grid and buffers with
+   *                       2 MB transparent huge pages, or with reserved
+   *                       huge pages when available; buffers smaller than
+   *                       2 MB use regular pages)
    *
    */
   virtual void init(size_t width, float cellsize, float max_w, float shiftl,
@@ -6,12 +6,14 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "idg-common.h"
 #include "idg-external.h"
 
 #include "BufferSet.h"
+#include "PlanCache.h"
 
 namespace idg {
 namespace api {
@@ -89,13 +91,39 @@ class BufferSetImpl : public virtual BufferSet {
 
   proxy::Proxy& get_proxy() const { return *m_proxy; }
 
+  /**
+   * Make a plan with the proxy, see proxy::Proxy::make_plan. When the plan
+   * cache is enabled, a plan for the same inputs and settings is reused.
+   */
+  std::unique_ptr<Plan> make_plan(
+      const int kernel_size, const aocommon::xt::Span<float, 1>& frequencies,
+      const aocommon::xt::Span<UVW<float>, 2>& uvw,
+      const aocommon::xt::Span<std::pair<unsigned int, unsigned int>, 1>&
+          baselines,
+      const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
+      const Plan::Options& options) const;
+
+  //! The plan cache used by make_plan, nullptr when it is disabled
+  const PlanCache* get_plan_cache() const { return m_plan_cache.get(); }
+
  private:
   std::unique_ptr<proxy::Proxy> create_proxy(Type architecture);
 
   aocommon::xt::Span<std::complex<float>, 4> allocate_grid();
   void free_grid();
 
+  // For Stokes I without w-stacking correction the image is real, such that
+  // the grid FFTs can be done as real-to-complex and complex-to-real FFTs.
+  // The out-of-core FFTs only support the complex layout.
+  bool use_real_fft() const {
+    return m_real_fft && m_stokes_I_only && !m_apply_wstack_correction &&
+           !m_proxy->is_grid_out_of_core();
+  }
+
+  Type m_architecture;
   std::unique_ptr<proxy::Proxy> m_proxy;
+  std::unique_ptr<PlanCache> m_plan_cache;
+  mutable std::mutex m_plan_cache_mutex;
   BufferSetType m_buffer_set_type;
   std::vector<std::unique_ptr<GridderBufferImpl>> m_gridderbuffers;
   std::vector<std::unique_ptr<DegridderBuffer>> m_degridderbuffers;
@@ -108,6 +136,9 @@ class BufferSetImpl : public virtual BufferSet {
   std::shared_ptr<std::vector<float>> m_scalar_beam;
   std::shared_ptr<std::vector<std::complex<float>>> m_matrix_inverse_beam;
   bool m_stokes_I_only;
+  bool m_real_fft;
+  Plan::SubgridOrder m_subgrid_order;
+  unsigned m_subgrid_order_nr_baselines;
   int m_nr_correlations;
   int m_nr_polarizations;
   size_t m_subgridsize;
@@ -103,9 +103,11 @@ void BulkDegridderImpl::compute_visibilities(
   auto aterm_offsets_span = aocommon::xt::CreateSpan<unsigned int, 1>(
       local_aterm_offsets, {local_aterm_offsets.size()});
 
-  // If aterms is empty, create default values and update the pointer.
+  // If aterms is empty and the proxy does not support identity aterms, create
+  // default values and update the pointer.
+  const bool identity_aterms = !aterms && proxy.supports_identity_aterms();
   std::vector<Matrix2x2<std::complex<float>>> default_aterms;
-  if (!aterms) {
+  if (!aterms && !identity_aterms) {
     default_aterms.resize(nr_stations_ * subgridsize * subgridsize,
                           {{1}, {0}, {0}, {1}});
     aterms = reinterpret_cast<std::complex<float>*>(default_aterms.data());
@@ -117,7 +119,8 @@ void BulkDegridderImpl::compute_visibilities(
   using Aterm = Matrix2x2<std::complex<float>>;
   auto aterms_span = aocommon::xt::CreateSpan<Aterm, 4>(
       reinterpret_cast<Aterm*>(const_cast<std::complex<float>*>(aterms)),
-      {aterm_offsets_span.size() - 1, nr_stations_, subgridsize, subgridsize});
+      {identity_aterms ? 0 : aterm_offsets_span.size() - 1, nr_stations_,
+       subgridsize, subgridsize});
 
   // Set Plan options
   Plan::Options options;
@@ -129,9 +132,9 @@ void BulkDegridderImpl::compute_visibilities(
 
   // Create plan
   bufferset_.get_watch(BufferSetImpl::Watch::kPlan).Start();
-  std::unique_ptr<Plan> plan =
-      proxy.make_plan(bufferset_.get_kernel_size(), frequencies_, bufferUVW,
-                      bufferStationPairs, aterm_offsets_span, options);
+  std::unique_ptr<Plan> plan = bufferset_.make_plan(
+      bufferset_.get_kernel_size(), frequencies_, bufferUVW, bufferStationPairs,
+      aterm_offsets_span, options);
   bufferset_.get_watch(BufferSetImpl::Watch::kPlan).Pause();
 
   // Run degridding
@@ -117,9 +117,9 @@ void DegridderBufferImpl::flush() {
 
   // Create plan
   m_bufferset.get_watch(BufferSetImpl::Watch::kPlan).Start();
-  std::unique_ptr<Plan> plan =
-      proxy.make_plan(m_bufferset.get_kernel_size(), m_frequencies, m_bufferUVW,
-                      m_bufferStationPairs, aterm_offsets_span, options);
+  std::unique_ptr<Plan> plan = m_bufferset.make_plan(
+      m_bufferset.get_kernel_size(), m_frequencies, m_bufferUVW,
+      m_bufferStationPairs, aterm_offsets_span, options);
   m_bufferset.get_watch(BufferSetImpl::Watch::kPlan).Pause();
 
   // Run degridding
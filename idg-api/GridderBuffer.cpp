@@ -151,6 +151,13 @@ void GridderBufferImpl::flush_thread_worker() {
 
   const size_t subgridsize = m_bufferset.get_subgridsize();
 
+  proxy::Proxy& proxy = m_bufferset.get_proxy();
+
+  // Without aterms, pass an empty aterms span when the proxy supports it, such
+  // that the aterm computations are skipped. Otherwise use identity aterms.
+  const bool identity_aterms =
+      !m_bufferset.get_apply_aterm() && proxy.supports_identity_aterms();
+
   auto aterm_offsets_span =
       m_bufferset.get_apply_aterm()
           ? aocommon::xt::CreateSpan<unsigned int, 1>(m_aterm_offsets2.data(),
@@ -165,11 +172,9 @@ void GridderBufferImpl::flush_thread_worker() {
                 m_aterms2.data(), {m_aterm_offsets2.size() - 1, m_nrStations,
                                    subgridsize, subgridsize})
           : aocommon::xt::CreateSpan<Matrix2x2<std::complex<float>>, 4>(
-                m_default_aterms.data(),
-                {m_default_aterm_offsets.size() - 1, m_nrStations, subgridsize,
-                 subgridsize});
-
-  proxy::Proxy& proxy = m_bufferset.get_proxy();
+                identity_aterms ? nullptr : m_default_aterms.data(),
+                {identity_aterms ? 0 : m_default_aterm_offsets.size() - 1,
+                 m_nrStations, subgridsize, subgridsize});
 
   // Set Plan options
   Plan::Options options;
@@ -181,7 +186,7 @@ void GridderBufferImpl::flush_thread_worker() {
 
   // Create plan
   m_bufferset.get_watch(BufferSetImpl::Watch::kPlan).Start();
-  std::unique_ptr<Plan> plan = proxy.make_plan(
+  std::unique_ptr<Plan> plan = m_bufferset.make_plan(
       m_bufferset.get_kernel_size(), m_frequencies, m_bufferUVW2,
       m_bufferStationPairs2, aterm_offsets_span, options);
   m_bufferset.get_watch(BufferSetImpl::Watch::kPlan).Pause();
@@ -0,0 +1,129 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "PlanCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace idg {
+namespace api {
+
+namespace {
+uint64_t rotate_left(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+}  // namespace
+
+void PlanKey::add(const void* data, size_t size) {
+  // Mix in eight bytes at a time, the inputs can be large (uvw coordinates)
+  const char* bytes = static_cast<const char*>(data);
+  for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    std::memcpy(&word, &bytes[i], std::min(sizeof(uint64_t), size - i));
+    m_hash ^= word * 0x9e3779b97f4a7c15;
+    m_hash = rotate_left(m_hash, 31) * 0xc2b2ae3d27d4eb4f;
+  }
+  m_hash ^= size;
+}
+
+uint64_t PlanKey::get() const {
+  // Final avalanche, as in MurmurHash3
+  uint64_t hash = m_hash;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+PlanCache::PlanCache(const std::string& directory) : m_directory(directory) {}
+
+std::unique_ptr<Plan> PlanCache::find(uint64_t key, WTiles* wtiles) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::unique_ptr<std::istream> stream;
+  if (m_directory.empty()) {
+    auto entry = m_plans.find(key);
+    if (entry == m_plans.end()) {
+      m_nr_misses++;
+      return nullptr;
+    }
+    stream.reset(new std::istringstream(entry->second));
+  } else {
+    stream.reset(new std::ifstream(get_filename(key), std::ios::binary));
+    if (!*stream) {
+      m_nr_misses++;
+      return nullptr;
+    }
+  }
+
+  // A file that can not be read, e.g. written by another version of IDG or
+  // corrupt, is treated as a cache miss. This includes allocation errors
+  // caused by corrupt sizes.
+  try {
+    std::unique_ptr<Plan> plan(new Plan());
+    plan->load(*stream);
+    if (wtiles) {
+      WTiles wtiles_state;
+      wtiles_state.load(*stream);
+      *wtiles = std::move(wtiles_state);
+    }
+    m_nr_hits++;
+    return plan;
+  } catch (const std::exception&) {
+    m_nr_misses++;
+    return nullptr;
+  }
+}
+
+void PlanCache::insert(uint64_t key, const Plan& plan, const WTiles* wtiles) {
+  std::ostringstream stream;
+  plan.save(stream);
+  if (wtiles) {
+    wtiles->save(stream);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_directory.empty()) {
+    m_plans[key] = stream.str();
+  } else {
+    // Write to a temporary file first, such that concurrent runs never read
+    // a partially written plan
+    const std::string filename = get_filename(key);
+    const std::string temporary_filename = filename + ".tmp";
+    std::ofstream file(temporary_filename, std::ios::binary);
+    file << stream.str();
+    file.close();
+    if (!file || std::rename(temporary_filename.c_str(), filename.c_str())) {
+      std::remove(temporary_filename.c_str());
+      throw std::runtime_error("Could not write plan to " + filename);
+    }
+  }
+}
+
+size_t PlanCache::get_nr_hits() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nr_hits;
+}
+
+size_t PlanCache::get_nr_misses() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nr_misses;
+}
+
+std::string PlanCache::get_filename(uint64_t key) const {
+  std::ostringstream filename;
+  filename << m_directory << "/idg-plan-" << std::hex << std::setw(16)
+           << std::setfill('0') << key << ".bin";
+  return filename.str();
+}
+
+}  // namespace api
+}  // namespace idg
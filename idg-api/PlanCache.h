@@ -0,0 +1,82 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * PlanCache.h
+ * Reuse of plans for buffers that are gridded or degridded repeatedly, for
+ * instance in every major cycle
+ */
+
+#ifndef IDG_API_PLANCACHE_H_
+#define IDG_API_PLANCACHE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+#include "idg-common.h"
+
+namespace idg {
+namespace api {
+
+/**
+ * Hash of the inputs of Proxy::make_plan, used as key in a PlanCache
+ */
+class PlanKey {
+ public:
+  void add(const void* data, size_t size);
+
+  template <typename T>
+  void add(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable types can be hashed");
+    add(&value, sizeof(T));
+  }
+
+  uint64_t get() const;
+
+ private:
+  uint64_t m_hash = 0x6a09e667f3bcc908;
+};
+
+/**
+ * Cache of plans, together with the state of the w-tiles after making the
+ * plan (see Proxy::get_plan_wtiles). The plans are stored in serialized form,
+ * in memory or, when a directory is given, in files in that directory, such
+ * that they can be reused by later runs as well.
+ */
+class PlanCache {
+ public:
+  explicit PlanCache(const std::string& directory = "");
+
+  /**
+   * Get the plan stored for key, and restore the state of wtiles after
+   * making this plan. Returns nullptr, and leaves wtiles unchanged, when no
+   * (valid) plan is stored.
+   */
+  std::unique_ptr<Plan> find(uint64_t key, WTiles* wtiles);
+
+  //! Store plan, and the state of wtiles if not nullptr, for key
+  void insert(uint64_t key, const Plan& plan, const WTiles* wtiles);
+
+  //! Number of calls to find that returned a plan, and that did not
+  size_t get_nr_hits() const;
+  size_t get_nr_misses() const;
+
+ private:
+  std::string get_filename(uint64_t key) const;
+
+  std::string m_directory;
+  mutable std::mutex m_mutex;
+  std::map<uint64_t, std::string> m_plans;
+  size_t m_nr_hits = 0;
+  size_t m_nr_misses = 0;
+};
+
+}  // namespace api
+}  // namespace idg
+
+#endif
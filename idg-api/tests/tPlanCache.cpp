@@ -0,0 +1,77 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+
+#include "idg-config.h"
+#include "BufferSetImpl.h"
+#include "gridder-common.h"
+#include "idg-lib/tests/plan-common.h"
+
+namespace {
+
+const std::size_t kNrBaselines = 3;
+const std::size_t kNrTimesteps = 16;
+const float kCellSize = 0.001;
+const std::size_t kImageSize = 256;
+const float kBaselineLength = 100.0f;
+
+// Make a plan for a few baselines with the given orientation
+std::unique_ptr<idg::Plan> MakePlan(const idg::api::BufferSetImpl& bufferset,
+                                    float rotation) {
+  Observation observation(kNrBaselines, kNrTimesteps, rotation,
+                          kBaselineLength);
+  idg::Plan::Options options;
+  options.w_step = bufferset.get_w_step();
+  options.nr_w_layers = 1;
+  return bufferset.make_plan(
+      bufferset.get_kernel_size(), observation.get_frequencies(),
+      observation.get_uvw(), observation.get_baselines(),
+      observation.get_aterm_offsets(), options);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(plan_cache)
+
+#if defined(BUILD_LIB_CPU)
+BOOST_AUTO_TEST_CASE(reuse_plans) {
+  idg::api::options_type options;
+  AddWModeToOptions(WMode::kWTiling, options);
+  options["plan_cache"] = true;
+  std::unique_ptr<idg::api::BufferSet> bufferset(
+      idg::api::BufferSet::create(idg::api::Type::CPU_OPTIMIZED));
+  bufferset->init(kImageSize, kCellSize, 100.0f, 0.0f, 0.0f, options);
+  auto& bufferset_impl = dynamic_cast<idg::api::BufferSetImpl&>(*bufferset);
+  const idg::api::PlanCache* cache = bufferset_impl.get_plan_cache();
+  BOOST_REQUIRE(cache);
+  idg::WTiles* wtiles = bufferset_impl.get_proxy().get_plan_wtiles();
+  BOOST_REQUIRE(wtiles);
+
+  // First major cycle
+  std::unique_ptr<idg::Plan> plan_a = MakePlan(bufferset_impl, 0.0f);
+  std::unique_ptr<idg::Plan> plan_b = MakePlan(bufferset_impl, 1.0f);
+  BOOST_CHECK_EQUAL(cache->get_nr_hits(), 0u);
+  BOOST_CHECK_EQUAL(cache->get_nr_misses(), 2u);
+
+  // The w-tiles are cleared at the end of every major cycle, when the final
+  // grid is computed, after which the same plans are made again
+  wtiles->clear();
+  std::unique_ptr<idg::Plan> cached_plan_a = MakePlan(bufferset_impl, 0.0f);
+  std::unique_ptr<idg::Plan> cached_plan_b = MakePlan(bufferset_impl, 1.0f);
+  BOOST_CHECK_EQUAL(cache->get_nr_hits(), 2u);
+  BOOST_CHECK_EQUAL(cache->get_nr_misses(), 2u);
+  BOOST_CHECK(save(*cached_plan_a) == save(*plan_a));
+  BOOST_CHECK(save(*cached_plan_b) == save(*plan_b));
+
+  // Without clearing the w-tiles, the state differs and a new plan is made
+  MakePlan(bufferset_impl, 0.0f);
+  BOOST_CHECK_EQUAL(cache->get_nr_hits(), 2u);
+  BOOST_CHECK_EQUAL(cache->get_nr_misses(), 3u);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * Compares the strategies that the adder and splitter kernels of the Optimized
+ * proxy use to divide the grid over threads (see kernels/Binning.h). The
+ * subgrids are taken from a regular plan, the runtime of both kernels is
+ * reported for every strategy and number of threads.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <complex>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "idg-cpu.h"
+#include "idg-util.h"  // Data init routines
+
+namespace {
+
+int get_env(const char* name, int default_value) {
+  char* cstr = getenv(name);
+  return cstr ? atoi(cstr) : default_value;
+}
+
+// Parse a comma separated list of thread counts, e.g. "16,64,128"
+std::vector<int> get_nr_threads() {
+  char* cstr = getenv("NR_THREADS");
+  std::stringstream stream(cstr ? cstr : "16,64,128");
+  std::vector<int> nr_threads;
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    nr_threads.push_back(std::stoi(item));
+  }
+  return nr_threads;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Read parameters from environment
+  unsigned int nr_stations = get_env("NR_STATIONS", 52);
+  unsigned int nr_channels = get_env("NR_CHANNELS", 16);
+  unsigned int nr_timesteps = get_env("NR_TIMESTEPS", 3600);
+  unsigned int nr_timeslots = get_env("NR_TIMESLOTS", 4);
+  unsigned int grid_size = get_env("GRIDSIZE", 4096);
+  unsigned int subgrid_size = get_env("SUBGRIDSIZE", 32);
+  unsigned int kernel_size = get_env("KERNELSIZE", (subgrid_size / 4) + 1);
+  unsigned int nr_repetitions = get_env("NR_REPETITIONS", 3);
+  const std::vector<int> nr_threads = get_nr_threads();
+  const char* layout_file = "LOFAR_lba.txt";
+  const unsigned int nr_correlations = 4;
+  const unsigned int nr_polarizations = 4;
+  float integration_time = 1.0f;
+
+  // Initialize Data object
+  std::clog << ">>> Initialize data" << std::endl;
+  unsigned int nr_baselines = (nr_stations * (nr_stations - 1)) / 2;
+  idg::Data data = idg::get_example_data(
+      nr_baselines, grid_size, integration_time, nr_channels, layout_file);
+  nr_baselines = data.get_nr_baselines();
+  float image_size = data.compute_image_size(grid_size, nr_channels);
+  float cell_size = image_size / grid_size;
+
+  // Initialize proxy
+  idg::proxy::cpu::Optimized proxy;
+  std::array<float, 2> shift{0.0f, 0.0f};
+  aocommon::xt::Span<std::complex<float>, 4> grid =
+      proxy.allocate_span<std::complex<float>, 4>(
+          {1, nr_correlations, grid_size, grid_size});
+  proxy.set_grid(grid);
+  proxy.init_cache(subgrid_size, cell_size, 0.0f, shift);
+
+  // Create plan
+  std::clog << ">>> Create plan" << std::endl;
+  aocommon::xt::Span<idg::UVW<float>, 2> uvw =
+      proxy.allocate_span<idg::UVW<float>, 2>({nr_baselines, nr_timesteps});
+  data.get_uvw(uvw);
+  auto frequencies = proxy.allocate_span<float, 1>({nr_channels});
+  data.get_frequencies(frequencies, image_size);
+  aocommon::xt::Span<std::pair<unsigned int, unsigned int>, 1> baselines =
+      idg::get_example_baselines(proxy, nr_stations, nr_baselines);
+  aocommon::xt::Span<unsigned int, 1> aterm_offsets =
+      idg::get_example_aterm_offsets(proxy, nr_timeslots, nr_timesteps);
+  idg::Plan::Options options;
+  auto plan = proxy.make_plan(kernel_size, frequencies, uvw, baselines,
+                              aterm_offsets, options);
+  const int nr_subgrids = plan->get_nr_subgrids();
+  const idg::Metadata* metadata = plan->get_metadata_ptr();
+  std::clog << "Number of subgrids: " << nr_subgrids << std::endl;
+
+  // Initialize subgrids
+  std::vector<std::complex<float>> subgrids(
+      size_t(nr_subgrids) * nr_polarizations * subgrid_size * subgrid_size,
+      std::complex<float>(1.0f, 0.0f));
+
+  // Run the benchmark
+  std::clog << ">>> Run benchmark" << std::endl;
+  using idg::kernel::cpu::optimized::AdderStrategy;
+  auto kernels = proxy.get_kernels();
+  std::clog << std::setw(10) << "threads" << std::setw(14) << "strategy"
+            << std::setw(14) << "adder (s)" << std::setw(14) << "splitter (s)"
+            << std::endl;
+  for (int threads : nr_threads) {
+    omp_set_num_threads(threads);
+    for (AdderStrategy strategy :
+         {AdderStrategy::kRowStriped, AdderStrategy::kBinned}) {
+      proxy.set_adder_strategy(strategy);
+
+      // Report the fastest of the repetitions
+      double runtime_adder = std::numeric_limits<double>::max();
+      double runtime_splitter = std::numeric_limits<double>::max();
+      for (unsigned int i = 0; i < nr_repetitions; i++) {
+        double runtime = -omp_get_wtime();
+        kernels->run_adder(nr_subgrids, nr_polarizations, grid_size,
+                           subgrid_size, metadata, subgrids.data(),
+                           grid.data());
+        runtime_adder = std::min(runtime_adder, runtime + omp_get_wtime());
+
+        runtime = -omp_get_wtime();
+        kernels->run_splitter(nr_subgrids, nr_polarizations, grid_size,
+                              subgrid_size, metadata, subgrids.data(),
+                              grid.data());
+        runtime_splitter =
+            std::min(runtime_splitter, runtime + omp_get_wtime());
+      }
+
+      std::clog << std::setw(10) << threads << std::setw(14)
+                << (strategy == AdderStrategy::kBinned ? "binned"
+                                                       : "row-striped")
+                << std::fixed << std::setprecision(4) << std::setw(14)
+                << runtime_adder << std::setw(14) << runtime_splitter
+                << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
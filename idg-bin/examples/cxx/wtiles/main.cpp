@@ -0,0 +1,129 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * Micro-benchmark for the assignment of w-tiles to subgrids (see WTiles.h),
+ * which Plan does sequentially for all subgrids. The w-tile coordinates of
+ * the subgrids follow random walks over the grid and in w, such that plans
+ * with a small w-tile buffer are dominated by evictions. The runtime of both
+ * add_subgrid and add_subgrids is reported for every w-tile buffer size.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "common/WTiles.h"
+
+namespace {
+
+int get_env(const char* name, int default_value) {
+  char* cstr = getenv(name);
+  return cstr ? atoi(cstr) : default_value;
+}
+
+// Parse a comma separated list of w-tile buffer sizes, e.g. "64,1024,16384"
+std::vector<int> get_nr_wtiles() {
+  char* cstr = getenv("NR_WTILES");
+  std::stringstream stream(cstr ? cstr : "64,1024,4096,16384");
+  std::vector<int> nr_wtiles;
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    nr_wtiles.push_back(std::stoi(item));
+  }
+  return nr_wtiles;
+}
+
+// Every baseline contributes a random walk of nr_subgrids_per_baseline
+// subgrids, which starts at a random w-tile
+std::vector<idg::Metadata> make_metadata(int nr_baselines,
+                                         int nr_subgrids_per_baseline,
+                                         int nr_wtiles_uv, int nr_w_layers) {
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> uv(-nr_wtiles_uv / 2, nr_wtiles_uv / 2);
+  std::uniform_int_distribution<int> w(-nr_w_layers / 2, nr_w_layers / 2);
+  std::uniform_int_distribution<int> step(-1, 1);
+  std::vector<idg::Metadata> metadata(nr_baselines * nr_subgrids_per_baseline);
+  for (int bl = 0; bl < nr_baselines; bl++) {
+    idg::Coordinate coordinate{uv(generator), uv(generator), w(generator)};
+    for (int i = 0; i < nr_subgrids_per_baseline; i++) {
+      coordinate.x += step(generator);
+      coordinate.y += step(generator);
+      if (i % 8 == 0) coordinate.z += step(generator);
+      metadata[bl * nr_subgrids_per_baseline + i].wtile_coordinate = coordinate;
+    }
+  }
+  return metadata;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Read parameters from environment
+  const int nr_baselines = get_env("NR_BASELINES", 1326);
+  const int nr_subgrids_per_baseline = get_env("NR_SUBGRIDS", 256);
+  const int nr_wtiles_uv = get_env("NR_WTILES_UV", 64);
+  const int nr_w_layers = get_env("NR_W_LAYERS", 32);
+  const int nr_repetitions = get_env("NR_REPETITIONS", 3);
+  const int wtile_size = 128;
+  const std::vector<int> nr_wtiles = get_nr_wtiles();
+
+  std::clog << ">>> Initialize metadata" << std::endl;
+  const std::vector<idg::Metadata> metadata = make_metadata(
+      nr_baselines, nr_subgrids_per_baseline, nr_wtiles_uv, nr_w_layers);
+  const size_t nr_subgrids = metadata.size();
+  std::clog << "nr_subgrids: " << nr_subgrids << std::endl;
+
+  std::clog << std::endl;
+  std::clog << ">>> Assign w-tiles" << std::endl;
+  std::clog << std::setw(10) << "nr_wtiles" << std::setw(12) << "flushes"
+            << std::setw(12) << "evicted" << std::setw(16) << "add_subgrid"
+            << std::setw(16) << "add_subgrids" << std::endl;
+
+  for (int n : nr_wtiles) {
+    double runtime_add_subgrid = std::numeric_limits<double>::max();
+    double runtime_add_subgrids = std::numeric_limits<double>::max();
+    size_t nr_flushes = 0;
+    size_t nr_evicted = 0;
+
+    for (int repetition = 0; repetition < nr_repetitions; repetition++) {
+      // One subgrid at a time
+      idg::WTiles wtiles(n, wtile_size);
+      double runtime = -omp_get_wtime();
+      for (size_t i = 0; i < nr_subgrids; i++) {
+        wtiles.add_subgrid(i, metadata[i].wtile_coordinate);
+      }
+      runtime += omp_get_wtime();
+      runtime_add_subgrid = std::min(runtime_add_subgrid, runtime);
+
+      // All subgrids at once, as used by Plan
+      idg::WTiles wtiles_bulk(n, wtile_size);
+      std::vector<idg::Metadata> metadata_bulk = metadata;
+      runtime = -omp_get_wtime();
+      wtiles_bulk.add_subgrids(metadata_bulk);
+      runtime += omp_get_wtime();
+      runtime_add_subgrids = std::min(runtime_add_subgrids, runtime);
+
+      const idg::WTileUpdateSet flush_set = wtiles_bulk.get_flush_set();
+      nr_flushes = flush_set.size();
+      nr_evicted = 0;
+      for (const idg::WTileUpdateInfo& flush : flush_set) {
+        nr_evicted += flush.wtile_ids.size();
+      }
+    }
+
+    std::clog << std::setw(10) << n << std::setw(12) << nr_flushes
+              << std::setw(12) << nr_evicted << std::fixed
+              << std::setprecision(2) << std::setw(13)
+              << runtime_add_subgrid * 1e3 << " ms" << std::setw(13)
+              << runtime_add_subgrids * 1e3 << " ms" << std::endl;
+  }
+}
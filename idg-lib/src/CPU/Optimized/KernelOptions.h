@@ -0,0 +1,43 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_CPU_OPTIMIZED_KERNELOPTIONS_H_
+#define IDG_CPU_OPTIMIZED_KERNELOPTIONS_H_
+
+/*
+ * Options of the Optimized kernels that can be set through the Optimized
+ * proxy. The functions that use them are declared in the (not installed)
+ * headers in kernels/.
+ */
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+// Instruction set used by the vectorized helper functions, see kernels/Isa.h
+enum class IsaLevel { kScalar = 0, kAvx = 1, kAvx2 = 2, kAvx512 = 3 };
+
+/*
+ * Accuracy of the polynomial sincos:
+ *  - kFull: within a few ulp of single precision
+ *  - kImaging: absolute error below ~2e-4, which is sufficient for imaging
+ */
+enum class SincosAccuracy { kFull = 0, kImaging = 1 };
+
+/*
+ * Strategy used by the adder and splitter kernels to divide work over threads:
+ *  - kRowStriped: every thread visits all subgrids and processes only the grid
+ *    rows y for which y % nr_threads equals its thread number.
+ *  - kBinned: the subgrids are first binned by the band of grid rows that they
+ *    overlap, after which the bands are distributed over the threads. Every
+ *    thread only visits the subgrids in its bands.
+ */
+enum class AdderStrategy { kRowStriped = 0, kBinned = 1 };
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
+
+#endif
@@ -1,8 +1,13 @@
 // Copyright (C) 2020 ASTRON (Netherlands Institute for Radio Astronomy)
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <cstdlib>
+
 #include "Optimized.h"
 #include "OptimizedKernels.h"
+#include "kernels/Binning.h"
+#include "kernels/Isa.h"
+#include "kernels/Sincos.h"
 
 using namespace std;
 
@@ -17,6 +22,29 @@ Optimized::Optimized() : CPU() {
 #endif
 
   m_kernels.reset(new kernel::cpu::OptimizedKernels());
+
+  // Select the instruction set for the vectorized kernels
+  const char* isa_name = getenv("IDG_ISA");
+  set_isa_level(isa_name ? kernel::cpu::optimized::parse_isa_level(isa_name)
+                         : kernel::cpu::optimized::detect_isa_level());
+}
+
+void Optimized::set_isa_level(kernel::cpu::optimized::IsaLevel level) {
+  kernel::cpu::optimized::set_isa_level(level);
+#if defined(DEBUG)
+  cout << "Instruction set: " << kernel::cpu::optimized::get_isa_name(level)
+       << endl;
+#endif
+}
+
+void Optimized::set_sincos_accuracy(
+    kernel::cpu::optimized::SincosAccuracy accuracy) {
+  kernel::cpu::optimized::set_sincos_accuracy(accuracy);
+}
+
+void Optimized::set_adder_strategy(
+    kernel::cpu::optimized::AdderStrategy strategy) {
+  kernel::cpu::optimized::set_adder_strategy(strategy);
 }
 
 }  // namespace cpu
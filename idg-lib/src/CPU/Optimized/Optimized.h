@@ -6,6 +6,8 @@
 
 #include "idg-cpu.h"
 
+#include "KernelOptions.h"
+
 namespace idg {
 namespace proxy {
 namespace cpu {
@@ -17,6 +19,29 @@ class Optimized : public CPU {
   // Constructor
   Optimized();
 
+  /*!
+   * Set the instruction set used by the vectorized kernels. By default, the
+   * highest level supported by the CPU is used, unless the environment
+   * variable IDG_ISA is set to one of: scalar, avx, avx2, avx512.
+   * The level applies to all Optimized proxies in the process.
+   */
+  void set_isa_level(kernel::cpu::optimized::IsaLevel level);
+
+  /*!
+   * Set the accuracy of the polynomial sincos used by the kernels, kFull by
+   * default. This has no effect when the kernels are built to use a lookup
+   * table (USE_LOOKUP) or MKL (USE_VML) instead. Like the instruction set, the
+   * accuracy applies to all Optimized proxies in the process.
+   */
+  void set_sincos_accuracy(kernel::cpu::optimized::SincosAccuracy accuracy);
+
+  /*!
+   * Set how the adder and splitter kernels divide the grid over threads,
+   * kBinned by default. Like the instruction set, the strategy applies to all
+   * Optimized proxies in the process.
+   */
+  void set_adder_strategy(kernel::cpu::optimized::AdderStrategy strategy);
+
 };  // class Optimized
 
 }  // namespace cpu
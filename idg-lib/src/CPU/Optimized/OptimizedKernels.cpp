@@ -1,7 +1,19 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <omp.h>
+
 #include "../Reference/ReferenceKernels.h"
 #include "OptimizedKernels.h"
+#include "kernels/Isa.h"
 #include "kernels/Kernels.h"
 
+#include "common/memory.h"
+
 namespace idg {
 namespace kernel {
 namespace cpu {
@@ -9,32 +21,104 @@ namespace cpu {
 using namespace idg::kernel::cpu::reference;
 using namespace idg::kernel::cpu::optimized;
 
+namespace {
+
+/*
+ * Dispatch tables for the specialized kernels, indexed by subgrid size and by
+ * number of correlations (gridder, degridder) or polarizations (adder,
+ * splitter).
+ */
+template <typename Kernel>
+using KernelTable = std::map<std::pair<int, int>, Kernel>;
+
+#define GRIDDER_ENTRY(subgrid_size, nr_correlations) \
+  {{subgrid_size, nr_correlations},                  \
+   kernel_gridder<subgrid_size, nr_correlations>},
+#define DEGRIDDER_ENTRY(subgrid_size, nr_correlations) \
+  {{subgrid_size, nr_correlations},                    \
+   kernel_degridder<subgrid_size, nr_correlations>},
+#define ADDER_ENTRY(subgrid_size, nr_polarizations) \
+  {{subgrid_size, nr_polarizations},                 \
+   kernel_adder<subgrid_size, nr_polarizations>},
+#define SPLITTER_ENTRY(subgrid_size, nr_polarizations) \
+  {{subgrid_size, nr_polarizations},                   \
+   kernel_splitter<subgrid_size, nr_polarizations>},
+
+const KernelTable<decltype(&kernel_gridder<0, 0>)> kGridders = {
+    IDG_FOR_EACH_SUBGRID_SIZE(GRIDDER_ENTRY, 2)
+        IDG_FOR_EACH_SUBGRID_SIZE(GRIDDER_ENTRY, 4)};
+
+const KernelTable<decltype(&kernel_degridder<0, 0>)> kDegridders = {
+    IDG_FOR_EACH_SUBGRID_SIZE(DEGRIDDER_ENTRY, 2)
+        IDG_FOR_EACH_SUBGRID_SIZE(DEGRIDDER_ENTRY, 4)};
+
+const KernelTable<decltype(&kernel_adder<0, 0>)> kAdders = {
+    IDG_FOR_EACH_SUBGRID_SIZE(ADDER_ENTRY, 1)
+        IDG_FOR_EACH_SUBGRID_SIZE(ADDER_ENTRY, 4)};
+
+const KernelTable<decltype(&kernel_splitter<0, 0>)> kSplitters = {
+    IDG_FOR_EACH_SUBGRID_SIZE(SPLITTER_ENTRY, 1)
+        IDG_FOR_EACH_SUBGRID_SIZE(SPLITTER_ENTRY, 4)};
+
+/*
+ * Returns the number of subgrids that the fused kernels process at once. A
+ * block of subgrids uses about half of the combined L2 cache of all threads,
+ * but contains at least one subgrid per thread.
+ */
+int get_fused_block_size(int nr_polarizations, int subgrid_size) {
+  const int nr_threads = omp_get_max_threads();
+  const size_t sizeof_subgrid = size_t(nr_polarizations) * subgrid_size *
+                                subgrid_size * sizeof(std::complex<float>);
+  const size_t sizeof_block = get_l2_cache_size() * nr_threads / 2;
+  return std::max(nr_threads, static_cast<int>(sizeof_block / sizeof_subgrid));
+}
+
+// Returns the specialized kernel when available, the generic kernel otherwise
+template <typename Kernel>
+Kernel select_kernel(const KernelTable<Kernel>& table, Kernel generic,
+                     int subgrid_size, int n) {
+  auto it = table.find({subgrid_size, n});
+  return it != table.end() ? it->second : generic;
+}
+
+}  // namespace
+
 /*
  * Main
  */
 void OptimizedKernels::run_gridder(KERNEL_GRIDDER_ARGUMENTS) {
+  const uint64_t nr_allocations = get_allocate_memory_count();
   pmt::State states[2];
   states[0] = power_meter_->Read();
-  kernel_gridder(nr_subgrids, nr_polarizations, grid_size, subgrid_size,
-                 image_size, w_step_in_lambda, shift, nr_correlations,
-                 nr_channels, nr_stations, uvw, wavenumbers, visibilities,
-                 taper, aterms, aterm_indices, avg_aterm, metadata, subgrid);
+  auto kernel = select_kernel(kGridders, kernel_gridder<0, 0>, subgrid_size,
+                              nr_correlations);
+  kernel(nr_subgrids, nr_polarizations, grid_size, subgrid_size, image_size,
+         w_step_in_lambda, shift, nr_correlations, nr_channels, nr_stations,
+         uvw, wavenumbers, visibilities, taper, aterms, aterm_indices,
+         avg_aterm, metadata, subgrid);
   states[1] = power_meter_->Read();
   if (report_) {
     report_->update(Report::gridder, states[0], states[1]);
+    report_->update_allocations(
+        Report::gridder, get_allocate_memory_count() - nr_allocations);
   }
 }
 
 void OptimizedKernels::run_degridder(KERNEL_DEGRIDDER_ARGUMENTS) {
+  const uint64_t nr_allocations = get_allocate_memory_count();
   pmt::State states[2];
   states[0] = power_meter_->Read();
-  kernel_degridder(nr_subgrids, nr_polarizations, grid_size, subgrid_size,
-                   image_size, w_step_in_lambda, shift, nr_correlations,
-                   nr_channels, nr_stations, uvw, wavenumbers, visibilities,
-                   taper, aterms, aterm_indices, metadata, subgrid);
+  auto kernel = select_kernel(kDegridders, kernel_degridder<0, 0>,
+                              subgrid_size, nr_correlations);
+  kernel(nr_subgrids, nr_polarizations, grid_size, subgrid_size, image_size,
+         w_step_in_lambda, shift, nr_correlations, nr_channels, nr_stations,
+         uvw, wavenumbers, visibilities, taper, aterms, aterm_indices,
+         metadata, subgrid);
   states[1] = power_meter_->Read();
   if (report_) {
     report_->update(Report::degridder, states[0], states[1]);
+    report_->update_allocations(
+        Report::degridder, get_allocate_memory_count() - nr_allocations);
   }
 }
 
@@ -60,6 +144,16 @@ void OptimizedKernels::run_fft(KERNEL_FFT_ARGUMENTS) {
   }
 }
 
+void OptimizedKernels::run_fft_shift(KERNEL_FFT_ARGUMENTS) {
+  pmt::State states[2];
+  states[0] = power_meter_->Read();
+  kernel_fft_grid(size, batch, data, sign, true);
+  states[1] = power_meter_->Read();
+  if (report_) {
+    report_->update(Report::grid_fft, states[0], states[1]);
+  }
+}
+
 void OptimizedKernels::run_subgrid_fft(KERNEL_SUBGRID_FFT_ARGUMENTS) {
   pmt::State states[2];
   states[0] = power_meter_->Read();
@@ -73,8 +167,10 @@ void OptimizedKernels::run_subgrid_fft(KERNEL_SUBGRID_FFT_ARGUMENTS) {
 void OptimizedKernels::run_adder(KERNEL_ADDER_ARGUMENTS) {
   pmt::State states[2];
   states[0] = power_meter_->Read();
-  kernel_adder(nr_subgrids, nr_polarizations, grid_size, subgrid_size, metadata,
-               subgrid, grid);
+  auto kernel = select_kernel(kAdders, kernel_adder<0, 0>, subgrid_size,
+                              nr_polarizations);
+  kernel(nr_subgrids, nr_polarizations, grid_size, subgrid_size, metadata,
+         subgrid, grid);
   states[1] = power_meter_->Read();
   if (report_) {
     report_->update(Report::adder, states[0], states[1]);
@@ -84,8 +180,10 @@ void OptimizedKernels::run_adder(KERNEL_ADDER_ARGUMENTS) {
 void OptimizedKernels::run_splitter(KERNEL_SPLITTER_ARGUMENTS) {
   pmt::State states[2];
   states[0] = power_meter_->Read();
-  kernel_splitter(nr_subgrids, nr_polarizations, grid_size, subgrid_size,
-                  metadata, subgrid, grid);
+  auto kernel = select_kernel(kSplitters, kernel_splitter<0, 0>, subgrid_size,
+                              nr_polarizations);
+  kernel(nr_subgrids, nr_polarizations, grid_size, subgrid_size, metadata,
+         subgrid, grid);
   states[1] = power_meter_->Read();
   if (report_) {
     report_->update(Report::splitter, states[0], states[1]);
@@ -145,31 +243,44 @@ void OptimizedKernels::run_splitter_wstack(KERNEL_SPLITTER_WSTACK_ARGUMENTS) {
  * W-Tiling
  */
 size_t OptimizedKernels::init_wtiles(int nr_polarizations, size_t grid_size,
-                                     int subgrid_size) {
+                                     int subgrid_size, int wtile_size,
+                                     size_t max_bytes) {
+  synchronize_wtiles();
+  wtile_size_ = wtile_size;
+
+  const size_t padded_wtile_size = size_t(wtile_size) + size_t(subgrid_size);
+  size_t sizeof_padded_wtile = nr_polarizations * padded_wtile_size *
+                               padded_wtile_size * sizeof(std::complex<float>);
+
   // Heuristic for choosing the number of wtiles.
   // A number that is too small will result in excessive flushing, too large in
   // excessive memory usage.
   //
-  // Current heuristic is for the wtiles to cover 50% the grid.
-  // Because of padding with subgrid_size, the memory used will be more than 50%
-  // of the memory used for the grid. In the extreme case subgrid_size is
-  // equal to kWTileSize (both 128) m_wtiles_buffer will be as large as the
-  // grid. The minimum number of wtiles is 4.
+  // Unless a memory budget is given, the heuristic is for the wtiles to cover
+  // 50% the grid. Because of padding with subgrid_size, the memory used will
+  // be more than 50% of the memory used for the grid. In the extreme case
+  // subgrid_size is equal to wtile_size m_wtiles_buffer will be as large as
+  // the grid. The minimum number of wtiles is 4.
   size_t nr_wtiles_min = 4;
-  size_t nr_wtiles = std::max(
-      nr_wtiles_min, (grid_size * grid_size) / (kWTileSize * kWTileSize) / 2);
+  if (max_bytes && max_bytes < nr_wtiles_min * sizeof_padded_wtile) {
+    throw std::invalid_argument(
+        "wtile_buffer_bytes should be at least " +
+        std::to_string(nr_wtiles_min * sizeof_padded_wtile) +
+        " bytes, the size of " + std::to_string(nr_wtiles_min) + " w-tiles");
+  }
+  size_t nr_wtiles =
+      max_bytes
+          ? max_bytes / sizeof_padded_wtile
+          : (grid_size * grid_size) / (wtile_size * wtile_size) / 2;
+  nr_wtiles = std::max(nr_wtiles_min, nr_wtiles);
 
   // Make sure that the wtiles buffer does not use an excessive amount of memory
-  const size_t padded_wtile_size = size_t(kWTileSize) + size_t(subgrid_size);
-  size_t sizeof_padded_wtile = nr_polarizations * padded_wtile_size *
-                               padded_wtile_size * sizeof(std::complex<float>);
   size_t sizeof_padded_wtiles = nr_wtiles * sizeof_padded_wtile;
   size_t free_memory = auxiliary::get_free_memory() * 1024 * 1024;  // Bytes
-  while (sizeof_padded_wtiles > free_memory) {
-    nr_wtiles *= 0.9;
-    sizeof_padded_wtiles = nr_wtiles * sizeof_padded_wtiles;
+  while (sizeof_padded_wtiles > free_memory && nr_wtiles > nr_wtiles_min) {
+    nr_wtiles = std::max(nr_wtiles_min, size_t(nr_wtiles * 0.9));
+    sizeof_padded_wtiles = nr_wtiles * sizeof_padded_wtile;
   }
-  assert(nr_wtiles >= nr_wtiles_min);
 
   wtiles_buffer_ = xt::xtensor<std::complex<float>, 4>(
       {nr_wtiles, static_cast<size_t>(nr_polarizations), padded_wtile_size,
@@ -178,13 +289,77 @@ size_t OptimizedKernels::init_wtiles(int nr_polarizations, size_t grid_size,
   return nr_wtiles;
 }
 
+void OptimizedKernels::set_wtile_flush_queue_size(int max_nr_pending) {
+  if (max_nr_pending < 0) {
+    throw std::invalid_argument("max_nr_pending should not be negative");
+  }
+  if (wtile_flush_queue_) {
+    wtile_flush_queue_->synchronize();
+  }
+  wtile_flush_queue_.reset();
+  if (max_nr_pending > 0) {
+    // The worker runs concurrently with the gridder and adder, which use all
+    // threads. Flushes are rare compared to the subgrids, a quarter of the
+    // threads limits the oversubscription.
+    const int nr_threads = std::max(1, omp_get_max_threads() / 4);
+    wtile_flush_queue_.reset(new WTileFlushQueue(max_nr_pending, nr_threads));
+  }
+}
+
+void OptimizedKernels::set_wtile_prefetch_depth(int depth) {
+  if (depth < 0) {
+    throw std::invalid_argument("depth should not be negative");
+  }
+  wtile_prefetcher_.reset();
+  if (depth > 0) {
+    // As for the flush queue, the worker runs concurrently with the splitter
+    // and degridder
+    const int nr_threads = std::max(1, omp_get_max_threads() / 4);
+    wtile_prefetcher_.reset(new WTilePrefetcher(depth, nr_threads));
+  }
+}
+
+void OptimizedKernels::synchronize_wtiles() {
+  if (wtile_flush_queue_) {
+    wtile_flush_queue_->synchronize();
+  }
+  if (wtile_prefetcher_) {
+    wtile_prefetcher_->clear();
+  }
+}
+
+void OptimizedKernels::report_wtiles(Report::ID id,
+                                     const WTileUpdateInfo& wtile_info,
+                                     int subgrid_size, float image_size,
+                                     float w_step, const float* shift) {
+  if (!report_) {
+    return;
+  }
+  const int nr_wtiles = wtile_info.wtile_ids.size();
+  const int padded_wtile_size = wtile_size_ + subgrid_size;
+  const float image_size_shift =
+      image_size + 2 * std::max(std::abs(shift[0]), std::abs(shift[1]));
+  const std::vector<int> w_padded_wtile_sizes = compute_w_padded_tile_sizes(
+      wtile_info.wtile_coordinates.data(), nr_wtiles, w_step, image_size,
+      image_size_shift, padded_wtile_size);
+  uint64_t nr_w_padded_pixels = 0;
+  for (int w_padded_wtile_size : w_padded_wtile_sizes) {
+    nr_w_padded_pixels += uint64_t(w_padded_wtile_size) * w_padded_wtile_size;
+  }
+  const uint64_t nr_pixels =
+      uint64_t(nr_wtiles) * padded_wtile_size * padded_wtile_size;
+  report_->update_wtiles(id, nr_wtiles, nr_pixels, nr_w_padded_pixels);
+}
+
 void OptimizedKernels::run_adder_tiles_to_grid(
     KERNEL_ADDER_TILES_TO_GRID_ARGUMENTS) {
   pmt::State states[2];
   states[0] = power_meter_->Read();
-  kernel_adder_wtiles_to_grid(
-      nr_polarizations, grid_size, subgrid_size, kWTileSize, image_size, w_step,
-      shift, nr_tiles, tile_ids, tile_coordinates, wtiles_buffer_.data(), grid);
+  synchronize_wtiles();
+  kernel_adder_wtiles_to_grid(nr_polarizations, grid_size, subgrid_size,
+                              wtile_size_, image_size, w_step, shift, nr_tiles,
+                              tile_ids, tile_coordinates, wtiles_buffer_.data(),
+                              grid);
   states[1] = power_meter_->Read();
   if (report_) {
     report_->update(Report::wtiling_forward, states[0], states[1]);
@@ -194,20 +369,44 @@ void OptimizedKernels::run_adder_tiles_to_grid(
 void OptimizedKernels::run_adder_wtiles(KERNEL_ADDER_WTILES_ARGUMENTS) {
   pmt::State states[2];
   states[0] = power_meter_->Read();
+  adder_wtiles(nr_subgrids, nr_polarizations, grid_size, subgrid_size,
+               image_size, w_step, shift, subgrid_offset, wtile_flush_set,
+               metadata, subgrid, grid);
+  states[1] = power_meter_->Read();
+  if (report_) {
+    report_->update(Report::wtiling_forward, states[0], states[1]);
+  }
+}
+
+void OptimizedKernels::adder_wtiles(KERNEL_ADDER_WTILES_ARGUMENTS) {
   for (int subgrid_index = 0; subgrid_index < (int)nr_subgrids;) {
     // Is a flush needed right now?
     if (!wtile_flush_set.empty() && wtile_flush_set.front().subgrid_index ==
                                         subgrid_index + subgrid_offset) {
       // Get information on what wtiles to flush
       WTileUpdateInfo& wtile_flush_info = wtile_flush_set.front();
-
-      // Project wtiles to master grid
-      kernel_adder_wtiles_to_grid(nr_polarizations, grid_size, subgrid_size,
-                                  kWTileSize, image_size, w_step, shift,
-                                  wtile_flush_info.wtile_ids.size(),
-                                  wtile_flush_info.wtile_ids.data(),
-                                  wtile_flush_info.wtile_coordinates.data(),
-                                  wtiles_buffer_.data(), grid);
+      report_wtiles(Report::wtiling_forward, wtile_flush_info, subgrid_size,
+                    image_size, w_step, shift);
+
+      // Project wtiles to master grid, in the background when a flush queue
+      // is used
+      if (wtile_flush_queue_) {
+        wtile_flush_queue_->push({nr_polarizations,
+                                  grid_size,
+                                  subgrid_size,
+                                  wtile_size_,
+                                  image_size,
+                                  w_step,
+                                  {shift[0], shift[1]}},
+                                 wtile_flush_info, wtiles_buffer_, grid);
+      } else {
+        kernel_adder_wtiles_to_grid(nr_polarizations, grid_size, subgrid_size,
+                                    wtile_size_, image_size, w_step, shift,
+                                    wtile_flush_info.wtile_ids.size(),
+                                    wtile_flush_info.wtile_ids.data(),
+                                    wtile_flush_info.wtile_coordinates.data(),
+                                    wtiles_buffer_.data(), grid);
+      }
 
       // Remove the flush event from the queue
       wtile_flush_set.pop_front();
@@ -229,7 +428,7 @@ void OptimizedKernels::run_adder_wtiles(KERNEL_ADDER_WTILES_ARGUMENTS) {
 
     // Add all subgrids than can be added to the wtiles
     kernel_adder_subgrids_to_wtiles(nr_subgrids_to_process, nr_polarizations,
-                                    grid_size, subgrid_size, kWTileSize,
+                                    grid_size, subgrid_size, wtile_size_,
                                     &metadata[subgrid_index],
                                     &subgrid[subgrid_index * subgrid_size *
                                              subgrid_size * nr_polarizations],
@@ -237,17 +436,21 @@ void OptimizedKernels::run_adder_wtiles(KERNEL_ADDER_WTILES_ARGUMENTS) {
     // Increment the subgrid index by the actual number of processed subgrids
     subgrid_index += nr_subgrids_to_process;
   }
-
-  states[1] = power_meter_->Read();
-  if (report_) {
-    report_->update(Report::wtiling_forward, states[0], states[1]);
-  }
 }
 
 void OptimizedKernels::run_splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS) {
   pmt::State states[2];
   states[0] = power_meter_->Read();
+  splitter_wtiles(nr_subgrids, nr_polarizations, grid_size, subgrid_size,
+                  image_size, w_step, shift, subgrid_offset,
+                  wtile_initialize_set, metadata, subgrid, grid);
+  states[1] = power_meter_->Read();
+  if (report_) {
+    report_->update(Report::wtiling_backward, states[0], states[1]);
+  }
+}
 
+void OptimizedKernels::splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS) {
   for (int subgrid_index = 0; subgrid_index < nr_subgrids;) {
     // Check whether initialize is needed right now
     if (!wtile_initialize_set.empty() &&
@@ -255,16 +458,33 @@ void OptimizedKernels::run_splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS) {
             (int)(subgrid_index + subgrid_offset)) {
       // Get the information on what wtiles to initialize
       WTileUpdateInfo& wtile_initialize_info = wtile_initialize_set.front();
-      // Initialize the wtiles from the grid
-      kernel_splitter_wtiles_from_grid(
-          nr_polarizations, grid_size, subgrid_size, kWTileSize, image_size,
-          w_step, shift, wtile_initialize_info.wtile_ids.size(),
-          wtile_initialize_info.wtile_ids.data(),
-          wtile_initialize_info.wtile_coordinates.data(), wtiles_buffer_.data(),
-          grid);
+      report_wtiles(Report::wtiling_backward, wtile_initialize_info,
+                    subgrid_size, image_size, w_step, shift);
+      // Initialize the wtiles from the grid, unless they were prefetched
+      if (!wtile_prefetcher_ ||
+          !wtile_prefetcher_->fetch(wtile_initialize_info, wtiles_buffer_)) {
+        kernel_splitter_wtiles_from_grid(
+            nr_polarizations, grid_size, subgrid_size, wtile_size_, image_size,
+            w_step, shift, wtile_initialize_info.wtile_ids.size(),
+            wtile_initialize_info.wtile_ids.data(),
+            wtile_initialize_info.wtile_coordinates.data(),
+            wtiles_buffer_.data(), grid);
+      }
 
       // Remove initialize even from queue
       wtile_initialize_set.pop_front();
+
+      // Start to initialize the wtiles of the next events in the background
+      if (wtile_prefetcher_) {
+        wtile_prefetcher_->prefetch({nr_polarizations,
+                                     grid_size,
+                                     subgrid_size,
+                                     wtile_size_,
+                                     image_size,
+                                     w_step,
+                                     {shift[0], shift[1]}},
+                                    wtile_initialize_set, grid);
+      }
     }
 
     // Initialize number of subgrids to proccess next to all remaining subgrids
@@ -285,7 +505,7 @@ void OptimizedKernels::run_splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS) {
     // Process all subgrids that can be processed now
     kernel_splitter_subgrids_from_wtiles(
         nr_subgrids_to_process, nr_polarizations, grid_size, subgrid_size,
-        kWTileSize, &metadata[subgrid_index],
+        wtile_size_, &metadata[subgrid_index],
         &subgrid[subgrid_index * subgrid_size * subgrid_size *
                  nr_polarizations],
         wtiles_buffer_.data());
@@ -293,12 +513,95 @@ void OptimizedKernels::run_splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS) {
     // Increment the subgrid index by the actual number of processed subgrids
     subgrid_index += nr_subgrids_to_process;
   }  // end for subgrid_index
+}  // end splitter_wtiles
+
+/*
+ * Fused subgrid FFT and adder/splitter
+ */
+void OptimizedKernels::run_fft_adder(KERNEL_FFT_ADDER_ARGUMENTS) {
+  const int block_size = get_fused_block_size(nr_polarizations, subgrid_size);
+  const size_t sizeof_subgrid =
+      size_t(nr_polarizations) * subgrid_size * subgrid_size;
+  double runtime_fft = 0;
+  double runtime_adder = 0;
+
+  for (int s = 0; s < nr_subgrids; s += block_size) {
+    const int current_nr_subgrids = std::min(block_size, nr_subgrids - s);
+    const idg::Metadata* metadata_ptr = &metadata[s];
+    std::complex<float>* subgrid_ptr = &subgrid[s * sizeof_subgrid];
+
+    pmt::State states[3];
+    states[0] = power_meter_->Read();
+    kernel_fft(grid_size, subgrid_size, current_nr_subgrids * nr_polarizations,
+               subgrid_ptr, FFTW_BACKWARD);
+    states[1] = power_meter_->Read();
+    if (use_wtiles) {
+      adder_wtiles(current_nr_subgrids, nr_polarizations, grid_size,
+                   subgrid_size, image_size, w_step, shift, subgrid_offset + s,
+                   wtile_flush_set, metadata_ptr, subgrid_ptr, grid);
+    } else if (w_step != 0.0) {
+      kernel_adder_wstack(current_nr_subgrids, nr_polarizations, grid_size,
+                          subgrid_size, metadata_ptr, subgrid_ptr, grid);
+    } else {
+      auto kernel = select_kernel(kAdders, kernel_adder<0, 0>, subgrid_size,
+                                  nr_polarizations);
+      kernel(current_nr_subgrids, nr_polarizations, grid_size, subgrid_size,
+             metadata_ptr, subgrid_ptr, grid);
+    }
+    states[2] = power_meter_->Read();
+    runtime_fft += pmt::Pmt::Seconds(states[0], states[1]);
+    runtime_adder += pmt::Pmt::Seconds(states[1], states[2]);
+  }
 
-  states[1] = power_meter_->Read();
   if (report_) {
-    report_->update(Report::wtiling_backward, states[0], states[1]);
+    report_->update(Report::subgrid_fft, runtime_fft);
+    report_->update(use_wtiles ? Report::wtiling_forward : Report::adder,
+                    runtime_adder);
+  }
+}
+
+void OptimizedKernels::run_splitter_fft(KERNEL_SPLITTER_FFT_ARGUMENTS) {
+  const int block_size = get_fused_block_size(nr_polarizations, subgrid_size);
+  const size_t sizeof_subgrid =
+      size_t(nr_polarizations) * subgrid_size * subgrid_size;
+  double runtime_splitter = 0;
+  double runtime_fft = 0;
+
+  for (int s = 0; s < nr_subgrids; s += block_size) {
+    const int current_nr_subgrids = std::min(block_size, nr_subgrids - s);
+    const idg::Metadata* metadata_ptr = &metadata[s];
+    std::complex<float>* subgrid_ptr = &subgrid[s * sizeof_subgrid];
+
+    pmt::State states[3];
+    states[0] = power_meter_->Read();
+    if (use_wtiles) {
+      splitter_wtiles(current_nr_subgrids, nr_polarizations, grid_size,
+                      subgrid_size, image_size, w_step, shift,
+                      subgrid_offset + s, wtile_initialize_set, metadata_ptr,
+                      subgrid_ptr, grid);
+    } else if (w_step != 0.0) {
+      kernel_splitter_wstack(current_nr_subgrids, nr_polarizations, grid_size,
+                             subgrid_size, metadata_ptr, subgrid_ptr, grid);
+    } else {
+      auto kernel = select_kernel(kSplitters, kernel_splitter<0, 0>,
+                                  subgrid_size, nr_polarizations);
+      kernel(current_nr_subgrids, nr_polarizations, grid_size, subgrid_size,
+             metadata_ptr, subgrid_ptr, grid);
+    }
+    states[1] = power_meter_->Read();
+    kernel_fft(grid_size, subgrid_size, current_nr_subgrids * nr_polarizations,
+               subgrid_ptr, FFTW_FORWARD);
+    states[2] = power_meter_->Read();
+    runtime_splitter += pmt::Pmt::Seconds(states[0], states[1]);
+    runtime_fft += pmt::Pmt::Seconds(states[1], states[2]);
   }
-}  // end run_splitter_wtiles
+
+  if (report_) {
+    report_->update(use_wtiles ? Report::wtiling_backward : Report::splitter,
+                    runtime_splitter);
+    report_->update(Report::subgrid_fft, runtime_fft);
+  }
+}
 
 }  // namespace cpu
 }  // namespace kernel
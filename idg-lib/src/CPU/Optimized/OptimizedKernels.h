@@ -6,6 +6,8 @@
 
 #include "../common/InstanceCPU.h"
 #include "../Reference/ReferenceKernels.h"
+#include "WTileFlushQueue.h"
+#include "WTilePrefetcher.h"
 
 namespace idg {
 namespace kernel {
@@ -19,8 +21,14 @@ class OptimizedKernels : public InstanceCPU {
 
   virtual void run_degridder(KERNEL_DEGRIDDER_ARGUMENTS) override;
 
+  bool do_supports_identity_aterms() override { return true; };
+
   virtual void run_fft(KERNEL_FFT_ARGUMENTS) override;
 
+  bool do_supports_fft_shift() override { return true; };
+
+  virtual void run_fft_shift(KERNEL_FFT_ARGUMENTS) override;
+
   virtual void run_subgrid_fft(KERNEL_SUBGRID_FFT_ARGUMENTS) override;
 
   virtual void run_adder(KERNEL_ADDER_ARGUMENTS) override;
@@ -51,7 +59,8 @@ class OptimizedKernels : public InstanceCPU {
   bool do_supports_wtiling() override { return true; };
 
   virtual size_t init_wtiles(int nr_polarizations, size_t grid_size,
-                             int subgrid_size) override;
+                             int subgrid_size, int wtile_size,
+                             size_t max_bytes) override;
 
   virtual void run_adder_tiles_to_grid(
       KERNEL_ADDER_TILES_TO_GRID_ARGUMENTS) override;
@@ -59,6 +68,34 @@ class OptimizedKernels : public InstanceCPU {
   virtual void run_adder_wtiles(KERNEL_ADDER_WTILES_ARGUMENTS) override;
 
   virtual void run_splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS) override;
+
+  virtual void set_wtile_flush_queue_size(int max_nr_pending) override;
+
+  virtual void set_wtile_prefetch_depth(int depth) override;
+
+  virtual void synchronize_wtiles() override;
+
+  /*
+   * Fused subgrid FFT and adder/splitter
+   */
+  bool do_supports_fused_fft() override { return true; };
+
+  virtual void run_fft_adder(KERNEL_FFT_ADDER_ARGUMENTS) override;
+
+  virtual void run_splitter_fft(KERNEL_SPLITTER_FFT_ARGUMENTS) override;
+
+  // run_adder_wtiles and run_splitter_wtiles, without performance reporting
+  void adder_wtiles(KERNEL_ADDER_WTILES_ARGUMENTS);
+  void splitter_wtiles(KERNEL_SPLITTER_WTILES_ARGUMENTS);
+
+  // Record the number of wtiles in an update event and the pixels in their
+  // w-padded tiles, see Report::update_wtiles
+  void report_wtiles(Report::ID id, const WTileUpdateInfo& wtile_info,
+                     int subgrid_size, float image_size, float w_step,
+                     const float* shift);
+
+  std::unique_ptr<WTileFlushQueue> wtile_flush_queue_;
+  std::unique_ptr<WTilePrefetcher> wtile_prefetcher_;
 };
 
 }  // end namespace cpu
@@ -0,0 +1,156 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include <omp.h>
+
+#include "../common/InstanceCPU.h"
+#include "WTileFlushQueue.h"
+#include "kernels/Kernels.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+
+namespace {
+void add_wtiles_to_grid(const WTileFlushQueue::Parameters& p, int nr_tiles,
+                        const int* tile_ids,
+                        const Coordinate* tile_coordinates,
+                        std::complex<float>* tiles,
+                        std::complex<float>* grid) {
+  optimized::kernel_adder_wtiles_to_grid(
+      p.nr_polarizations, p.grid_size, p.subgrid_size, p.wtile_size,
+      p.image_size, p.w_step, p.shift.data(), nr_tiles, tile_ids,
+      tile_coordinates, tiles, grid);
+}
+}  // namespace
+
+WTileFlushQueue::WTileFlushQueue(size_t max_nr_pending, int nr_threads,
+                                 AddFunction add_function)
+    : max_nr_pending_(max_nr_pending),
+      nr_threads_(std::max(1, nr_threads)),
+      add_function_(add_function ? std::move(add_function)
+                                 : AddFunction(add_wtiles_to_grid)) {
+  if (max_nr_pending == 0) {
+    throw std::invalid_argument("max_nr_pending should be at least 1");
+  }
+  thread_ = std::thread(&WTileFlushQueue::run, this);
+}
+
+WTileFlushQueue::~WTileFlushQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  flush_pushed_.notify_one();
+  thread_.join();
+}
+
+void WTileFlushQueue::push(const Parameters& parameters,
+                           const WTileUpdateInfo& wtile_flush_info,
+                           xt::xtensor<std::complex<float>, 4>& wtiles_buffer,
+                           std::complex<float>* grid) {
+  const size_t nr_tiles = wtile_flush_info.wtile_ids.size();
+  if (nr_tiles == 0) {
+    return;
+  }
+  const size_t nr_polarizations = wtiles_buffer.shape(1);
+  const size_t padded_tile_size = wtiles_buffer.shape(2);
+  const size_t sizeof_tile =
+      nr_polarizations * padded_tile_size * padded_tile_size;
+
+  Flush flush;
+  flush.parameters = parameters;
+  flush.tile_ids.resize(nr_tiles);
+  std::iota(flush.tile_ids.begin(), flush.tile_ids.end(), 0);
+  flush.tile_coordinates = wtile_flush_info.wtile_coordinates;
+  flush.grid = grid;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flush_done_.wait(lock, [&] { return queue_.size() < max_nr_pending_; });
+
+    // Reuse a staging buffer that is large enough. When there is none, the
+    // free buffers were made for other w-tiles and are released.
+    for (auto& buffer : free_buffers_) {
+      if (buffer.shape(0) >= nr_tiles && buffer.shape(1) == nr_polarizations &&
+          buffer.shape(2) == padded_tile_size) {
+        flush.tiles = std::move(buffer);
+        std::swap(buffer, free_buffers_.back());
+        free_buffers_.pop_back();
+        break;
+      }
+    }
+    if (!flush.tiles.size()) {
+      free_buffers_.clear();
+    }
+  }
+
+  if (!flush.tiles.size()) {
+    flush.tiles = xt::xtensor<std::complex<float>, 4>(
+        {nr_tiles, nr_polarizations, padded_tile_size, padded_tile_size});
+  }
+
+  // Move the w-tiles to the staging buffer, such that their slots in
+  // wtiles_buffer are zero for the next subgrids
+#pragma omp parallel for
+  for (size_t i = 0; i < nr_tiles; i++) {
+    std::complex<float>* tile =
+        &wtiles_buffer(wtile_flush_info.wtile_ids[i], 0, 0, 0);
+    std::copy_n(tile, sizeof_tile, &flush.tiles(i, 0, 0, 0));
+    std::fill_n(tile, sizeof_tile, std::complex<float>(0.0f, 0.0f));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(flush));
+  }
+  flush_pushed_.notify_one();
+}
+
+void WTileFlushQueue::synchronize() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  flush_done_.wait(lock, [&] { return queue_.empty(); });
+  if (exception_) {
+    std::exception_ptr exception = exception_;
+    exception_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+void WTileFlushQueue::run() {
+  // The number of threads applies to the parallel regions of this thread only
+  omp_set_num_threads(nr_threads_);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    flush_pushed_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+
+    // References to the elements of a deque remain valid on push_back
+    Flush& flush = queue_.front();
+    lock.unlock();
+    try {
+      add_function_(flush.parameters, flush.tile_ids.size(),
+                    flush.tile_ids.data(), flush.tile_coordinates.data(),
+                    flush.tiles.data(), flush.grid);
+      lock.lock();
+    } catch (...) {
+      lock.lock();
+      exception_ = std::current_exception();
+    }
+    free_buffers_.push_back(std::move(flush.tiles));
+    queue_.pop_front();
+    flush_done_.notify_all();
+  }
+}
+
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
@@ -0,0 +1,113 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_CPU_OPTIMIZED_WTILEFLUSHQUEUE_H_
+#define IDG_CPU_OPTIMIZED_WTILEFLUSHQUEUE_H_
+
+#include <array>
+#include <complex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <xtensor/xtensor.hpp>
+
+#include "common/Types.h"
+#include "common/WTiles.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+
+/*
+ * Projects flushed w-tiles onto the grid on a background thread, such that
+ * the adder can continue with the next subgrids while the w-tiles are
+ * transformed. push copies the w-tiles to a staging buffer and resets them in
+ * the w-tile buffer, after which their slots can be reused right away. The
+ * flushes are added to the grid in the order in which they are pushed, by a
+ * single worker thread. At most max_nr_pending flushes (and their staging
+ * buffers) are in the queue: push blocks until there is room.
+ *
+ * Only the worker writes to the grid while flushes are pending. Code that
+ * accesses the grid otherwise should call synchronize first.
+ */
+class WTileFlushQueue {
+ public:
+  struct Parameters {
+    int nr_polarizations;
+    int grid_size;
+    int subgrid_size;
+    int wtile_size;
+    float image_size;
+    float w_step;
+    std::array<float, 2> shift;
+  };
+
+  // Adds nr_tiles w-tiles, with the given ids in tiles, to grid
+  using AddFunction = std::function<void(
+      const Parameters& parameters, int nr_tiles, const int* tile_ids,
+      const Coordinate* tile_coordinates, std::complex<float>* tiles,
+      std::complex<float>* grid)>;
+
+  // The worker uses nr_threads OpenMP threads. The w-tiles are added to the
+  // grid with add_function, optimized::kernel_adder_wtiles_to_grid by
+  // default.
+  WTileFlushQueue(size_t max_nr_pending, int nr_threads,
+                  AddFunction add_function = nullptr);
+
+  // Waits for the pending flushes
+  ~WTileFlushQueue();
+
+  WTileFlushQueue(const WTileFlushQueue&) = delete;
+  WTileFlushQueue& operator=(const WTileFlushQueue&) = delete;
+
+  // Queue the w-tiles in wtile_flush_info, which are taken from wtiles_buffer,
+  // to be added to grid
+  void push(const Parameters& parameters,
+            const WTileUpdateInfo& wtile_flush_info,
+            xt::xtensor<std::complex<float>, 4>& wtiles_buffer,
+            std::complex<float>* grid);
+
+  // Wait until all pending flushes are added to the grid. Rethrows the
+  // exception of a flush that failed.
+  void synchronize();
+
+ private:
+  struct Flush {
+    Parameters parameters;
+    std::vector<int> tile_ids;
+    std::vector<Coordinate> tile_coordinates;
+    xt::xtensor<std::complex<float>, 4> tiles;
+    std::complex<float>* grid;
+  };
+
+  void run();
+
+  const size_t max_nr_pending_;
+  const int nr_threads_;
+  const AddFunction add_function_;
+
+  // The flush at the front is being processed by the worker, it is removed
+  // when it is done
+  std::deque<Flush> queue_;
+
+  // Staging buffers of completed flushes, for reuse by push
+  std::vector<xt::xtensor<std::complex<float>, 4>> free_buffers_;
+
+  std::mutex mutex_;
+  std::condition_variable flush_pushed_;
+  std::condition_variable flush_done_;
+  bool stop_ = false;
+  std::exception_ptr exception_;
+  std::thread thread_;
+};
+
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
+
+#endif
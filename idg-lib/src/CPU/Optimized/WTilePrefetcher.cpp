@@ -0,0 +1,196 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <omp.h>
+
+#include "../common/InstanceCPU.h"
+#include "WTilePrefetcher.h"
+#include "kernels/Kernels.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+
+namespace {
+
+bool is_same_update(const WTileUpdateInfo& a, const WTileUpdateInfo& b) {
+  return a.subgrid_index == b.subgrid_index && a.wtile_ids == b.wtile_ids &&
+         std::equal(a.wtile_coordinates.begin(), a.wtile_coordinates.end(),
+                    b.wtile_coordinates.begin(), b.wtile_coordinates.end(),
+                    [](const Coordinate& c1, const Coordinate& c2) {
+                      return c1.x == c2.x && c1.y == c2.y && c1.z == c2.z;
+                    });
+}
+
+}  // namespace
+
+WTilePrefetcher::WTilePrefetcher(size_t depth, int nr_threads)
+    : depth_(depth), nr_threads_(std::max(1, nr_threads)) {
+  if (depth == 0) {
+    throw std::invalid_argument("depth should be at least 1");
+  }
+  thread_ = std::thread(&WTilePrefetcher::run, this);
+}
+
+WTilePrefetcher::~WTilePrefetcher() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    clear(lock);
+    stop_ = true;
+  }
+  prefetch_pushed_.notify_one();
+  thread_.join();
+}
+
+void WTilePrefetcher::prefetch(const Parameters& parameters,
+                               const WTileUpdateSet& wtile_initialize_set,
+                               const std::complex<float>* grid) {
+  size_t nr_scheduled;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // The prefetches should be for the first events of the set
+    if (!queue_.empty() &&
+        (wtile_initialize_set.empty() ||
+         !is_same_update(queue_.front().wtile_initialize_info,
+                         wtile_initialize_set.front()) ||
+         queue_.front().grid != grid)) {
+      clear(lock);
+    }
+    nr_scheduled = queue_.size();
+  }
+
+  const size_t nr_events = std::min(depth_, wtile_initialize_set.size());
+  for (size_t event = nr_scheduled; event < nr_events; event++) {
+    const WTileUpdateInfo& wtile_initialize_info = wtile_initialize_set[event];
+    const size_t nr_tiles = wtile_initialize_info.wtile_ids.size();
+    Prefetch prefetch;
+    prefetch.parameters = parameters;
+    prefetch.wtile_initialize_info = wtile_initialize_info;
+    prefetch.tile_ids.resize(nr_tiles);
+    std::iota(prefetch.tile_ids.begin(), prefetch.tile_ids.end(), 0);
+    prefetch.grid = grid;
+
+    const size_t nr_polarizations = parameters.nr_polarizations;
+    const size_t padded_tile_size =
+        parameters.wtile_size + parameters.subgrid_size;
+    {
+      // Reuse a staging buffer that is large enough, as in WTileFlushQueue
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& buffer : free_buffers_) {
+        if (buffer.shape(0) >= nr_tiles &&
+            buffer.shape(1) == nr_polarizations &&
+            buffer.shape(2) == padded_tile_size) {
+          prefetch.tiles = std::move(buffer);
+          std::swap(buffer, free_buffers_.back());
+          free_buffers_.pop_back();
+          break;
+        }
+      }
+      if (!prefetch.tiles.size()) {
+        free_buffers_.clear();
+      }
+    }
+    if (!prefetch.tiles.size()) {
+      prefetch.tiles = xt::xtensor<std::complex<float>, 4>(
+          {std::max(nr_tiles, size_t(1)), nr_polarizations, padded_tile_size,
+           padded_tile_size});
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(std::move(prefetch));
+    }
+    prefetch_pushed_.notify_one();
+  }
+}
+
+bool WTilePrefetcher::fetch(
+    const WTileUpdateInfo& wtile_initialize_info,
+    xt::xtensor<std::complex<float>, 4>& wtiles_buffer) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (queue_.empty()) {
+    return false;
+  }
+  if (!is_same_update(queue_.front().wtile_initialize_info,
+                      wtile_initialize_info)) {
+    clear(lock);
+    return false;
+  }
+  prefetch_done_.wait(lock, [&] { return nr_done_ > 0; });
+  Prefetch prefetch = std::move(queue_.front());
+  queue_.pop_front();
+  nr_done_--;
+  lock.unlock();
+
+  if (prefetch.exception) {
+    std::rethrow_exception(prefetch.exception);
+  }
+
+  const size_t nr_tiles = wtile_initialize_info.wtile_ids.size();
+  const size_t sizeof_tile =
+      wtiles_buffer.shape(1) * wtiles_buffer.shape(2) * wtiles_buffer.shape(3);
+#pragma omp parallel for
+  for (size_t i = 0; i < nr_tiles; i++) {
+    std::copy_n(&prefetch.tiles(i, 0, 0, 0), sizeof_tile,
+                &wtiles_buffer(wtile_initialize_info.wtile_ids[i], 0, 0, 0));
+  }
+
+  lock.lock();
+  free_buffers_.push_back(std::move(prefetch.tiles));
+  return true;
+}
+
+void WTilePrefetcher::clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  clear(lock);
+}
+
+void WTilePrefetcher::clear(std::unique_lock<std::mutex>& lock) {
+  prefetch_done_.wait(lock, [&] { return nr_done_ == queue_.size(); });
+  for (Prefetch& prefetch : queue_) {
+    free_buffers_.push_back(std::move(prefetch.tiles));
+  }
+  queue_.clear();
+  nr_done_ = 0;
+}
+
+void WTilePrefetcher::run() {
+  // The number of threads applies to the parallel regions of this thread only
+  omp_set_num_threads(nr_threads_);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    prefetch_pushed_.wait(lock,
+                          [&] { return stop_ || nr_done_ < queue_.size(); });
+    if (nr_done_ == queue_.size()) {
+      return;
+    }
+
+    // The prefetches that are not done are not removed from the queue, and
+    // references to the elements of a deque remain valid on push_back
+    Prefetch& prefetch = queue_[nr_done_];
+    lock.unlock();
+    try {
+      const Parameters& p = prefetch.parameters;
+      const WTileUpdateInfo& info = prefetch.wtile_initialize_info;
+      optimized::kernel_splitter_wtiles_from_grid(
+          p.nr_polarizations, p.grid_size, p.subgrid_size, p.wtile_size,
+          p.image_size, p.w_step, p.shift.data(), info.wtile_ids.size(),
+          prefetch.tile_ids.data(), info.wtile_coordinates.data(),
+          prefetch.tiles.data(), prefetch.grid);
+    } catch (...) {
+      prefetch.exception = std::current_exception();
+    }
+    lock.lock();
+    nr_done_++;
+    prefetch_done_.notify_all();
+  }
+}
+
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
@@ -0,0 +1,99 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_CPU_OPTIMIZED_WTILEPREFETCHER_H_
+#define IDG_CPU_OPTIMIZED_WTILEPREFETCHER_H_
+
+#include <complex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <xtensor/xtensor.hpp>
+
+#include "common/Types.h"
+#include "common/WTiles.h"
+#include "WTileFlushQueue.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+
+/*
+ * Initializes the w-tiles of upcoming initialize events from the grid on a
+ * background thread, while the splitter and degridder process the subgrids
+ * before these events. The slots of the new w-tiles in the w-tile buffer are
+ * still in use until the event is reached, therefore the w-tiles are computed
+ * in staging buffers, which are copied to their slots by fetch.
+ *
+ * At most depth events are prefetched ahead. The grid should not change while
+ * w-tiles are prefetched, clear waits for the worker and discards the
+ * prefetched w-tiles.
+ */
+class WTilePrefetcher {
+ public:
+  using Parameters = WTileFlushQueue::Parameters;
+
+  // The worker uses nr_threads OpenMP threads
+  WTilePrefetcher(size_t depth, int nr_threads);
+
+  ~WTilePrefetcher();
+
+  WTilePrefetcher(const WTilePrefetcher&) = delete;
+  WTilePrefetcher& operator=(const WTilePrefetcher&) = delete;
+
+  // Start to initialize the w-tiles of the first depth events in
+  // wtile_initialize_set, unless they are prefetched already
+  void prefetch(const Parameters& parameters,
+                const WTileUpdateSet& wtile_initialize_set,
+                const std::complex<float>* grid);
+
+  // Copy the prefetched w-tiles of wtile_initialize_info to their slots in
+  // wtiles_buffer. Returns false when the event was not prefetched, in which
+  // case the w-tiles should be initialized by the caller.
+  bool fetch(const WTileUpdateInfo& wtile_initialize_info,
+             xt::xtensor<std::complex<float>, 4>& wtiles_buffer);
+
+  // Wait for the worker and discard all prefetched w-tiles
+  void clear();
+
+ private:
+  struct Prefetch {
+    Parameters parameters;
+    WTileUpdateInfo wtile_initialize_info;
+    std::vector<int> tile_ids;
+    xt::xtensor<std::complex<float>, 4> tiles;
+    const std::complex<float>* grid;
+    std::exception_ptr exception;
+  };
+
+  void run();
+
+  // Requires a lock on mutex_
+  void clear(std::unique_lock<std::mutex>& lock);
+
+  const size_t depth_;
+  const int nr_threads_;
+
+  // Prefetches in the order of their events, the first nr_done_ are done
+  std::deque<Prefetch> queue_;
+  size_t nr_done_ = 0;
+
+  // Staging buffers of fetched w-tiles, for reuse by prefetch
+  std::vector<xt::xtensor<std::complex<float>, 4>> free_buffers_;
+
+  std::mutex mutex_;
+  std::condition_variable prefetch_pushed_;
+  std::condition_variable prefetch_done_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
+
+#endif
@@ -0,0 +1,68 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Binning.h"
+
+#include <omp.h>
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+namespace {
+AdderStrategy adder_strategy = AdderStrategy::kBinned;
+
+// Minimum number of bins per thread, to balance the load when the subgrids are
+// not uniformly distributed over the grid
+constexpr long kMinNrBinsPerThread = 4;
+}  // namespace
+
+AdderStrategy get_adder_strategy() { return adder_strategy; }
+
+void set_adder_strategy(AdderStrategy strategy) { adder_strategy = strategy; }
+
+SubgridBins::SubgridBins(const std::vector<long>& rows, int subgrid_size) {
+  long nr_rows = 0;
+  for (long row : rows) {
+    nr_rows = std::max(nr_rows, row + subgrid_size);
+  }
+
+  const long min_nr_bins = kMinNrBinsPerThread * omp_get_max_threads();
+  bin_height_ =
+      std::max(1L, std::min(long(subgrid_size), nr_rows / min_nr_bins));
+  const long nr_bins = (nr_rows + bin_height_ - 1) / bin_height_;
+
+  // Count the number of subgrids per bin
+  offsets_.assign(nr_bins + 1, 0);
+  for (long row : rows) {
+    if (row < 0) continue;
+    const long first_bin = row / bin_height_;
+    const long last_bin = (row + subgrid_size - 1) / bin_height_;
+    for (long b = first_bin; b <= last_bin; b++) {
+      offsets_[b + 1]++;
+    }
+  }
+
+  // Compute the offset of every bin
+  for (long b = 0; b < nr_bins; b++) {
+    offsets_[b + 1] += offsets_[b];
+  }
+
+  // Fill the bins, in order of the subgrid index
+  subgrids_.resize(offsets_[nr_bins]);
+  std::vector<long> fill(offsets_.begin(), offsets_.end() - 1);
+  for (size_t s = 0; s < rows.size(); s++) {
+    if (rows[s] < 0) continue;
+    const long first_bin = rows[s] / bin_height_;
+    const long last_bin = (rows[s] + subgrid_size - 1) / bin_height_;
+    for (long b = first_bin; b <= last_bin; b++) {
+      subgrids_[fill[b]++] = s;
+    }
+  }
+}
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
@@ -0,0 +1,82 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_OPTIMIZED_BINNING_H_
+#define IDG_OPTIMIZED_BINNING_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "../KernelOptions.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+// Returns the strategy used by the kernels, kBinned by default
+AdderStrategy get_adder_strategy();
+
+void set_adder_strategy(AdderStrategy strategy);
+
+/*
+ * Set of grid rows processed by one thread (or one band):
+ * begin, begin + step, ..., up to (but not including) end.
+ */
+struct RowSet {
+  long begin;
+  long end;
+  long step;
+};
+
+/*
+ * Computes the rows y_begin, y_begin + rows.step, ... < y_end of a subgrid,
+ * with its first row at grid row `row`, that are part of the row set.
+ */
+inline void clip_rows(const RowSet& rows, long row, int subgrid_size,
+                      int* y_begin, int* y_end) {
+  long y = std::max(0L, rows.begin - row);
+  y += ((rows.begin - row - y) % rows.step + rows.step) % rows.step;
+  *y_begin = static_cast<int>(std::min(y, long(subgrid_size)));
+  *y_end = static_cast<int>(std::min(long(subgrid_size), rows.end - row));
+}
+
+/*
+ * Subgrids binned by bands of consecutive grid rows. Kernels that operate on a
+ * stack of grids (w-layers or w-tiles) use row layer * layer_size + y, such
+ * that the bands are disjoint across the stack as well. A subgrid is part of
+ * every band that it overlaps, the subgrids in a band are stored in increasing
+ * order. The band height is at most the subgrid size, but is reduced when
+ * needed to have several bands per thread.
+ */
+class SubgridBins {
+ public:
+  /*
+   * rows[s] is the first (stacked) grid row of subgrid s, or -1 for a subgrid
+   * that is not processed, e.g. because it does not fit in the grid.
+   */
+  SubgridBins(const std::vector<long>& rows, int subgrid_size);
+
+  int get_nr_bins() const { return offsets_.size() - 1; }
+
+  // All grid rows of bin b
+  RowSet get_rows(int b) const {
+    return {b * bin_height_, (b + 1) * bin_height_, 1};
+  }
+
+  // Range of the subgrids in bin b
+  const int* begin(int b) const { return subgrids_.data() + offsets_[b]; }
+  const int* end(int b) const { return subgrids_.data() + offsets_[b + 1]; }
+
+ private:
+  long bin_height_;
+  std::vector<long> offsets_;
+  std::vector<int> subgrids_;
+};
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
+
+#endif
@@ -1,6 +1,41 @@
 // Copyright (C) 2020 ASTRON (Netherlands Institute for Radio Astronomy)
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <cmath>
+
+/*
+ * Phasor extrapolation computes the phasor of the first channel and the
+ * phasor of the channel increment, after which the phasors of the subsequent
+ * channels follow from complex multiplications. This replaces one sincos per
+ * channel, but only pays off for subgrids with many channels.
+ */
+constexpr int kExtrapolationMinNrChannels = 8;
+
+// The extrapolated phasor accumulates rounding errors, it is therefore
+// recomputed directly (re-anchored) once every this many channels.
+constexpr int kExtrapolationAnchorInterval = 32;
+
+// Returns whether the phasors of nr_channels channels, with the given
+// wavenumbers, can be extrapolated. This requires enough channels and
+// (nearly) equally spaced wavenumbers.
+inline bool use_extrapolation(const int nr_channels, const float* wavenumbers) {
+  if (nr_channels < kExtrapolationMinNrChannels) {
+    return false;
+  }
+
+  const float wavenumber_delta =
+      (wavenumbers[nr_channels - 1] - wavenumbers[0]) / (nr_channels - 1);
+  for (int chan = 1; chan < nr_channels - 1; chan++) {
+    const float wavenumber = wavenumbers[0] + chan * wavenumber_delta;
+    if (std::abs(wavenumbers[chan] - wavenumber) >
+        1e-6f * std::abs(wavenumbers[chan])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 inline void compute_extrapolation_scalar(
     int* offset, const int outer_dim, const int inner_dim, float* input_real,
     float* input_imag, const float* delta_real, const float* delta_imag,
@@ -25,13 +60,11 @@ inline void compute_extrapolation_scalar(
   *offset = inner_dim;
 }  // compute_extrapolation_scalar
 
-inline void compute_extrapolation_avx(int* offset, const int outer_dim,
-                                      const int inner_dim, float* input_real,
-                                      float* input_imag,
-                                      const float* delta_real,
-                                      const float* delta_imag,
-                                      float* output_real, float* output_imag) {
-#if defined(__AVX__)
+IDG_TARGET_AVX inline void compute_extrapolation_avx(
+    int* offset, const int outer_dim, const int inner_dim, float* input_real,
+    float* input_imag, const float* delta_real, const float* delta_imag,
+    float* output_real, float* output_imag) {
+#if defined(__x86_64__)
   const int vector_length = 8;
 
   for (int o = 0; o < outer_dim; o++) {
@@ -59,11 +92,11 @@ inline void compute_extrapolation_avx(int* offset, const int outer_dim,
 #endif
 }  // end compute_extrapolation_avx
 
-inline void compute_extrapolation_avx_fma(
+IDG_TARGET_AVX2 inline void compute_extrapolation_avx_fma(
     int* offset, const int outer_dim, const int inner_dim, float* input_real,
     float* input_imag, const float* delta_real, const float* delta_imag,
     float* output_real, float* output_imag) {
-#if defined(__FMA__)
+#if defined(__x86_64__)
   const int vector_length = 8;
 
   for (int o = 0; o < outer_dim; o++) {
@@ -94,17 +127,23 @@ inline void compute_extrapolation(const int outer_dim, const int inner_dim,
                                   const float* delta_real,
                                   const float* delta_imag, float* output_real,
                                   float* output_imag) {
+  using idg::kernel::cpu::optimized::IsaLevel;
+  const IsaLevel isa_level = idg::kernel::cpu::optimized::get_isa_level();
   int offset = 0;
 
   // Vectorized loop, 8-elements, AVX FMA
-  compute_extrapolation_avx_fma(&offset, outer_dim, inner_dim, input_real,
-                                input_imag, delta_real, delta_imag, output_real,
-                                output_imag);
+  if (isa_level >= IsaLevel::kAvx2) {
+    compute_extrapolation_avx_fma(&offset, outer_dim, inner_dim, input_real,
+                                  input_imag, delta_real, delta_imag,
+                                  output_real, output_imag);
+  }
 
   // Vectorized loop, 8-elements, AVX
-  compute_extrapolation_avx(&offset, outer_dim, inner_dim, input_real,
-                            input_imag, delta_real, delta_imag, output_real,
-                            output_imag);
+  if (isa_level >= IsaLevel::kAvx) {
+    compute_extrapolation_avx(&offset, outer_dim, inner_dim, input_real,
+                              input_imag, delta_real, delta_imag, output_real,
+                              output_imag);
+  }
 
   // Remainder loop, scalar
   compute_extrapolation_scalar(&offset, outer_dim, inner_dim, input_real,
@@ -0,0 +1,84 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Isa.h"
+
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+namespace {
+IsaLevel isa_level = detect_isa_level();
+}  // namespace
+
+IsaLevel detect_isa_level() {
+#if defined(__x86_64__)
+  // __builtin_cpu_supports also checks whether the operating system saves the
+  // extended register state, as required for AVX and AVX-512
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return IsaLevel::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return IsaLevel::kAvx2;
+  }
+  if (__builtin_cpu_supports("avx")) {
+    return IsaLevel::kAvx;
+  }
+#endif
+  return IsaLevel::kScalar;
+}
+
+IsaLevel get_isa_level() { return isa_level; }
+
+void set_isa_level(IsaLevel level) {
+  if (level > detect_isa_level()) {
+    throw std::invalid_argument("Instruction set " + get_isa_name(level) +
+                                " is not supported by this CPU.");
+  }
+  isa_level = level;
+}
+
+size_t get_l2_cache_size() {
+  static const size_t l2_cache_size = [] {
+    long size = 0;
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return size > 0 ? static_cast<size_t>(size) : size_t(256 * 1024);
+  }();
+  return l2_cache_size;
+}
+
+std::string get_isa_name(IsaLevel level) {
+  switch (level) {
+    case IsaLevel::kAvx512:
+      return "avx512";
+    case IsaLevel::kAvx2:
+      return "avx2";
+    case IsaLevel::kAvx:
+      return "avx";
+    default:
+      return "scalar";
+  }
+}
+
+IsaLevel parse_isa_level(const std::string& name) {
+  for (IsaLevel level : {IsaLevel::kScalar, IsaLevel::kAvx, IsaLevel::kAvx2,
+                         IsaLevel::kAvx512}) {
+    if (name == get_isa_name(level)) {
+      return level;
+    }
+  }
+  throw std::invalid_argument("Unknown instruction set: " + name);
+}
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
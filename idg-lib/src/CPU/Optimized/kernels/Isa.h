@@ -0,0 +1,56 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_OPTIMIZED_ISA_H_
+#define IDG_OPTIMIZED_ISA_H_
+
+#include <cstddef>
+#include <string>
+
+#include "../KernelOptions.h"
+
+/*
+ * The vectorized helper functions (sincos, reduction, extrapolation) are
+ * compiled for every instruction set listed in IsaLevel, independent of the
+ * instruction set that the rest of the library is compiled for. Which variant
+ * is used is decided at runtime, based on the features of the CPU.
+ */
+#if defined(__x86_64__)
+#define IDG_TARGET_AVX __attribute__((target("avx")))
+#define IDG_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define IDG_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define IDG_TARGET_AVX
+#define IDG_TARGET_AVX2
+#define IDG_TARGET_AVX512
+#endif
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+// Returns the highest level supported by the CPU
+IsaLevel detect_isa_level();
+
+// Returns the level used by the kernels, the detected level by default
+IsaLevel get_isa_level();
+
+// Force the kernels to use the given level, throws std::invalid_argument when
+// the level is not supported by the CPU
+void set_isa_level(IsaLevel level);
+
+// Returns the size of the (per core) L2 cache in bytes, or a conservative
+// estimate when it can not be determined
+size_t get_l2_cache_size();
+
+// Convert between a level and its name: scalar, avx, avx2 or avx512
+std::string get_isa_name(IsaLevel level);
+IsaLevel parse_isa_level(const std::string& name);
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
+
+#endif
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <complex>
+#include <limits>
+#include <vector>
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -10,94 +12,151 @@
 #include "common/Types.h"
 #include "common/Index.h"
 
+#include "Binning.h"
+#include "Specialization.h"
+
 namespace idg {
 namespace kernel {
 namespace cpu {
 namespace optimized {
 
-void kernel_adder(const long nr_subgrids, const int nr_polarizations,
-                  const long grid_size, const int subgrid_size,
+template <int kSubgridSize, int kNrPolarizations>
+void kernel_adder(const long nr_subgrids, const int nr_polarizations_,
+                  const long grid_size, const int subgrid_size_,
                   const idg::Metadata* metadata,
                   const std::complex<float>* subgrid,
                   std::complex<float>* grid) {
+  // Use the compile-time subgrid size and number of polarizations, unless the
+  // generic kernel is used
+  const int subgrid_size = kSubgridSize ? kSubgridSize : subgrid_size_;
+  const int nr_polarizations =
+      kNrPolarizations ? kNrPolarizations : nr_polarizations_;
+
   // Precompute phasor
-  float phasor_real[subgrid_size][subgrid_size];
-  float phasor_imag[subgrid_size][subgrid_size];
+  std::vector<float> phasor_real(subgrid_size * subgrid_size);
+  std::vector<float> phasor_imag(subgrid_size * subgrid_size);
 
 #pragma omp parallel for collapse(2)
   for (int y = 0; y < subgrid_size; y++) {
     for (int x = 0; x < subgrid_size; x++) {
       float phase = M_PI * (x + y - subgrid_size) / subgrid_size;
-      phasor_real[y][x] = cosf(phase);
-      phasor_imag[y][x] = sinf(phase);
+      phasor_real[y * subgrid_size + x] = cosf(phase);
+      phasor_imag[y * subgrid_size + x] = sinf(phase);
     }
   }
 
-#pragma omp parallel
-  {
-    int num_threads = omp_get_num_threads();
-    int thread_id = omp_get_thread_num();
+  // Load the coordinates of subgrid s, mirrored for negative w-values, and
+  // return whether the subgrid fits in the grid
+  auto load_coordinate = [&](int s, int& subgrid_x, int& subgrid_y,
+                             int& subgrid_w, bool& negative_w) {
+    subgrid_x = metadata[s].coordinate.x;
+    subgrid_y = metadata[s].coordinate.y;
+    subgrid_w = metadata[s].coordinate.z;
+
+    negative_w = subgrid_w < 0;
+    if (negative_w) {
+      subgrid_x = grid_size - subgrid_x - subgrid_size + 1;
+      subgrid_y = grid_size - subgrid_y - subgrid_size + 1;
+      subgrid_w = -subgrid_w - 1;
+    }
 
+    return subgrid_x >= 1 && subgrid_x < grid_size - subgrid_size &&
+           subgrid_y >= 1 && subgrid_y < grid_size - subgrid_size;
+  };
+
+  // Add the rows of subgrid s that are part of the row set to the grid, rows
+  // are numbered subgrid_w * grid_size + y
+  auto add_subgrid = [&](int s, const RowSet& rows) {
+    int subgrid_x, subgrid_y, subgrid_w;
+    bool negative_w;
+    if (!load_coordinate(s, subgrid_x, subgrid_y, subgrid_w, negative_w)) {
+      return;
+    }
+
+    // Determine polarization index
+    const int index_pol_default[4] = {0, 1, 2, 3};
+    const int index_pol_transposed[4] = {0, 2, 1, 3};
+    int* index_pol =
+        (int*)(negative_w ? index_pol_default : index_pol_transposed);
+
+    // Iterate over the subgrid rows in the row set
+    int y_begin, y_end;
+    clip_rows(rows, subgrid_w * grid_size + subgrid_y, subgrid_size, &y_begin,
+              &y_end);
+    for (int y = y_begin; y < y_end; y += rows.step) {
+      // Iterate all columns of subgrid
+      for (int x = 0; x < subgrid_size; x++) {
+        // Compute position in subgrid
+        int x_src = (x + (subgrid_size / 2)) % subgrid_size;
+        int y_src = (y + (subgrid_size / 2)) % subgrid_size;
+
+        // Compute position in grid
+        int x_dst = subgrid_x + x;
+        int y_dst = subgrid_y + y;
+
+        // Load phasor
+        int idx = y * subgrid_size + x;
+        std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
+
+        // Add subgrid value to grid
+        for (int pol = 0; pol < nr_polarizations; pol++) {
+          int pol_dst = index_pol[pol];
+          long dst_idx = index_grid_4d(nr_polarizations, grid_size, subgrid_w,
+                                       pol_dst, y_dst, x_dst);
+          long src_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
+                                       y_src, x_src);
+          std::complex<float> value = phasor * subgrid[src_idx];
+          value = negative_w ? conj(value) : value;
+          grid[dst_idx] += value;
+        }  // end for pol
+      }    // end for x
+    }      // end for y
+  };
+
+  if (get_adder_strategy() == AdderStrategy::kBinned) {
+    // Bin the subgrids by the grid rows that they overlap
+    std::vector<long> rows(nr_subgrids);
     for (int s = 0; s < nr_subgrids; s++) {
-      // Load subgrid coordinates
-      int subgrid_x = metadata[s].coordinate.x;
-      int subgrid_y = metadata[s].coordinate.y;
-      int subgrid_w = metadata[s].coordinate.z;
-
-      // Mirror subgrid coordinates for negative w-values
-      bool negative_w = subgrid_w < 0;
-      if (negative_w) {
-        subgrid_x = grid_size - subgrid_x - subgrid_size + 1;
-        subgrid_y = grid_size - subgrid_y - subgrid_size + 1;
-        subgrid_w = -subgrid_w - 1;
+      int subgrid_x, subgrid_y, subgrid_w;
+      bool negative_w;
+      bool fits =
+          load_coordinate(s, subgrid_x, subgrid_y, subgrid_w, negative_w);
+      rows[s] = fits ? subgrid_w * grid_size + subgrid_y : -1;
+    }
+    const SubgridBins bins(rows, subgrid_size);
+
+    // Every thread adds the subgrids in its bins, restricted to the rows of
+    // the bin
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < bins.get_nr_bins(); b++) {
+      for (const int* s = bins.begin(b); s != bins.end(b); s++) {
+        add_subgrid(*s, bins.get_rows(b));
       }
-
-      // Check whether subgrid fits in grid
-      if (!(subgrid_x >= 1 && subgrid_x < grid_size - subgrid_size &&
-            subgrid_y >= 1 && subgrid_y < grid_size - subgrid_size))
-        continue;
-
-      // Determine polarization index
-      const int index_pol_default[4] = {0, 1, 2, 3};
-      const int index_pol_transposed[4] = {0, 2, 1, 3};
-      int* index_pol =
-          (int*)(negative_w ? index_pol_default : index_pol_transposed);
-
-      // Iterate over subgrid rows, starting at a row that belongs to this
-      // thread and stepping by the number of threads
-      int start_y =
-          (num_threads - (subgrid_y % num_threads) + thread_id) % num_threads;
-      for (int y = start_y; y < subgrid_size; y += num_threads) {
-        // Iterate all columns of subgrid
-        for (int x = 0; x < subgrid_size; x++) {
-          // Compute position in subgrid
-          int x_src = (x + (subgrid_size / 2)) % subgrid_size;
-          int y_src = (y + (subgrid_size / 2)) % subgrid_size;
-
-          // Compute position in grid
-          int x_dst = subgrid_x + x;
-          int y_dst = subgrid_y + y;
-
-          // Load phasor
-          std::complex<float> phasor = {phasor_real[y][x], phasor_imag[y][x]};
-
-          // Add subgrid value to grid
-          for (int pol = 0; pol < nr_polarizations; pol++) {
-            int pol_dst = index_pol[pol];
-            long dst_idx = index_grid_4d(nr_polarizations, grid_size, subgrid_w,
-                                         pol_dst, y_dst, x_dst);
-            long src_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
-                                         y_src, x_src);
-            std::complex<float> value = phasor * subgrid[src_idx];
-            value = negative_w ? conj(value) : value;
-            grid[dst_idx] += value;
-          }  // end for pol
-        }    // end for x
-      }      // end for y
-    }        // end for s
-  }          // end parallel
+    }
+  } else {
+#pragma omp parallel
+    {
+      // Every thread visits all subgrids, and adds only the rows that belong
+      // to this thread
+      const RowSet rows = {omp_get_thread_num(),
+                           std::numeric_limits<long>::max(),
+                           omp_get_num_threads()};
+      for (int s = 0; s < nr_subgrids; s++) {
+        add_subgrid(s, rows);
+      }
+    }
+  }
 }  // end kernel_adder
 
+// Instantiate the generic kernel and the specialized kernels
+#define INSTANTIATE_KERNEL_ADDER(subgrid_size, nr_polarizations)               \
+  template void kernel_adder<subgrid_size, nr_polarizations>(                  \
+      const long, const int, const long, const int, const idg::Metadata*,      \
+      const std::complex<float>*, std::complex<float>*);
+INSTANTIATE_KERNEL_ADDER(0, 0)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_ADDER, 1)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_ADDER, 4)
+
 }  // end namespace optimized
 }  // end namespace cpu
 }  // end namespace kernel
@@ -308,6 +308,14 @@ void kernel_phasor(const int nr_subgrids, const long grid_size,
     n_[i] = compute_n(l_[i], m_[i], shift);
   }
 
+  // The phasors are computed for all channels of every subgrid, extrapolate
+  // them across channels when there are enough (equally spaced) channels
+  const bool extrapolate = use_extrapolation(nr_channels, wavenumbers);
+  const float wavenumber_delta =
+      extrapolate ? (wavenumbers[nr_channels - 1] - wavenumbers[0]) /
+                        (nr_channels - 1)
+                  : 0;
+
 // Iterate all subgrids
 #pragma omp parallel for schedule(guided)
   for (int s = 0; s < nr_subgrids; s++) {
@@ -348,20 +356,49 @@ void kernel_phasor(const int nr_subgrids, const long grid_size,
         }
       }
 
+      // Compute delta phasor
+      float phasor_c_real[nr_pixels] __attribute__((aligned((ALIGNMENT))));
+      float phasor_c_imag[nr_pixels] __attribute__((aligned((ALIGNMENT))));
+      float phasor_d_real[nr_pixels] __attribute__((aligned((ALIGNMENT))));
+      float phasor_d_imag[nr_pixels] __attribute__((aligned((ALIGNMENT))));
+      if (extrapolate) {
+        float phase_delta[nr_pixels];
+        for (unsigned i = 0; i < nr_pixels; i++) {
+          phase_delta[i] = phase_index[i] * wavenumber_delta;
+        }
+        compute_sincos(nr_pixels, phase_delta, phasor_d_imag, phasor_d_real);
+      }
+
       // Iterate all channels
       for (int chan = 0; chan < nr_channels; chan++) {
+        // When extrapolating, the phasor is only computed directly once every
+        // kExtrapolationAnchorInterval channels
+        const bool anchor =
+            !extrapolate || (chan % kExtrapolationAnchorInterval) == 0;
+
         // Compute phase
         float phase[nr_pixels];
-        for (unsigned i = 0; i < nr_pixels; i++) {
-          phase[i] = (phase_index[i] * wavenumbers[chan]) - phase_offset[i];
+        if (anchor) {
+          for (unsigned i = 0; i < nr_pixels; i++) {
+            phase[i] = (phase_index[i] * wavenumbers[chan]) - phase_offset[i];
+          }
         }
 
         // Compute phasor
         float phasor_real[nr_pixels] __attribute__((aligned((ALIGNMENT))));
-        ;
         float phasor_imag[nr_pixels] __attribute__((aligned((ALIGNMENT))));
-        ;
-        compute_sincos(nr_pixels, phase, phasor_imag, phasor_real);
+        if (!extrapolate) {
+          compute_sincos(nr_pixels, phase, phasor_imag, phasor_real);
+        } else {
+          if (anchor) {
+            compute_sincos(nr_pixels, phase, phasor_c_imag, phasor_c_real);
+          }
+
+          // Use the base phasor and advance it to the next channel
+          compute_extrapolation(1, nr_pixels, phasor_c_real, phasor_c_imag,
+                                phasor_d_real, phasor_d_imag, phasor_real,
+                                phasor_imag);
+        }
 
         // Store phasor
         for (unsigned i = 0; i < nr_pixels; i++) {
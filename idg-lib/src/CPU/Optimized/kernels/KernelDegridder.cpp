@@ -6,17 +6,20 @@
 #include "common/Index.h"
 
 #include "Math.h"
+#include "Scratch.h"
+#include "Specialization.h"
 
 namespace idg {
 namespace kernel {
 namespace cpu {
 namespace optimized {
 
+template <int kSubgridSize, int kNrCorrelations>
 void kernel_degridder(
     const int nr_subgrids, const int nr_polarizations, const long grid_size,
-    const int subgrid_size, const float image_size,
+    const int subgrid_size_, const float image_size,
     const float w_step_in_lambda, const float* __restrict__ shift,
-    const int nr_correlations, const int nr_channels, const int nr_stations,
+    const int nr_correlations_, const int nr_channels, const int nr_stations,
     const idg::UVW<float>* uvw, const float* wavenumbers,
     std::complex<float>* visibilities, const float* taper,
     const std::complex<float>* aterms, const unsigned int* aterm_indices,
@@ -25,6 +28,12 @@ void kernel_degridder(
   initialize_lookup();
 #endif
 
+  // Use the compile-time subgrid size and number of correlations, unless the
+  // generic kernel is used
+  const int subgrid_size = kSubgridSize ? kSubgridSize : subgrid_size_;
+  const int nr_correlations =
+      kNrCorrelations ? kNrCorrelations : nr_correlations_;
+
   // Compute l,m,n
   const unsigned nr_pixels = subgrid_size * subgrid_size;
   float l_offset[nr_pixels];
@@ -46,25 +55,56 @@ void kernel_degridder(
     n_offset[i] = n_index[i];
   }
 
+  // With a single polarization (Stokes I only), only Stokes I is degridded
+  // and the result is stored in both the first and the last correlation
+  const bool stokes_i_only = nr_polarizations == 1;
+  const int nr_correlations_local = stokes_i_only ? 1 : nr_correlations;
+
+  // Size of the scratch memory needed per thread:
+  //  - real and imaginary part of the pixels for every correlation
+  //  - phase, phase offset, phase index and real and imaginary part of the
+  //    phasor
+  //  - real and imaginary part of the base and delta phasor, used for phasor
+  //    extrapolation
+  const size_t sizeof_scratch =
+      (2 * nr_correlations_local + 9) *
+      ScratchArena::sizeof_buffer<float>(nr_pixels);
+
 // Iterate all subgrids
 #pragma omp parallel for schedule(guided)
   for (int s = 0; s < nr_subgrids; s++) {
+    // Every thread has its own scratch memory, which persists across subgrids
+    // and kernel calls. Once it is large enough, no memory is allocated.
+    static thread_local ScratchArena arena;
+    arena.reserve(sizeof_scratch);
+
     // Load metadata
     const idg::Metadata m = metadata[s];
     const int time_offset = m.time_index;
     const int nr_timesteps = m.nr_timesteps;
     const int channel_begin = m.channel_begin;
     const int channel_end = m.channel_end;
+    const int nr_channels_subgrid = channel_end - channel_begin;
     const int station1 = m.baseline.station1;
     const int station2 = m.baseline.station2;
     const int x_coordinate = m.coordinate.x;
     const int y_coordinate = m.coordinate.y;
     const float w_offset_in_lambda = w_step_in_lambda * (m.coordinate.z + 0.5);
 
+    // Extrapolate the phasors across channels when the subgrid has enough
+    // (equally spaced) channels, compute them directly otherwise
+    const bool extrapolate =
+        use_extrapolation(nr_channels_subgrid, &wavenumbers[channel_begin]);
+    const float wavenumber_delta =
+        extrapolate
+            ? (wavenumbers[channel_end - 1] - wavenumbers[channel_begin]) /
+                  (nr_channels_subgrid - 1)
+            : 0;
+
     // Initialize aterm index to first timestep
     unsigned int aterm_idx_previous = aterm_indices[time_offset];
 
-    // Allocate memory
+    // Get scratch memory
     float* pixels_xx_real = nullptr;
     float* pixels_xx_imag = nullptr;
     float* pixels_xy_real = nullptr;
@@ -73,21 +113,27 @@ void kernel_degridder(
     float* pixels_yx_imag = nullptr;
     float* pixels_yy_real = nullptr;
     float* pixels_yy_imag = nullptr;
-    pixels_xx_real = allocate_memory<float>(nr_pixels);
-    pixels_xx_imag = allocate_memory<float>(nr_pixels);
-    if (nr_correlations == 4) {
-      pixels_xy_real = allocate_memory<float>(nr_pixels);
-      pixels_xy_imag = allocate_memory<float>(nr_pixels);
-      pixels_yx_real = allocate_memory<float>(nr_pixels);
-      pixels_yx_imag = allocate_memory<float>(nr_pixels);
+    pixels_xx_real = arena.allocate<float>(nr_pixels);
+    pixels_xx_imag = arena.allocate<float>(nr_pixels);
+    if (!stokes_i_only && nr_correlations == 4) {
+      pixels_xy_real = arena.allocate<float>(nr_pixels);
+      pixels_xy_imag = arena.allocate<float>(nr_pixels);
+      pixels_yx_real = arena.allocate<float>(nr_pixels);
+      pixels_yx_imag = arena.allocate<float>(nr_pixels);
+    }
+    if (!stokes_i_only) {
+      pixels_yy_real = arena.allocate<float>(nr_pixels);
+      pixels_yy_imag = arena.allocate<float>(nr_pixels);
     }
-    pixels_yy_real = allocate_memory<float>(nr_pixels);
-    pixels_yy_imag = allocate_memory<float>(nr_pixels);
-    float* phasor_real = allocate_memory<float>(nr_pixels);
-    float* phasor_imag = allocate_memory<float>(nr_pixels);
-    float* phase = allocate_memory<float>(nr_pixels);
-    float* phase_offset = allocate_memory<float>(nr_pixels);
-    float* phase_index = allocate_memory<float>(nr_pixels);
+    float* phasor_real = arena.allocate<float>(nr_pixels);
+    float* phasor_imag = arena.allocate<float>(nr_pixels);
+    float* phase = arena.allocate<float>(nr_pixels);
+    float* phase_offset = arena.allocate<float>(nr_pixels);
+    float* phase_index = arena.allocate<float>(nr_pixels);
+    float* phasor_c_real = arena.allocate<float>(nr_pixels);
+    float* phasor_c_imag = arena.allocate<float>(nr_pixels);
+    float* phasor_d_real = arena.allocate<float>(nr_pixels);
+    float* phasor_d_imag = arena.allocate<float>(nr_pixels);
 
     // Compute u and v offset in wavelenghts
     const float u_offset = (x_coordinate + subgrid_size / 2 - grid_size / 2) *
@@ -118,13 +164,21 @@ void kernel_degridder(
 #else
       bool aterm_changed;
 #endif
-      aterm_changed = aterm_idx_previous != aterm_idx_current;
+      aterm_changed = aterms && aterm_idx_previous != aterm_idx_current;
 
       // Compute phase index and apply phase shift.
       for (unsigned i = 0; i < nr_pixels; i++) {
         phase_index[i] = u * l_index[i] + v * m_index[i] + w * n_index[i];
       }
 
+      // Compute delta phasor
+      if (extrapolate) {
+        for (unsigned i = 0; i < nr_pixels; i++) {
+          phase[i] = phase_index[i] * wavenumber_delta;
+        }
+        compute_sincos(nr_pixels, phase, phasor_d_imag, phasor_d_real);
+      }
+
       // Apply aterm to subgrid
       if (time == 0 || aterm_changed) {
         for (unsigned i = 0; i < nr_pixels; i++) {
@@ -138,6 +192,34 @@ void kernel_degridder(
           int x_src = (x + (subgrid_size / 2)) % subgrid_size;
           int y_src = (y + (subgrid_size / 2)) % subgrid_size;
 
+          // Get pointers to the aterms, unless there are no aterms (identity
+          // aterms)
+          const std::complex<float>* aterm1_ptr = nullptr;
+          const std::complex<float>* aterm2_ptr = nullptr;
+          if (aterms) {
+            size_t station1_idx =
+                index_aterm(subgrid_size, 4, nr_stations, aterm_idx_current,
+                            station1, y, x, 0);
+            size_t station2_idx =
+                index_aterm(subgrid_size, 4, nr_stations, aterm_idx_current,
+                            station2, y, x, 0);
+            aterm1_ptr = &aterms[station1_idx];
+            aterm2_ptr = &aterms[station2_idx];
+          }
+
+          if (stokes_i_only) {
+            // Load Stokes I, apply taper and the scalar beam
+            size_t src_idx = index_subgrid(nr_polarizations, subgrid_size, s,
+                                           0, y_src, x_src);
+            std::complex<float> pixel = taper_ * subgrid[src_idx];
+            if (aterms) {
+              pixel *= compute_stokes_i_aterm_degridder(aterm1_ptr, aterm2_ptr);
+            }
+            pixels_xx_real[i] = pixel.real();
+            pixels_xx_imag[i] = pixel.imag();
+            continue;
+          }
+
           // Load pixel values and apply taper
           std::complex<float> pixels[4] __attribute__((aligned(ALIGNMENT)));
           if (nr_correlations == 4) {
@@ -155,15 +237,9 @@ void kernel_degridder(
           }
 
           // Apply aterm
-          size_t station1_idx =
-              index_aterm(subgrid_size, 4, nr_stations, aterm_idx_current,
-                          station1, y, x, 0);
-          size_t station2_idx =
-              index_aterm(subgrid_size, 4, nr_stations, aterm_idx_current,
-                          station2, y, x, 0);
-          const std::complex<float>* aterm1_ptr = &aterms[station1_idx];
-          const std::complex<float>* aterm2_ptr = &aterms[station2_idx];
-          apply_aterm_degridder(pixels, aterm1_ptr, aterm2_ptr);
+          if (aterms) {
+            apply_aterm_degridder(pixels, aterm1_ptr, aterm2_ptr);
+          }
 
           // Store pixels
           pixels_xx_real[i] = pixels[0].real();
@@ -184,21 +260,46 @@ void kernel_degridder(
 
       // Iterate all channels
       for (int chan = channel_begin; chan < channel_end; chan++) {
+        // When extrapolating, the phasor is only computed directly once every
+        // kExtrapolationAnchorInterval channels
+        const bool anchor =
+            !extrapolate ||
+            ((chan - channel_begin) % kExtrapolationAnchorInterval) == 0;
+
         // Compute phase
-        for (unsigned i = 0; i < nr_pixels; i++) {
-          // Compute phase
-          float wavenumber = wavenumbers[chan];
-          phase[i] = (phase_index[i] * wavenumber) - phase_offset[i];
+        if (anchor) {
+          for (unsigned i = 0; i < nr_pixels; i++) {
+            float wavenumber = wavenumbers[chan];
+            phase[i] = (phase_index[i] * wavenumber) - phase_offset[i];
+          }
         }
 
         // Compute phasor
-        compute_sincos(nr_pixels, phase, phasor_imag, phasor_real);
+        if (!extrapolate) {
+          compute_sincos(nr_pixels, phase, phasor_imag, phasor_real);
+        } else {
+          if (anchor) {
+            compute_sincos(nr_pixels, phase, phasor_c_imag, phasor_c_real);
+          }
+
+          // Use the base phasor and advance it to the next channel
+          compute_extrapolation(1, nr_pixels, phasor_c_real, phasor_c_imag,
+                                phasor_d_real, phasor_d_imag, phasor_real,
+                                phasor_imag);
+        }
 
         // Compute visibilities
         std::complex<float> sums[nr_correlations]
             __attribute__((aligned(ALIGNMENT)));
 
-        if (nr_correlations == 4) {
+        if (stokes_i_only) {
+          compute_reduction(nr_pixels, pixels_xx_real, pixels_xx_imag,
+                            phasor_real, phasor_imag, sums);
+          sums[nr_correlations - 1] = sums[0];
+          for (int pol = 1; pol < nr_correlations - 1; pol++) {
+            sums[pol] = 0;
+          }
+        } else if (nr_correlations == 4) {
           compute_reduction(nr_pixels, pixels_xx_real, pixels_xy_real,
                             pixels_yx_real, pixels_yy_real, pixels_xx_imag,
                             pixels_xy_imag, pixels_yx_imag, pixels_yy_imag,
@@ -221,24 +322,21 @@ void kernel_degridder(
         }
       }  // end for channel
     }    // end for time
-
-    // Free memory
-    free(pixels_xx_real);
-    free(pixels_xy_real);
-    free(pixels_yx_real);
-    free(pixels_yy_real);
-    free(pixels_xx_imag);
-    free(pixels_xy_imag);
-    free(pixels_yx_imag);
-    free(pixels_yy_imag);
-    free(phase);
-    free(phase_offset);
-    free(phase_index);
-    free(phasor_real);
-    free(phasor_imag);
-  }  // end s
+  }      // end s
 }  // end kernel_degridder
 
+// Instantiate the generic kernel and the specialized kernels
+#define INSTANTIATE_KERNEL_DEGRIDDER(subgrid_size, nr_correlations)            \
+  template void kernel_degridder<subgrid_size, nr_correlations>(               \
+      const int, const int, const long, const int, const float, const float,   \
+      const float*, const int, const int, const int, const idg::UVW<float>*,   \
+      const float*, std::complex<float>*, const float*,                        \
+      const std::complex<float>*, const unsigned int*, const idg::Metadata*,   \
+      const std::complex<float>*);
+INSTANTIATE_KERNEL_DEGRIDDER(0, 0)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_DEGRIDDER, 2)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_DEGRIDDER, 4)
+
 }  // end namespace optimized
 }  // end namespace cpu
 }  // end namespace kernel
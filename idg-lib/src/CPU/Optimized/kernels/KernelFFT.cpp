@@ -1,15 +1,20 @@
 // Copyright (C) 2020 ASTRON (Netherlands Institute for Radio Astronomy)
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <iostream>
 #include <complex>
+#include <stdexcept>
 
 #include <math.h>
 #include <fftw3.h>
 #include <stdint.h>
+#include <omp.h>
 
 #include "common/Types.h"
 #include "common/Index.h"
+#include "fft/FFTPlanCache.h"
+#include "Isa.h"
 
 #include "idg-config.h"
 
@@ -18,14 +23,17 @@ void copy_1d(unsigned long size, int pol,
              int col,  // copy_col: > 0, copy_row: -1
              int dir,  // backward: -1, forward: 1
              std::complex<float>* a, std::complex<float>* b,
-             std::complex<float> scale = {1, 1}) {
+             std::complex<float> scale = {1, 1},
+             bool checkerboard = false) {  // multiply by (-1)^(y+x)
   for (unsigned int i = 0; i < size; i++) {
     unsigned long a_idx = row == -1 ? index_grid_3d(size, pol, i, col)
                                     : index_grid_3d(size, pol, row, i);
     unsigned long b_idx = i;
     std::complex<float>& src = dir == 1 ? a[a_idx] : b[b_idx];
     std::complex<float>* dst = dir == 1 ? &b[b_idx] : &a[a_idx];
-    *dst = {src.real() * scale.real(), src.imag() * scale.imag()};
+    const float sign =
+        checkerboard && ((row == -1 ? col : row) + i) % 2 ? -1.0f : 1.0f;
+    *dst = {sign * src.real() * scale.real(), sign * src.imag() * scale.imag()};
   }
 }
 
@@ -35,12 +43,16 @@ namespace cpu {
 namespace optimized {
 
 void kernel_fft_grid(long size, long batch, std::complex<float>* data,
-                     int sign  // -1=FFTW_FORWARD, 1=FFTW_BACKWARD
-) {
-  // Create plan
-  fftwf_plan plan;
-  fftwf_complex* data_ptr = reinterpret_cast<fftwf_complex*>(data);
-  plan = fftwf_plan_dft_1d(size, data_ptr, data_ptr, sign, FFTW_ESTIMATE);
+                     int sign,  // -1=FFTW_FORWARD, 1=FFTW_BACKWARD
+                     bool shift) {
+  if (shift && size % 2) {
+    throw std::invalid_argument(
+        "Only grids with even height and width are supported.");
+  }
+
+  // Get plan, the temporary buffers are not necessarily aligned
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_1d(size, sign, false);
 
 #pragma omp parallel
   {
@@ -55,7 +67,7 @@ void kernel_fft_grid(long size, long batch, std::complex<float>* data,
         // Copy row data -> tmp
         int x = -1;
         int dir = 1;
-        copy_1d(size, i, y, x, dir, data, tmp.data());
+        copy_1d(size, i, y, x, dir, data, tmp.data(), {1, 1}, shift);
 
         // Perform the 1D FFT
         fftwf_execute_dft(plan, tmp_ptr, tmp_ptr);
@@ -86,68 +98,69 @@ void kernel_fft_grid(long size, long batch, std::complex<float>* data,
 
         // Copy column tmp -> data
         dir = -1;
-        copy_1d(size, i, y, x, dir, data, tmp.data(), scale);
+        copy_1d(size, i, y, x, dir, data, tmp.data(), scale, shift);
       }
     }  // end for pol
   }    // end omp parallel
-
-  // Destroy plan
-  fftwf_destroy_plan(plan);
 }
 
 void kernel_fft_subgrid(long size, long batch, std::complex<float>* data,
                         int sign) {
-  fftwf_complex* data_ptr = reinterpret_cast<fftwf_complex*>(data);
-
-  // 2D FFT
-  int rank = 2;
-
-  // For grids of size*size elements
-  int n[] = {(int)size, (int)size};
-
-  // Set stride
-  int istride = 1;
-  int ostride = istride;
-
-  // Set dist
-  int idist = n[0] * n[1];
-  int odist = idist;
-
-  // Planner flags
-  int flags = FFTW_ESTIMATE;
-
-  // Create plan
-  fftwf_plan plan;
-  plan = fftwf_plan_many_dft(rank, n, 1, data_ptr, n, istride, idist, data_ptr,
-                             n, ostride, odist, sign, flags);
-
-#pragma omp parallel for private(data_ptr)
-  for (int i = 0; i < batch; i++) {
-    data_ptr = reinterpret_cast<fftwf_complex*>(data) + i * size * size;
+  // The subgrids are transformed in chunks with a single batched plan, such
+  // that FFTW can vectorize over the subgrids in a chunk. A chunk fits in the
+  // L2 cache, the number of chunks is at least the number of threads.
+  const size_t sizeof_subgrid = size * size * sizeof(std::complex<float>);
+  const long nr_threads = omp_get_max_threads();
+  long chunk_size = std::max(1L, long(get_l2_cache_size() / sizeof_subgrid));
+  chunk_size = std::min(chunk_size, (batch + nr_threads - 1) / nr_threads);
+
+  // Use a power of two, to limit the number of plans. The subgrids that
+  // remain after the last chunk are transformed one by one.
+  while (chunk_size & (chunk_size - 1)) {
+    chunk_size &= chunk_size - 1;
+  }
+  chunk_size = std::max(1L, chunk_size);
+  const long nr_chunks = batch / chunk_size;
+  const long nr_tasks = nr_chunks + batch % chunk_size;
+
+  // Get plans, which can use aligned access when every subgrid is aligned
+  const bool aligned = FFTPlanCache::is_aligned(data) &&
+                       FFTPlanCache::is_aligned(data + size * size);
+  const int n[2] = {int(size), int(size)};
+  FFTPlanCache& plan_cache = FFTPlanCache::get_instance();
+  fftwf_plan plan_chunk = plan_cache.get_plan_many_dft(
+      2, n, chunk_size, 1, size * size, sign, aligned);
+  fftwf_plan plan_single =
+      plan_cache.get_plan_dft_2d(size, size, sign, aligned);
+
+#pragma omp parallel for schedule(dynamic)
+  for (long task = 0; task < nr_tasks; task++) {
+    const bool is_chunk = task < nr_chunks;
+    const long first = is_chunk ? task * chunk_size
+                                : nr_chunks * chunk_size + (task - nr_chunks);
+    const long count = is_chunk ? chunk_size : 1;
+    fftwf_complex* data_ptr =
+        reinterpret_cast<fftwf_complex*>(data) + first * size * size;
 
     // Execute FFTs
-    fftwf_execute_dft(plan, data_ptr, data_ptr);
+    fftwf_execute_dft(is_chunk ? plan_chunk : plan_single, data_ptr, data_ptr);
 
     // Scaling in case of an inverse FFT, so that FFT(iFFT())=identity()
     if (sign == FFTW_BACKWARD) {
       float scale = 1 / (double(size) * double(size));
-      for (int i = 0; i < size * size; i++) {
+      for (long i = 0; i < count * size * size; i++) {
         data_ptr[i][0] *= scale;
         data_ptr[i][1] *= scale;
       }
     }
-
-  }  // end for batch
-
-  // Cleanup
-  fftwf_destroy_plan(plan);
+  }  // end for task
 }
 
 void kernel_fft(long grid_size, long size, long batch,
                 std::complex<float>* data, int sign) {
   if (size == grid_size) {  // a bit of a hack; TODO: make separate functions
                             // for two cases
-    kernel_fft_grid(size, batch, data, sign);
+    kernel_fft_grid(size, batch, data, sign, false);
   } else {
     kernel_fft_subgrid(size, batch, data, sign);
   }
@@ -1,36 +1,63 @@
 // Copyright (C) 2020 ASTRON (Netherlands Institute for Radio Astronomy)
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
+
 #include "common/memory.h"
 #include "common/Types.h"
 #include "common/Index.h"
 
 #include "Math.h"
+#include "Scratch.h"
+#include "Specialization.h"
 
+template <int kSubgridSize>
 inline void update_subgrid(int nr_polarizations, int nr_pixels, int nr_stations,
-                           int subgrid_size, int subgrid, int aterm_index,
+                           int subgrid_size_, int subgrid, int aterm_index,
                            int station1, int station2, const float* taper,
                            const std::complex<float>* aterms,
                            const std::complex<float>* avg_aterm_correction,
                            const std::complex<float>* subgrid_local,
                            std::complex<float>* subgrid_global) {
+  // Use the compile-time subgrid size, unless the generic kernel is used
+  const int subgrid_size = kSubgridSize ? kSubgridSize : subgrid_size_;
+
   // Iterate all pixels in subgrid
   for (int i = 0; i < nr_pixels; i++) {
     int y = i / subgrid_size;
     int x = i % subgrid_size;
 
-    // Apply the conjugate transpose of the A-term
-    size_t station1_idx = index_aterm(subgrid_size, 4, nr_stations, aterm_index,
-                                      station1, y, x, 0);
-    size_t station2_idx = index_aterm(subgrid_size, 4, nr_stations, aterm_index,
-                                      station2, y, x, 0);
-    const std::complex<float>* aterm1_ptr = &aterms[station1_idx];
-    const std::complex<float>* aterm2_ptr = &aterms[station2_idx];
+    // Apply the conjugate transpose of the A-term, unless there are no
+    // aterms (identity aterms)
+    const std::complex<float>* aterm1_ptr = nullptr;
+    const std::complex<float>* aterm2_ptr = nullptr;
+    if (aterms) {
+      size_t station1_idx = index_aterm(subgrid_size, 4, nr_stations,
+                                        aterm_index, station1, y, x, 0);
+      size_t station2_idx = index_aterm(subgrid_size, 4, nr_stations,
+                                        aterm_index, station2, y, x, 0);
+      aterm1_ptr = &aterms[station1_idx];
+      aterm2_ptr = &aterms[station2_idx];
+    }
     std::complex<float> pixels[4];
-    for (int pol = 0; pol < 4; pol++) {
-      pixels[pol] = subgrid_local[pol * nr_pixels + i];
+    if (nr_polarizations == 1) {
+      // The local subgrid only holds Stokes I, apply the scalar beam
+      std::complex<float> pixel = subgrid_local[i];
+      if (aterms) {
+        pixel *= compute_stokes_i_aterm_gridder(aterm1_ptr, aterm2_ptr);
+      }
+      pixels[0] = pixel;
+      pixels[1] = 0;
+      pixels[2] = 0;
+      pixels[3] = pixel;
+    } else {
+      for (int pol = 0; pol < 4; pol++) {
+        pixels[pol] = subgrid_local[pol * nr_pixels + i];
+      }
+      if (aterms) {
+        apply_aterm_gridder(pixels, aterm1_ptr, aterm2_ptr);
+      }
     }
-    apply_aterm_gridder(pixels, aterm1_ptr, aterm2_ptr);
 
     if (avg_aterm_correction)
       apply_avg_aterm_correction(
@@ -63,10 +90,11 @@ namespace kernel {
 namespace cpu {
 namespace optimized {
 
+template <int kSubgridSize, int kNrCorrelations>
 void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
-                    const long grid_size, const int subgrid_size,
+                    const long grid_size, const int subgrid_size_,
                     const float image_size, const float w_step_in_lambda,
-                    const float* __restrict__ shift, const int nr_correlations,
+                    const float* __restrict__ shift, const int nr_correlations_,
                     const int nr_channels, const int nr_stations,
                     const idg::UVW<float>* uvw, const float* wavenumbers,
                     const std::complex<float>* visibilities, const float* taper,
@@ -79,6 +107,12 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
   initialize_lookup();
 #endif
 
+  // Use the compile-time subgrid size and number of correlations, unless the
+  // generic kernel is used
+  const int subgrid_size = kSubgridSize ? kSubgridSize : subgrid_size_;
+  const int nr_correlations =
+      kNrCorrelations ? kNrCorrelations : nr_correlations_;
+
   // Compute l,m,n
   const unsigned nr_pixels = subgrid_size * subgrid_size;
   float l_offset[nr_pixels];
@@ -100,9 +134,56 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
     n_offset[i] = n_index[i];
   }
 
+  // With a single polarization (Stokes I only), the correlations are summed
+  // while loading the visibilities and only Stokes I is gridded
+  const bool stokes_i_only = nr_polarizations == 1;
+  const int nr_correlations_local = stokes_i_only ? 1 : nr_correlations;
+  const int nr_polarizations_local = stokes_i_only ? 1 : 4;
+
+  // Find the largest number of timesteps and visibilities on any subgrid
+  size_t max_nr_timesteps = 0;
+  size_t max_nr_visibilities = 0;
+  for (int s = 0; s < nr_subgrids; s++) {
+    const idg::Metadata& m = metadata[s];
+    const size_t nr_visibilities =
+        m.nr_timesteps * (m.channel_end - m.channel_begin);
+    max_nr_timesteps = std::max(max_nr_timesteps, size_t(m.nr_timesteps));
+    max_nr_visibilities = std::max(max_nr_visibilities, nr_visibilities);
+  }
+
+  // Size of the scratch memory needed per thread:
+  //  - real and imaginary part of the visibilities for every correlation
+  //  - phase and real and imaginary part of the phasor
+  //  - local subgrid
+  //  - phase index, phase delta and real and imaginary part of the base and
+  //    delta phasor per timestep, used for phasor extrapolation
+  const size_t sizeof_scratch =
+      (2 * nr_correlations_local + 3) *
+          ScratchArena::sizeof_buffer<float>(max_nr_visibilities) +
+      ScratchArena::sizeof_buffer<std::complex<float>>(nr_polarizations_local *
+                                                       nr_pixels) +
+      6 * ScratchArena::sizeof_buffer<float>(max_nr_timesteps);
+
+  // The visibilities are processed in blocks of timesteps, sized such that
+  // the visibilities, phases and phasors of a block fit in half of the L2
+  // cache. Every pixel then reads the block from cache, rather than streaming
+  // all visibilities of the subgrid from memory. The pixels are not tiled:
+  // all pixels of the subgrid are processed for every block, the state of a
+  // pixel (its l, m, n and its local subgrid values) is only a few values and
+  // fits in cache next to the block.
+  const size_t sizeof_visibility =
+      (2 * nr_correlations_local + 3) * sizeof(float);
+  const size_t max_nr_visibilities_block =
+      get_l2_cache_size() / 2 / sizeof_visibility;
+
 // Iterate all subgrids
 #pragma omp parallel for schedule(guided)
   for (int s = 0; s < nr_subgrids; s++) {
+    // Every thread has its own scratch memory, which persists across subgrids
+    // and kernel calls. Once it is large enough, no memory is allocated.
+    static thread_local ScratchArena arena;
+    arena.reserve(sizeof_scratch);
+
     // Initialize global subgrid
     size_t subgrid_idx =
         index_subgrid(nr_polarizations, subgrid_size, s, 0, 0, 0);
@@ -117,13 +198,26 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
     const int channel_begin = m.channel_begin;
     const int channel_end = m.channel_end;
     const int nr_channels_subgrid = channel_end - channel_begin;
+    const int max_nr_timesteps_block =
+        std::max(size_t(1), max_nr_visibilities_block /
+                                std::max(1, nr_channels_subgrid));
     const int station1 = m.baseline.station1;
     const int station2 = m.baseline.station2;
     const int x_coordinate = m.coordinate.x;
     const int y_coordinate = m.coordinate.y;
     const float w_offset_in_lambda = w_step_in_lambda * (m.coordinate.z + 0.5);
 
-    // Allocate memory
+    // Extrapolate the phasors across channels when the subgrid has enough
+    // (equally spaced) channels, compute them directly otherwise
+    const bool extrapolate =
+        use_extrapolation(nr_channels_subgrid, &wavenumbers[channel_begin]);
+    const float wavenumber_delta =
+        extrapolate
+            ? (wavenumbers[channel_end - 1] - wavenumbers[channel_begin]) /
+                  (nr_channels_subgrid - 1)
+            : 0;
+
+    // Get scratch memory
     size_t total_nr_visibilities = nr_timesteps * nr_channels_subgrid;
     float* vis_xx_real = nullptr;
     float* vis_xx_imag = nullptr;
@@ -134,27 +228,36 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
     float* vis_yy_real = nullptr;
     float* vis_yy_imag = nullptr;
 
-    vis_xx_real = allocate_memory<float>(total_nr_visibilities);
-    vis_xx_imag = allocate_memory<float>(total_nr_visibilities);
-    if (nr_correlations == 4) {
-      vis_xy_real = allocate_memory<float>(total_nr_visibilities);
-      vis_xy_imag = allocate_memory<float>(total_nr_visibilities);
-      vis_yx_real = allocate_memory<float>(total_nr_visibilities);
-      vis_yx_imag = allocate_memory<float>(total_nr_visibilities);
+    vis_xx_real = arena.allocate<float>(total_nr_visibilities);
+    vis_xx_imag = arena.allocate<float>(total_nr_visibilities);
+    if (!stokes_i_only && nr_correlations == 4) {
+      vis_xy_real = arena.allocate<float>(total_nr_visibilities);
+      vis_xy_imag = arena.allocate<float>(total_nr_visibilities);
+      vis_yx_real = arena.allocate<float>(total_nr_visibilities);
+      vis_yx_imag = arena.allocate<float>(total_nr_visibilities);
     }
-    vis_yy_real = allocate_memory<float>(total_nr_visibilities);
-    vis_yy_imag = allocate_memory<float>(total_nr_visibilities);
-    float* phasor_real = allocate_memory<float>(total_nr_visibilities);
-    float* phasor_imag = allocate_memory<float>(total_nr_visibilities);
-    float* phase = allocate_memory<float>(total_nr_visibilities);
+    if (!stokes_i_only) {
+      vis_yy_real = arena.allocate<float>(total_nr_visibilities);
+      vis_yy_imag = arena.allocate<float>(total_nr_visibilities);
+    }
+    float* phasor_real = arena.allocate<float>(total_nr_visibilities);
+    float* phasor_imag = arena.allocate<float>(total_nr_visibilities);
+    float* phase = arena.allocate<float>(total_nr_visibilities);
+    float* phase_index = arena.allocate<float>(nr_timesteps);
+    float* phase_delta = arena.allocate<float>(nr_timesteps);
+    float* phasor_c_real = arena.allocate<float>(nr_timesteps);
+    float* phasor_c_imag = arena.allocate<float>(nr_timesteps);
+    float* phasor_d_real = arena.allocate<float>(nr_timesteps);
+    float* phasor_d_imag = arena.allocate<float>(nr_timesteps);
 
     // Initialize local subgrid
     //  - NR_CORRELATIONS=4, all four polarizations are used.
     //  - NR_CORRELATIONS=2, use only first and last polarization index.
+    //  - Stokes I only, a single polarization is used.
     std::complex<float>* subgrid_local =
-        allocate_memory<std::complex<float>>(4 * nr_pixels);
+        arena.allocate<std::complex<float>>(nr_polarizations_local * nr_pixels);
     memset(static_cast<void*>(subgrid_local), 0,
-           4 * nr_pixels * sizeof(std::complex<float>));
+           nr_polarizations_local * nr_pixels * sizeof(std::complex<float>));
 
     // Initialize aterm index to first timestep
     unsigned int aterm_idx_previous = aterm_indices[time_offset_global];
@@ -180,27 +283,38 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
 #else
       bool aterm_changed;
 #endif
-      aterm_changed = aterm_idx_previous != aterm_idx_current;
-
-      // Determine number of timesteps to process
-      current_nr_timesteps = 0;
-      for (int time = time_offset_local; time < nr_timesteps; time++) {
-        if (aterm_indices[time_offset_global + time] == aterm_idx_current) {
-          current_nr_timesteps++;
-        } else {
-          break;
+      aterm_changed = aterms && aterm_idx_previous != aterm_idx_current;
+
+      // Determine number of timesteps to process. Without aterms, the
+      // timesteps do not need to be split on aterm boundaries.
+      if (aterms) {
+        current_nr_timesteps = 0;
+        for (int time = time_offset_local; time < nr_timesteps; time++) {
+          if (aterm_indices[time_offset_global + time] == aterm_idx_current) {
+            current_nr_timesteps++;
+          } else {
+            break;
+          }
         }
+      } else {
+        current_nr_timesteps = nr_timesteps - time_offset_local;
       }
 
+      // Limit the number of timesteps to the block size
+      current_nr_timesteps =
+          std::min(current_nr_timesteps, max_nr_timesteps_block);
+
       if (aterm_changed) {
         // Update subgrid
-        update_subgrid(nr_polarizations, nr_pixels, nr_stations, subgrid_size,
-                       s, aterm_idx_previous, station1, station2, taper, aterms,
-                       avg_aterm_correction, subgrid_local, subgrid);
+        update_subgrid<kSubgridSize>(
+            nr_polarizations, nr_pixels, nr_stations, subgrid_size, s,
+            aterm_idx_previous, station1, station2, taper, aterms,
+            avg_aterm_correction, subgrid_local, subgrid);
 
         // Reset local subgrid for new aterms
-        memset(static_cast<void*>(subgrid_local), 0,
-               4 * nr_pixels * sizeof(std::complex<float>));
+        memset(
+            static_cast<void*>(subgrid_local), 0,
+            nr_polarizations_local * nr_pixels * sizeof(std::complex<float>));
 
         // Update aterm indices
         aterm_idx_previous = aterm_idx_current;
@@ -213,13 +327,17 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
           int chan_idx = chan - channel_begin;
           size_t src_idx =
               index_visibility(nr_correlations, nr_channels, time_idx, chan, 0);
-#if !defined(USE_EXTRAPOLATE)
-          size_t dst_idx = time * nr_channels_subgrid + chan_idx;
-#else
-          size_t dst_idx = chan_idx * current_nr_timesteps + time;
-#endif
-
-          if (nr_correlations == 4) {
+          size_t dst_idx = extrapolate
+                               ? chan_idx * current_nr_timesteps + time
+                               : time * nr_channels_subgrid + chan_idx;
+
+          if (stokes_i_only) {
+            const std::complex<float> vis_i =
+                0.5f * (visibilities[src_idx] +
+                        visibilities[src_idx + nr_correlations - 1]);
+            vis_xx_real[dst_idx] = vis_i.real();
+            vis_xx_imag[dst_idx] = vis_i.imag();
+          } else if (nr_correlations == 4) {
             vis_xx_real[dst_idx] = visibilities[src_idx + 0].real();
             vis_xx_imag[dst_idx] = visibilities[src_idx + 0].imag();
             vis_xy_real[dst_idx] = visibilities[src_idx + 1].real();
@@ -242,11 +360,6 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
         int y = i / subgrid_size;
         int x = i % subgrid_size;
 
-#if !defined(USE_EXTRAPOLATE)
-        // Compute phase
-        float phase[current_nr_timesteps * nr_channels_subgrid]
-            __attribute__((aligned(ALIGNMENT)));
-
         // Compute phase offset
         const float phase_offset = u_offset * l_offset[i] +
                                    v_offset * m_offset[i] +
@@ -260,82 +373,65 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
           const float w = uvw[time_idx].w;
 
           // Compute phase index, including phase shift.
-          const float phase_index =
-              u * l_index[i] + v * m_index[i] + w * n_index[i];
+          phase_index[time] = u * l_index[i] + v * m_index[i] + w * n_index[i];
+        }  // end time
 
+        if (!extrapolate) {
           // Compute phase
-          for (int chan = channel_begin; chan < channel_end; chan++) {
-            const int chan_idx = chan - channel_begin;
-            const float wavenumber = wavenumbers[chan];
-            phase[time * nr_channels_subgrid + chan_idx] =
-                phase_offset - (phase_index * wavenumber);
+          for (int time = 0; time < current_nr_timesteps; time++) {
+            for (int chan = channel_begin; chan < channel_end; chan++) {
+              const int chan_idx = chan - channel_begin;
+              const float wavenumber = wavenumbers[chan];
+              phase[time * nr_channels_subgrid + chan_idx] =
+                  phase_offset - (phase_index[time] * wavenumber);
+            }
           }
-        }  // end time
 
-        size_t current_nr_visibilities =
-            current_nr_timesteps * nr_channels_subgrid;
-
-        // Compute phasor
-        compute_sincos(current_nr_visibilities, phase, phasor_imag,
-                       phasor_real);
-#else
-        float phase_0_[current_nr_timesteps]
-            __attribute__((aligned(ALIGNMENT)));
-        float phase_d_[current_nr_timesteps]
-            __attribute__((aligned(ALIGNMENT)));
-        float phasor_c_real_[current_nr_timesteps]
-            __attribute__((aligned(ALIGNMENT)));
-        float phasor_c_imag_[current_nr_timesteps]
-            __attribute__((aligned(ALIGNMENT)));
-        float phasor_d_real_[current_nr_timesteps]
-            __attribute__((aligned(ALIGNMENT)));
-        float phasor_d_imag_[current_nr_timesteps]
-            __attribute__((aligned(ALIGNMENT)));
-
-        for (int time = 0; time < current_nr_timesteps; time++) {
-          // Load UVW coordinate
-          const int time_idx = time_offset_global + time_offset_local + time;
-          const float u = uvw[time_idx].u;
-          const float v = uvw[time_idx].v;
-          const float w = uvw[time_idx].w;
-
-          // Compute phase index and apply phase shift.
-          const float phase_index =
-              u * l_index[i] + v * m_index[i] + w * n_index[i];
-
-          // Compute phase offset
-          const float phase_offset = u_offset * l_offset[i] +
-                                     v_offset * m_offset[i] +
-                                     w_offset * n_offset[i];
-
-          // Compute phases
-          const float phase_0 = phase_offset - (phase_index * wavenumbers[0]);
-          const float phase_1 =
-              phase_offset - (phase_index * wavenumbers[channel_end - 1]);
-          const float phase_d = (phase_1 - phase_0) / (nr_channels_subgrid - 1);
-          phase_0_[time] = phase_0;
-          phase_d_[time] = phase_d;
+          // Compute phasor
+          compute_sincos(current_nr_timesteps * nr_channels_subgrid, phase,
+                         phasor_imag, phasor_real);
+        } else {
+          // Compute delta phasor
+          for (int time = 0; time < current_nr_timesteps; time++) {
+            phase_delta[time] = -(phase_index[time] * wavenumber_delta);
+          }
+          compute_sincos(current_nr_timesteps, phase_delta, phasor_d_imag,
+                         phasor_d_real);
+
+          // Extrapolate phasors, starting from a directly computed base
+          // phasor for every block of channels
+          for (int chan_idx = 0; chan_idx < nr_channels_subgrid;
+               chan_idx += kExtrapolationAnchorInterval) {
+            const int current_nr_channels = std::min(
+                kExtrapolationAnchorInterval, nr_channels_subgrid - chan_idx);
+            const float wavenumber = wavenumbers[channel_begin + chan_idx];
+
+            // Compute base phasor
+            for (int time = 0; time < current_nr_timesteps; time++) {
+              phase[time] = phase_offset - (phase_index[time] * wavenumber);
+            }
+            compute_sincos(current_nr_timesteps, phase, phasor_c_imag,
+                           phasor_c_real);
+
+            // Extrapolate phasors
+            const size_t offset = chan_idx * current_nr_timesteps;
+            compute_extrapolation(current_nr_channels, current_nr_timesteps,
+                                  phasor_c_real, phasor_c_imag, phasor_d_real,
+                                  phasor_d_imag, &phasor_real[offset],
+                                  &phasor_imag[offset]);
+          }
         }
 
-        // Compute base and delta phasors
-        compute_sincos(current_nr_timesteps, phase_0_, phasor_c_imag_,
-                       phasor_c_real_);
-        compute_sincos(current_nr_timesteps, phase_d_, phasor_d_imag_,
-                       phasor_d_real_);
-
-        // Extrapolate phasors
-        compute_extrapolation(nr_channels_subgrid, current_nr_timesteps,
-                              phasor_c_real_, phasor_c_imag_, phasor_d_real_,
-                              phasor_d_imag_, phasor_real, phasor_imag);
-
         size_t current_nr_visibilities =
             current_nr_timesteps * nr_channels_subgrid;
-#endif
 
         // Compute pixels
         std::complex<float> pixels[nr_correlations]
             __attribute__((aligned(ALIGNMENT)));
-        if (nr_correlations == 4) {
+        if (stokes_i_only) {
+          compute_reduction(current_nr_visibilities, vis_xx_real, vis_xx_imag,
+                            phasor_real, phasor_imag, pixels);
+        } else if (nr_correlations == 4) {
           compute_reduction(current_nr_visibilities, vis_xx_real, vis_xy_real,
                             vis_yx_real, vis_yy_real, vis_xx_imag, vis_xy_imag,
                             vis_yx_imag, vis_yy_imag, phasor_real, phasor_imag,
@@ -347,7 +443,9 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
         }
 
         // Update local subgrid
-        if (nr_correlations == 4) {
+        if (stokes_i_only) {
+          subgrid_local[i] += pixels[0];
+        } else if (nr_correlations == 4) {
           for (int pol = 0; pol < 4; pol++) {
             size_t idx =
                 index_subgrid(nr_polarizations, subgrid_size, 0, pol, y, x);
@@ -362,26 +460,25 @@ void kernel_gridder(const int nr_subgrids, const int nr_polarizations,
       }  // end for i (pixels)
     }    // end time_offset_local
 
-    update_subgrid(nr_polarizations, nr_pixels, nr_stations, subgrid_size, s,
-                   aterm_idx_previous, station1, station2, taper, aterms,
-                   avg_aterm_correction, subgrid_local, subgrid);
-
-    // Free memory
-    free(vis_xx_real);
-    free(vis_xy_real);
-    free(vis_yx_real);
-    free(vis_yy_real);
-    free(vis_xx_imag);
-    free(vis_xy_imag);
-    free(vis_yx_imag);
-    free(vis_yy_imag);
-    free(phase);
-    free(phasor_real);
-    free(phasor_imag);
-    free(subgrid_local);
+    update_subgrid<kSubgridSize>(nr_polarizations, nr_pixels, nr_stations,
+                                 subgrid_size, s, aterm_idx_previous, station1,
+                                 station2, taper, aterms, avg_aterm_correction,
+                                 subgrid_local, subgrid);
   }  // end s
 }  // end kernel_gridder
 
+// Instantiate the generic kernel and the specialized kernels
+#define INSTANTIATE_KERNEL_GRIDDER(subgrid_size, nr_correlations)              \
+  template void kernel_gridder<subgrid_size, nr_correlations>(                 \
+      const int, const int, const long, const int, const float, const float,   \
+      const float*, const int, const int, const int, const idg::UVW<float>*,   \
+      const float*, const std::complex<float>*, const float*,                  \
+      const std::complex<float>*, const unsigned int*,                         \
+      const std::complex<float>*, const idg::Metadata*, std::complex<float>*);
+INSTANTIATE_KERNEL_GRIDDER(0, 0)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_GRIDDER, 2)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_GRIDDER, 4)
+
 }  // end namespace optimized
 }  // end namespace cpu
 }  // end namespace kernel
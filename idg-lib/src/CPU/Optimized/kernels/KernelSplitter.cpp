@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <complex>
+#include <vector>
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -9,31 +10,48 @@
 #include "common/Types.h"
 #include "common/Index.h"
 
+#include "Binning.h"
+#include "Specialization.h"
+
 namespace idg {
 namespace kernel {
 namespace cpu {
 namespace optimized {
 
-void kernel_splitter(const long nr_subgrids, const int nr_polarizations,
-                     const long grid_size, const int subgrid_size,
+template <int kSubgridSize, int kNrPolarizations>
+void kernel_splitter(const long nr_subgrids, const int nr_polarizations_,
+                     const long grid_size, const int subgrid_size_,
                      const idg::Metadata* metadata,
                      std::complex<float>* subgrid,
                      const std::complex<float>* grid) {
+  // Use the compile-time subgrid size and number of polarizations, unless the
+  // generic kernel is used
+  const int subgrid_size = kSubgridSize ? kSubgridSize : subgrid_size_;
+  const int nr_polarizations =
+      kNrPolarizations ? kNrPolarizations : nr_polarizations_;
+
   // Precompute phaosr
-  float phasor_real[subgrid_size][subgrid_size];
-  float phasor_imag[subgrid_size][subgrid_size];
+  std::vector<float> phasor_real(subgrid_size * subgrid_size);
+  std::vector<float> phasor_imag(subgrid_size * subgrid_size);
 
 #pragma omp parallel for collapse(2)
   for (int y = 0; y < subgrid_size; y++) {
     for (int x = 0; x < subgrid_size; x++) {
       float phase = -M_PI * (x + y - subgrid_size) / subgrid_size;
-      phasor_real[y][x] = cosf(phase);
-      phasor_imag[y][x] = sinf(phase);
+      phasor_real[y * subgrid_size + x] = cosf(phase);
+      phasor_imag[y * subgrid_size + x] = sinf(phase);
     }
   }
 
-#pragma omp parallel for
-  for (int s = 0; s < nr_subgrids; s++) {
+  // Check whether subgrid s fits in grid
+  auto fits = [&](int s) {
+    int subgrid_x = metadata[s].coordinate.x;
+    int subgrid_y = metadata[s].coordinate.y;
+    return subgrid_x >= 0 && subgrid_x < grid_size - subgrid_size - 1 &&
+           subgrid_y >= 0 && subgrid_y < grid_size - subgrid_size - 1;
+  };
+
+  auto split_subgrid = [&](int s) {
     // Load subgrid coordinates
     int subgrid_x = metadata[s].coordinate.x;
     int subgrid_y = metadata[s].coordinate.y;
@@ -58,13 +76,9 @@ void kernel_splitter(const long nr_subgrids, const int nr_polarizations,
         int x_src = negative_w ? grid_size - subgrid_x - x : subgrid_x + x;
         int y_src = negative_w ? grid_size - subgrid_y - y : subgrid_y + y;
 
-        // Check whether subgrid fits in grid
-        if (!(subgrid_x >= 0 && subgrid_x < grid_size - subgrid_size - 1 &&
-              subgrid_y >= 0 && subgrid_y < grid_size - subgrid_size - 1))
-          continue;
-
         // Load phasor
-        std::complex<float> phasor = {phasor_real[y][x], phasor_imag[y][x]};
+        int idx = y * subgrid_size + x;
+        std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
 
         // Set grid value to subgrid
         for (int pol = 0; pol < nr_polarizations; pol++) {
@@ -79,9 +93,50 @@ void kernel_splitter(const long nr_subgrids, const int nr_polarizations,
         }  // end for pol
       }    // end for x
     }      // end for y
-  }        // end for s
+  };
+
+  if (get_adder_strategy() == AdderStrategy::kBinned) {
+    // Bin the subgrids by the first grid row that they read
+    std::vector<long> rows(nr_subgrids);
+    for (int s = 0; s < nr_subgrids; s++) {
+      int subgrid_y = metadata[s].coordinate.y;
+      bool negative_w = metadata[s].coordinate.z < 0;
+      rows[s] = !fits(s)     ? -1
+                : negative_w ? grid_size - subgrid_y - subgrid_size + 1
+                             : subgrid_y;
+    }
+    const SubgridBins bins(rows, subgrid_size);
+
+    // The splitter does not write to the grid, every subgrid is therefore
+    // processed only once, as part of the bin of its first row. Threads
+    // processing neighbouring bins read the same grid rows.
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < bins.get_nr_bins(); b++) {
+      for (const int* s = bins.begin(b); s != bins.end(b); s++) {
+        if (rows[*s] >= bins.get_rows(b).begin) {
+          split_subgrid(*s);
+        }
+      }
+    }
+  } else {
+#pragma omp parallel for
+    for (int s = 0; s < nr_subgrids; s++) {
+      if (fits(s)) {
+        split_subgrid(s);
+      }
+    }
+  }
 }  // end kernel_splitter
 
+// Instantiate the generic kernel and the specialized kernels
+#define INSTANTIATE_KERNEL_SPLITTER(subgrid_size, nr_polarizations)            \
+  template void kernel_splitter<subgrid_size, nr_polarizations>(               \
+      const long, const int, const long, const int, const idg::Metadata*,      \
+      std::complex<float>*, const std::complex<float>*);
+INSTANTIATE_KERNEL_SPLITTER(0, 0)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_SPLITTER, 1)
+IDG_FOR_EACH_SUBGRID_SIZE(INSTANTIATE_KERNEL_SPLITTER, 4)
+
 }  // end namespace optimized
 }  // end namespace cpu
 }  // end namespace kernel
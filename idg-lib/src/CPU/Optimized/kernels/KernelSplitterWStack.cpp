@@ -2,10 +2,13 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <complex>
+#include <vector>
 
 #include "common/Types.h"
 #include "common/Index.h"
 
+#include "Binning.h"
+
 namespace idg {
 namespace kernel {
 namespace cpu {
@@ -17,20 +20,27 @@ void kernel_splitter_wstack(const int nr_subgrids, const int nr_polarizations,
                             std::complex<float>* subgrid,
                             const std::complex<float>* grid) {
   // Precompute phaosr
-  float phasor_real[subgrid_size][subgrid_size];
-  float phasor_imag[subgrid_size][subgrid_size];
+  std::vector<float> phasor_real(subgrid_size * subgrid_size);
+  std::vector<float> phasor_imag(subgrid_size * subgrid_size);
 
 #pragma omp parallel for collapse(2)
   for (int y = 0; y < subgrid_size; y++) {
     for (int x = 0; x < subgrid_size; x++) {
       float phase = -M_PI * (x + y - subgrid_size) / subgrid_size;
-      phasor_real[y][x] = cosf(phase);
-      phasor_imag[y][x] = sinf(phase);
+      phasor_real[y * subgrid_size + x] = cosf(phase);
+      phasor_imag[y * subgrid_size + x] = sinf(phase);
     }
   }
 
-#pragma omp parallel for
-  for (int s = 0; s < nr_subgrids; s++) {
+  // Check whether subgrid s fits in grid
+  auto fits = [&](int s) {
+    int subgrid_x = metadata[s].coordinate.x;
+    int subgrid_y = metadata[s].coordinate.y;
+    return subgrid_x >= 1 && subgrid_x < grid_size - subgrid_size &&
+           subgrid_y >= 1 && subgrid_y < grid_size - subgrid_size;
+  };
+
+  auto split_subgrid = [&](int s) {
     // Load position in grid
     int subgrid_x = metadata[s].coordinate.x;
     int subgrid_y = metadata[s].coordinate.y;
@@ -56,27 +66,56 @@ void kernel_splitter_wstack(const int nr_subgrids, const int nr_polarizations,
         int x_src = negative_w ? grid_size - subgrid_x - x : subgrid_x + x;
         int y_src = negative_w ? grid_size - subgrid_y - y : subgrid_y + y;
 
-        // Check whether subgrid fits in grid
-        if (subgrid_x >= 1 && subgrid_x < grid_size - subgrid_size &&
-            subgrid_y >= 1 && subgrid_y < grid_size - subgrid_size) {
-          // Load phasor
-          std::complex<float> phasor = {phasor_real[y][x], phasor_imag[y][x]};
-
-          // Set grid value to subgrid
-          for (int pol = 0; pol < nr_polarizations; pol++) {
-            int pol_src = index_pol[pol];
-            long src_idx = index_grid_4d(nr_polarizations, grid_size, w_layer,
-                                         pol_src, y_src, x_src);
-            long dst_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
-                                         y_dst, x_dst);
-            std::complex<float> value = grid[src_idx];
-            value = negative_w ? conj(value) : value;
-            subgrid[dst_idx] = phasor * value;
-          }  // end for pol
-        }    // end if fit
-      }      // end for x
-    }        // end for y
-  }          // end for s
+        // Load phasor
+        int idx = y * subgrid_size + x;
+        std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
+
+        // Set grid value to subgrid
+        for (int pol = 0; pol < nr_polarizations; pol++) {
+          int pol_src = index_pol[pol];
+          long src_idx = index_grid_4d(nr_polarizations, grid_size, w_layer,
+                                       pol_src, y_src, x_src);
+          long dst_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
+                                       y_dst, x_dst);
+          std::complex<float> value = grid[src_idx];
+          value = negative_w ? conj(value) : value;
+          subgrid[dst_idx] = phasor * value;
+        }  // end for pol
+      }    // end for x
+    }      // end for y
+  };
+
+  if (get_adder_strategy() == AdderStrategy::kBinned) {
+    // Bin the subgrids by the first row of the w-layers that they read
+    std::vector<long> rows(nr_subgrids);
+    for (int s = 0; s < nr_subgrids; s++) {
+      int subgrid_y = metadata[s].coordinate.y;
+      int subgrid_w = metadata[s].coordinate.z;
+      bool negative_w = subgrid_w < 0;
+      int w_layer = negative_w ? -subgrid_w - 1 : subgrid_w;
+      int row = negative_w ? grid_size - subgrid_y - subgrid_size + 1
+                           : subgrid_y;
+      rows[s] = fits(s) ? w_layer * grid_size + row : -1;
+    }
+    const SubgridBins bins(rows, subgrid_size);
+
+    // Every subgrid is processed once, as part of the bin of its first row
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < bins.get_nr_bins(); b++) {
+      for (const int* s = bins.begin(b); s != bins.end(b); s++) {
+        if (rows[*s] >= bins.get_rows(b).begin) {
+          split_subgrid(*s);
+        }
+      }
+    }
+  } else {
+#pragma omp parallel for
+    for (int s = 0; s < nr_subgrids; s++) {
+      if (fits(s)) {
+        split_subgrid(s);
+      }
+    }
+  }
 }  // end kernel_splitter_wstack
 
 }  // end namespace optimized
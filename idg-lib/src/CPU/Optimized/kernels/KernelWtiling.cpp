@@ -4,7 +4,7 @@
 #include <complex>
 #include <algorithm>
 #include <vector>
-#include <map>
+#include <limits>
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -17,6 +17,8 @@
 #include "common/Types.h"
 #include "common/Index.h"
 #include "common/WTiles.h"
+#include "fft/FFTPlanCache.h"
+#include "Binning.h"
 #include "Math.h"
 
 namespace idg {
@@ -222,59 +224,88 @@ void kernel_adder_subgrids_to_wtiles(
 
   compute_sincos(nr_pixels, phase, phasor_imag, phasor_real);
 
-#pragma omp parallel
-  {
-    int num_threads = omp_get_num_threads();
-    int thread_id = omp_get_thread_num();
+  // Compute the position of subgrid s in its tile
+  const int padded_tile_size = wtile_size + subgrid_size;
+  auto load_coordinate = [&](int s, int& tile_index, int& subgrid_x,
+                             int& subgrid_y) {
+    tile_index = metadata[s].wtile_index;
+    int tile_top = metadata[s].wtile_coordinate.x * wtile_size -
+                   subgrid_size / 2 + grid_size / 2;
+    int tile_left = metadata[s].wtile_coordinate.y * wtile_size -
+                    subgrid_size / 2 + grid_size / 2;
+
+    // position in tile
+    subgrid_x = metadata[s].coordinate.x - tile_top;
+    subgrid_y = metadata[s].coordinate.y - tile_left;
+  };
+
+  // Add the rows of subgrid s that are part of the row set to the tiles, rows
+  // are numbered tile_index * (wtile_size + subgrid_size) + y
+  auto add_subgrid = [&](int s, const RowSet& rows) {
+    int tile_index, subgrid_x, subgrid_y;
+    load_coordinate(s, tile_index, subgrid_x, subgrid_y);
+
+    // Iterate over the subgrid rows in the row set
+    int y_begin, y_end;
+    clip_rows(rows, long(tile_index) * padded_tile_size + subgrid_y,
+              subgrid_size, &y_begin, &y_end);
+    for (int y = y_begin; y < y_end; y += rows.step) {
+      // Iterate all columns of subgrid
+      for (int x = 0; x < subgrid_size; x++) {
+        // Compute position in subgrid
+        int x_src = (x + (subgrid_size / 2)) % subgrid_size;
+        int y_src = (y + (subgrid_size / 2)) % subgrid_size;
+
+        // Compute position in grid
+        int x_dst = subgrid_x + x;
+        int y_dst = subgrid_y + y;
+
+        // Load phasor
+        int idx = y * subgrid_size + x;
+        std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
+
+        // Add subgrid value to tiles
+        for (int pol = 0; pol < nr_polarizations; pol++) {
+          long dst_idx = index_grid_4d(nr_polarizations, padded_tile_size,
+                                       tile_index, pol, y_dst, x_dst);
+          long src_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
+                                       y_src, x_src);
+
+          std::complex<float> value = phasor * subgrid[src_idx];
+          tiles[dst_idx] += value;
+
+        }  // end for pol
+      }    // end for x
+    }      // end for y
+  };
+
+  if (get_adder_strategy() == AdderStrategy::kBinned) {
+    // Bin the subgrids by the rows of the tiles that they overlap
+    std::vector<long> rows(nr_subgrids);
     for (int s = 0; s < nr_subgrids; s++) {
-      // Load subgrid coordinates
-
-      int tile_index = metadata[s].wtile_index;
-      int tile_top = metadata[s].wtile_coordinate.x * wtile_size -
-                     subgrid_size / 2 + grid_size / 2;
-      int tile_left = metadata[s].wtile_coordinate.y * wtile_size -
-                      subgrid_size / 2 + grid_size / 2;
-
-      // position in tile
-      int subgrid_x = metadata[s].coordinate.x - tile_top;
-      int subgrid_y = metadata[s].coordinate.y - tile_left;
-
-      // iterate over subgrid rows, starting at a row that belongs to this
-      // thread and stepping by the number of threads
-
-      int start_y =
-          (num_threads - (subgrid_y % num_threads) + thread_id) % num_threads;
-      for (int y = start_y; y < subgrid_size; y += num_threads) {
-        // Iterate all columns of subgrid
-        for (int x = 0; x < subgrid_size; x++) {
-          // Compute position in subgrid
-          int x_src = (x + (subgrid_size / 2)) % subgrid_size;
-          int y_src = (y + (subgrid_size / 2)) % subgrid_size;
-
-          // Compute position in grid
-          int x_dst = subgrid_x + x;
-          int y_dst = subgrid_y + y;
-
-          // Load phasor
-          int idx = y * subgrid_size + x;
-          std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
-
-          // Add subgrid value to tiles
-          for (int pol = 0; pol < nr_polarizations; pol++) {
-            long dst_idx =
-                index_grid_4d(nr_polarizations, wtile_size + subgrid_size,
-                              tile_index, pol, y_dst, x_dst);
-            long src_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
-                                         y_src, x_src);
-
-            std::complex<float> value = phasor * subgrid[src_idx];
-            tiles[dst_idx] += value;
+      int tile_index, subgrid_x, subgrid_y;
+      load_coordinate(s, tile_index, subgrid_x, subgrid_y);
+      rows[s] = long(tile_index) * padded_tile_size + subgrid_y;
+    }
+    const SubgridBins bins(rows, subgrid_size);
 
-          }  // end for pol
-        }    // end for x
-      }      // end for y
-    }        // end for s
-  }          // end parallel
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < bins.get_nr_bins(); b++) {
+      for (const int* s = bins.begin(b); s != bins.end(b); s++) {
+        add_subgrid(*s, bins.get_rows(b));
+      }
+    }
+  } else {
+#pragma omp parallel
+    {
+      const RowSet rows = {omp_get_thread_num(),
+                           std::numeric_limits<long>::max(),
+                           omp_get_num_threads()};
+      for (int s = 0; s < nr_subgrids; s++) {
+        add_subgrid(s, rows);
+      }
+    }
+  }
 
   free(phase);
   free(phasor_real);
@@ -294,10 +325,6 @@ void kernel_adder_wtiles_to_grid(
       tile_coordinates, nr_tiles, w_step, image_size, image_size_shift,
       padded_tile_size);
 
-  // FFT plans
-  typedef std::pair<fftwf_plan, fftwf_plan> fft_pair;
-  std::map<size_t, fft_pair> fft_plans;
-
   // Iterate tiles in batches
   size_t current_nr_tiles = omp_get_max_threads();
   for (size_t tile_offset = 0; tile_offset < static_cast<size_t>(nr_tiles);
@@ -315,18 +342,12 @@ void kernel_adder_wtiles_to_grid(
          w_padded_tile_size, w_padded_tile_size},
         std::complex<float>(0.0f, 0.0f));
 
-    // Initialize FFT plans
-    if (fft_plans.find(w_padded_tile_size) == fft_plans.end()) {
-      fftwf_plan plan_forward = fftwf_plan_dft_1d(
-          w_padded_tile_size, nullptr, nullptr, FFTW_FORWARD, FFTW_ESTIMATE);
-      fftwf_plan plan_backward = fftwf_plan_dft_1d(
-          w_padded_tile_size, nullptr, nullptr, FFTW_BACKWARD, FFTW_ESTIMATE);
-      fft_plans.insert({w_padded_tile_size, {plan_forward, plan_backward}});
-    }
-
-    fft_pair plan_pair = fft_plans.find(w_padded_tile_size)->second;
-    fftwf_plan plan_forward = plan_pair.first;
-    fftwf_plan plan_backward = plan_pair.second;
+    // Get FFT plans, the rows and columns of the tiles are not aligned
+    FFTPlanCache& plan_cache = FFTPlanCache::get_instance();
+    fftwf_plan plan_forward =
+        plan_cache.get_plan_dft_1d(w_padded_tile_size, FFTW_FORWARD, false);
+    fftwf_plan plan_backward =
+        plan_cache.get_plan_dft_1d(w_padded_tile_size, FFTW_BACKWARD, false);
 
     // Process the current batch of tiles
 #pragma omp parallel for
@@ -366,12 +387,6 @@ void kernel_adder_wtiles_to_grid(
         current_nr_tiles, wtile_size, w_padded_tile_size, nr_polarizations,
         grid_size, &tile_coordinates[tile_offset], tile_buffers.data(), grid);
   }  // end for tile_offset
-
-  // Free FFT plans
-  for (auto& entry : fft_plans) {
-    fftwf_destroy_plan(entry.second.first);
-    fftwf_destroy_plan(entry.second.second);
-  }
 }  // end kernel_adder_wtiles_to_grid
 
 void kernel_splitter_subgrids_from_wtiles(
@@ -394,58 +409,87 @@ void kernel_splitter_subgrids_from_wtiles(
 
   compute_sincos(nr_pixels, phase, phasor_imag, phasor_real);
 
-#pragma omp parallel
-  {
-    int num_threads = omp_get_num_threads();
-    int thread_id = omp_get_thread_num();
+  // Compute the position of subgrid s in its tile
+  const int padded_tile_size = wtile_size + subgrid_size;
+  auto load_coordinate = [&](int s, int& tile_index, int& subgrid_x,
+                             int& subgrid_y) {
+    tile_index = metadata[s].wtile_index;
+    int tile_top = metadata[s].wtile_coordinate.x * wtile_size -
+                   subgrid_size / 2 + grid_size / 2;
+    int tile_left = metadata[s].wtile_coordinate.y * wtile_size -
+                    subgrid_size / 2 + grid_size / 2;
+
+    // position in tile
+    subgrid_x = metadata[s].coordinate.x - tile_top;
+    subgrid_y = metadata[s].coordinate.y - tile_left;
+  };
+
+  // Split the rows of subgrid s that are part of the row set from the tiles,
+  // rows are numbered tile_index * (wtile_size + subgrid_size) + y
+  auto split_subgrid = [&](int s, const RowSet& rows) {
+    int tile_index, subgrid_x, subgrid_y;
+    load_coordinate(s, tile_index, subgrid_x, subgrid_y);
+
+    // Iterate over the subgrid rows in the row set
+    int y_begin, y_end;
+    clip_rows(rows, long(tile_index) * padded_tile_size + subgrid_y,
+              subgrid_size, &y_begin, &y_end);
+    for (int y = y_begin; y < y_end; y += rows.step) {
+      // Iterate all columns of subgrid
+      for (int x = 0; x < subgrid_size; x++) {
+        // Compute position in subgrid
+        int x_src = (x + (subgrid_size / 2)) % subgrid_size;
+        int y_src = (y + (subgrid_size / 2)) % subgrid_size;
+
+        // Compute position in grid
+        int x_dst = subgrid_x + x;
+        int y_dst = subgrid_y + y;
+
+        // Load phasor
+        int idx = y * subgrid_size + x;
+        std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
+
+        // Split subgrid from tile
+        for (int pol = 0; pol < nr_polarizations; pol++) {
+          long src_idx = index_grid_4d(nr_polarizations, padded_tile_size,
+                                       tile_index, pol, y_dst, x_dst);
+          long dst_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
+                                       y_src, x_src);
+
+          subgrid[dst_idx] = phasor * tiles[src_idx];
+
+        }  // end for pol
+      }    // end for x
+    }      // end for y
+  };
+
+  if (get_adder_strategy() == AdderStrategy::kBinned) {
+    // Bin the subgrids by the rows of the tiles that they overlap
+    std::vector<long> rows(nr_subgrids);
     for (int s = 0; s < nr_subgrids; s++) {
-      // Load subgrid coordinates
-
-      int tile_index = metadata[s].wtile_index;
-      int tile_top = metadata[s].wtile_coordinate.x * wtile_size -
-                     subgrid_size / 2 + grid_size / 2;
-      int tile_left = metadata[s].wtile_coordinate.y * wtile_size -
-                      subgrid_size / 2 + grid_size / 2;
-
-      // position in tile
-      int subgrid_x = metadata[s].coordinate.x - tile_top;
-      int subgrid_y = metadata[s].coordinate.y - tile_left;
-
-      // iterate over subgrid rows, starting at a row that belongs to this
-      // thread and stepping by the number of threads
-
-      int start_y =
-          (num_threads - (subgrid_y % num_threads) + thread_id) % num_threads;
-      for (int y = start_y; y < subgrid_size; y += num_threads) {
-        // Iterate all columns of subgrid
-        for (int x = 0; x < subgrid_size; x++) {
-          // Compute position in subgrid
-          int x_src = (x + (subgrid_size / 2)) % subgrid_size;
-          int y_src = (y + (subgrid_size / 2)) % subgrid_size;
-
-          // Compute position in grid
-          int x_dst = subgrid_x + x;
-          int y_dst = subgrid_y + y;
-
-          // Load phasor
-          int idx = y * subgrid_size + x;
-          std::complex<float> phasor = {phasor_real[idx], phasor_imag[idx]};
-
-          // Split subgrid from tile
-          for (int pol = 0; pol < nr_polarizations; pol++) {
-            long src_idx =
-                index_grid_4d(nr_polarizations, wtile_size + subgrid_size,
-                              tile_index, pol, y_dst, x_dst);
-            long dst_idx = index_subgrid(nr_polarizations, subgrid_size, s, pol,
-                                         y_src, x_src);
-
-            subgrid[dst_idx] = phasor * tiles[src_idx];
+      int tile_index, subgrid_x, subgrid_y;
+      load_coordinate(s, tile_index, subgrid_x, subgrid_y);
+      rows[s] = long(tile_index) * padded_tile_size + subgrid_y;
+    }
+    const SubgridBins bins(rows, subgrid_size);
 
-          }  // end for pol
-        }    // end for x
-      }      // end for y
-    }        // end for s
-  }          // end parallel
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < bins.get_nr_bins(); b++) {
+      for (const int* s = bins.begin(b); s != bins.end(b); s++) {
+        split_subgrid(*s, bins.get_rows(b));
+      }
+    }
+  } else {
+#pragma omp parallel
+    {
+      const RowSet rows = {omp_get_thread_num(),
+                           std::numeric_limits<long>::max(),
+                           omp_get_num_threads()};
+      for (int s = 0; s < nr_subgrids; s++) {
+        split_subgrid(s, rows);
+      }
+    }
+  }
 
   free(phase);
   free(phasor_real);
@@ -465,10 +509,6 @@ void kernel_splitter_wtiles_from_grid(
       tile_coordinates, nr_tiles, w_step, image_size, image_size_shift,
       padded_tile_size);
 
-  // FFT plans
-  typedef std::pair<fftwf_plan, fftwf_plan> fft_pair;
-  std::map<size_t, fft_pair> fft_plans;
-
   // Iterate tiles in batches
   size_t current_nr_tiles = omp_get_max_threads();
   for (size_t tile_offset = 0; tile_offset < static_cast<size_t>(nr_tiles);
@@ -486,18 +526,12 @@ void kernel_splitter_wtiles_from_grid(
          w_padded_tile_size, w_padded_tile_size},
         std::complex<float>(0.0f, 0.0f));
 
-    // Initialize FFT plans
-    if (fft_plans.find(w_padded_tile_size) == fft_plans.end()) {
-      fftwf_plan plan_forward = fftwf_plan_dft_1d(
-          w_padded_tile_size, nullptr, nullptr, FFTW_FORWARD, FFTW_ESTIMATE);
-      fftwf_plan plan_backward = fftwf_plan_dft_1d(
-          w_padded_tile_size, nullptr, nullptr, FFTW_BACKWARD, FFTW_ESTIMATE);
-      fft_plans.insert({w_padded_tile_size, {plan_forward, plan_backward}});
-    }
-
-    fft_pair plan_pair = fft_plans.find(w_padded_tile_size)->second;
-    fftwf_plan plan_forward = plan_pair.first;
-    fftwf_plan plan_backward = plan_pair.second;
+    // Get FFT plans, the rows and columns of the tiles are not aligned
+    FFTPlanCache& plan_cache = FFTPlanCache::get_instance();
+    fftwf_plan plan_forward =
+        plan_cache.get_plan_dft_1d(w_padded_tile_size, FFTW_FORWARD, false);
+    fftwf_plan plan_backward =
+        plan_cache.get_plan_dft_1d(w_padded_tile_size, FFTW_BACKWARD, false);
 
     // Split tile from grid
     kernel_tiles_from_grid(
@@ -530,12 +564,6 @@ void kernel_splitter_wtiles_from_grid(
                        tile_ptr, &tiles[dst_idx]);
     }  // end for current_nr_tiles
   }    // end for tile_offset
-
-  // Free FFT plans
-  for (auto& entry : fft_plans) {
-    fftwf_destroy_plan(entry.second.first);
-    fftwf_destroy_plan(entry.second.second);
-  }
 }  // end kernel_splitter_wtiles_from_grid
 
 }  // end namespace optimized
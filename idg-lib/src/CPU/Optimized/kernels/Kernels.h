@@ -5,19 +5,36 @@
 
 #include <fftw3.h>
 
+#include "Specialization.h"
+
 namespace idg {
 namespace kernel {
 namespace cpu {
 namespace optimized {
 
+/*
+ * Main
+ *
+ * Template arguments of zero select the generic kernel, see Specialization.h
+ */
+template <int kSubgridSize, int kNrCorrelations>
 void kernel_gridder(KERNEL_GRIDDER_ARGUMENTS);
 
+template <int kSubgridSize, int kNrCorrelations>
 void kernel_degridder(KERNEL_DEGRIDDER_ARGUMENTS);
 
 void kernel_fft(KERNEL_FFT_ARGUMENTS);
 
+// With shift, computes fftshift(fft(ifftshift(data))): the shifts are replaced
+// by a checkerboard modulation of the rows before and of the columns after
+// their 1D FFTs. This requires an even size.
+void kernel_fft_grid(long size, long batch, std::complex<float>* data,
+                     int sign, bool shift = false);
+
+template <int kSubgridSize, int kNrPolarizations>
 void kernel_adder(KERNEL_ADDER_ARGUMENTS);
 
+template <int kSubgridSize, int kNrPolarizations>
 void kernel_splitter(KERNEL_SPLITTER_ARGUMENTS);
 
 /*
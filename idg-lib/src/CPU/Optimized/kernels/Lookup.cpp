@@ -3,6 +3,10 @@
 
 #include "Lookup.h"
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #if defined(__PPC__)
 #include "powerveclib/powerveclib.h"
 #endif
@@ -17,8 +21,11 @@ void initialize_lookup() {
   }
 }
 
-#if defined(__AVX__) && not defined(__AVX2__)
-__m256i _mm256_and_si256(__m256i a, __m256i b) {
+#if defined(__x86_64__)
+namespace {
+
+// AVX lacks integer and gather instructions, emulate these using SSE
+IDG_TARGET_AVX __m256i mm256_and_si256(__m256i a, __m256i b) {
   __m128i ah = _mm256_extractf128_si256(a, 0);
   __m128i al = _mm256_extractf128_si256(a, 1);
   __m128i bh = _mm256_extractf128_si256(b, 0);
@@ -26,13 +33,13 @@ __m256i _mm256_and_si256(__m256i a, __m256i b) {
   __m128i ch = _mm_and_si128(ah, bh);
   __m128i cl = _mm_and_si128(al, bl);
 #if __GNUC__ > 7 || defined(__INTEL_COMPILER)
-  return _mm256_set_m128i(ch, cl);
+  return _mm256_set_m128i(cl, ch);
 #else
   return _mm256_insertf128_si256(_mm256_castsi128_si256(ch), cl, 1);
 #endif
 }
 
-__m256i _mm256_add_epi32(__m256i a, __m256i b) {
+IDG_TARGET_AVX __m256i mm256_add_epi32(__m256i a, __m256i b) {
   __m128i ah = _mm256_extractf128_si256(a, 0);
   __m128i al = _mm256_extractf128_si256(a, 1);
   __m128i bh = _mm256_extractf128_si256(b, 0);
@@ -40,29 +47,59 @@ __m256i _mm256_add_epi32(__m256i a, __m256i b) {
   __m128i ch = _mm_add_epi32(ah, bh);
   __m128i cl = _mm_add_epi32(al, bl);
 #if __GNUC__ > 7 || defined(__INTEL_COMPILER)
-  return _mm256_set_m128i(ch, cl);
+  return _mm256_set_m128i(cl, ch);
 #else
   return _mm256_insertf128_si256(_mm256_castsi128_si256(ch), cl, 1);
 #endif
 }
-#endif
 
-#if defined(__AVX__)
-__m256 _mm256_gather_ps(float const* base_addr, __m256i vindex) {
-  float dst[8];
-  int idx[8];
+IDG_TARGET_AVX __m256 mm256_gather_ps(float const* base_addr, __m256i vindex) {
+  float dst[8] __attribute__((aligned(32)));
+  int idx[8] __attribute__((aligned(32)));
   _mm256_store_si256((__m256i*)idx, vindex);
   for (unsigned i = 0; i < 8; i++) {
     dst[i] = base_addr[idx[i]];
   }
   return _mm256_load_ps(dst);
 }
+
+}  // namespace
 #endif
 
-void compute_sincos_avx(unsigned* offset, const unsigned n,
-                        const float* __restrict__ x, float* __restrict__ sin,
-                        float* __restrict__ cos) {
-#if defined(__AVX__)
+IDG_TARGET_AVX512 void compute_sincos_avx512(unsigned* offset, const unsigned n,
+                                              const float* __restrict__ x,
+                                              float* __restrict__ sin,
+                                              float* __restrict__ cos) {
+#if defined(__x86_64__)
+  const unsigned vector_length = 16;
+
+  for (unsigned i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m512 f0 = _mm512_load_ps(&x[i]);                // input
+    __m512 f1 = _mm512_set1_ps(TWO_PI_INT / TWO_PI);  // compute scale
+    __m512 f2 = _mm512_mul_ps(f0, f1);                // apply scale
+    __m512i u0 = _mm512_set1_epi32(HLF_PI_INT);       // constant 0.5 * pi
+    __m512i u1 = _mm512_set1_epi32(TWO_PI_INT - 1);   // mask 2 * pi
+    __m512i u2 = _mm512_cvtps_epi32(f2);              // round float to int
+    __m512i u3 = _mm512_add_epi32(u2, u0);            // add 0.5 * pi
+    __m512i u4 =
+        _mm512_and_si512(u1, u3);  // apply mask of 2 * pi, second index
+    __m512i u5 = _mm512_and_si512(u1, u2);  // apply mask of 2 * pi, first index
+    __m512 f3 = _mm512_i32gather_ps(u4, lookup, 4);  // perform lookup of real
+    __m512 f4 = _mm512_i32gather_ps(u5, lookup, 4);  // perform lookup of imag
+    _mm512_store_ps(&cos[i], f3);                    // store output
+    _mm512_store_ps(&sin[i], f4);                    // store output
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}
+
+IDG_TARGET_AVX2 void compute_sincos_avx2(unsigned* offset, const unsigned n,
+                                         const float* __restrict__ x,
+                                         float* __restrict__ sin,
+                                         float* __restrict__ cos) {
+#if defined(__x86_64__)
   const unsigned vector_length = 8;
 
   for (unsigned i = *offset; i < (n / vector_length) * vector_length;
@@ -77,15 +114,38 @@ void compute_sincos_avx(unsigned* offset, const unsigned n,
     __m256i u4 =
         _mm256_and_si256(u1, u3);  // apply mask of 2 * pi, second index
     __m256i u5 = _mm256_and_si256(u1, u2);  // apply mask of 2 * pi, first index
-#if defined(__AVX2__)
     __m256 f3 = _mm256_i32gather_ps(lookup, u4, 4);  // perform lookup of real
     __m256 f4 = _mm256_i32gather_ps(lookup, u5, 4);  // perform lookup of imag
-#else
-    __m256 f3 = _mm256_gather_ps(lookup, u4);  // perform lookup of real
-    __m256 f4 = _mm256_gather_ps(lookup, u5);  // perform lookup of imag
+    _mm256_store_ps(&cos[i], f3);                    // store output
+    _mm256_store_ps(&sin[i], f4);                    // store output
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
 #endif
-    _mm256_store_ps(&cos[i], f3);  // store output
-    _mm256_store_ps(&sin[i], f4);  // store output
+}
+
+IDG_TARGET_AVX void compute_sincos_avx(unsigned* offset, const unsigned n,
+                                       const float* __restrict__ x,
+                                       float* __restrict__ sin,
+                                       float* __restrict__ cos) {
+#if defined(__x86_64__)
+  const unsigned vector_length = 8;
+
+  for (unsigned i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m256 f0 = _mm256_load_ps(&x[i]);                // input
+    __m256 f1 = _mm256_set1_ps(TWO_PI_INT / TWO_PI);  // compute scale
+    __m256 f2 = _mm256_mul_ps(f0, f1);                // apply scale
+    __m256i u0 = _mm256_set1_epi32(HLF_PI_INT);       // constant 0.5 * pi
+    __m256i u1 = _mm256_set1_epi32(TWO_PI_INT - 1);   // mask 2 * pi
+    __m256i u2 = _mm256_cvtps_epi32(f2);              // round float to int
+    __m256i u3 = mm256_add_epi32(u2, u0);             // add 0.5 * pi
+    __m256i u4 = mm256_and_si256(u1, u3);  // apply mask of 2 * pi, second index
+    __m256i u5 = mm256_and_si256(u1, u2);  // apply mask of 2 * pi, first index
+    __m256 f3 = mm256_gather_ps(lookup, u4);  // perform lookup of real
+    __m256 f4 = mm256_gather_ps(lookup, u5);  // perform lookup of imag
+    _mm256_store_ps(&cos[i], f3);             // store output
+    _mm256_store_ps(&sin[i], f4);             // store output
   }
 
   *offset += vector_length * ((n - *offset) / vector_length);
@@ -132,9 +192,19 @@ void compute_sincos_scalar(unsigned* offset, const unsigned n,
 
 void compute_sincos(const unsigned n, const float* __restrict__ x,
                     float* __restrict__ sin, float* __restrict__ cos) {
+  using idg::kernel::cpu::optimized::IsaLevel;
+  const IsaLevel isa_level = idg::kernel::cpu::optimized::get_isa_level();
   unsigned offset = 0;
 
   compute_sincos_altivec(&offset, n, x, sin, cos);
-  compute_sincos_avx(&offset, n, x, sin, cos);
+  if (isa_level >= IsaLevel::kAvx512) {
+    compute_sincos_avx512(&offset, n, x, sin, cos);
+  }
+  if (isa_level >= IsaLevel::kAvx2) {
+    compute_sincos_avx2(&offset, n, x, sin, cos);
+  }
+  if (isa_level >= IsaLevel::kAvx) {
+    compute_sincos_avx(&offset, n, x, sin, cos);
+  }
   compute_sincos_scalar(&offset, n, x, sin, cos);
 }
\ No newline at end of file
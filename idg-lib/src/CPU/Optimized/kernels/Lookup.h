@@ -3,9 +3,7 @@
 
 #include "math.h"
 
-#if defined(__x86_64__)
-#include <immintrin.h>
-#endif
+#include "Isa.h"
 
 // Floating-point PI values
 #define PI float(M_PI)
@@ -22,18 +20,20 @@
 
 void initialize_lookup();
 
-#if defined(__AVX__) && not defined(__AVX2__)
-__m256i _mm256_and_si256(__m256i a, __m256i b);
-__m256i _mm256_add_epi32(__m256i a, __m256i b);
-#endif
+IDG_TARGET_AVX512 void compute_sincos_avx512(unsigned* offset, const unsigned n,
+                                              const float* __restrict__ x,
+                                              float* __restrict__ sin,
+                                              float* __restrict__ cos);
 
-#if defined(__AVX__)
-__m256 _mm256_gather_ps(float const* base_addr, __m256i vindex);
-#endif
+IDG_TARGET_AVX2 void compute_sincos_avx2(unsigned* offset, const unsigned n,
+                                         const float* __restrict__ x,
+                                         float* __restrict__ sin,
+                                         float* __restrict__ cos);
 
-void compute_sincos_avx(unsigned* offset, const unsigned n,
-                        const float* __restrict__ x, float* __restrict__ sin,
-                        float* __restrict__ cos);
+IDG_TARGET_AVX void compute_sincos_avx(unsigned* offset, const unsigned n,
+                                       const float* __restrict__ x,
+                                       float* __restrict__ sin,
+                                       float* __restrict__ cos);
 
 void compute_sincos_altivec(unsigned* offset, const unsigned n,
                             const float* __restrict__ x,
@@ -3,6 +3,8 @@
 
 #include "common/Math.h"
 
+#include "Isa.h"
+
 #if defined(USE_LOOKUP)
 #include "Lookup.h"
 #elif defined(USE_VML)
@@ -13,16 +15,31 @@ inline void compute_sincos(const int n, const float* x, float* sin,
   vmsSinCos(n, x, sin, cos, VML_PRECISION);
 }
 #else
+#include "Sincos.h"
 inline void compute_sincos(const int n, const float* x, float* sin,
                            float* cos) {
-  for (int i = 0; i < n; i++) {
-    sin[i] = sinf(x[i]);
-  }
-  for (int i = 0; i < n; i++) {
-    cos[i] = cosf(x[i]);
-  }
+  idg::kernel::cpu::optimized::compute_sincos_polynomial(n, x, sin, cos);
 }
 #endif
 
 #include "Reduction.h"
-#include "Extrapolation.h"
\ No newline at end of file
+#include "Extrapolation.h"
+
+/*
+ * Stokes I only gridding and degridding apply a scalar beam per pixel: half
+ * the trace of A1^H * A2 (gridder) or A1 * A2^H (degridder). This is exact
+ * when the beam is the same for both polarizations, e.g. for scalar beams.
+ */
+inline std::complex<float> compute_stokes_i_aterm_gridder(
+    const std::complex<float>* aterm1, const std::complex<float>* aterm2) {
+  std::complex<float> sum = 0;
+  for (int i = 0; i < 4; i++) {
+    sum += std::conj(aterm1[i]) * aterm2[i];
+  }
+  return 0.5f * sum;
+}
+
+inline std::complex<float> compute_stokes_i_aterm_degridder(
+    const std::complex<float>* aterm1, const std::complex<float>* aterm2) {
+  return std::conj(compute_stokes_i_aterm_gridder(aterm1, aterm2));
+}
@@ -9,8 +9,8 @@
 #include <altivec.h>
 #endif
 
-#if defined(__AVX__)
-inline float _mm256_horizontal_add(__m256 x) {
+#if defined(__x86_64__)
+IDG_TARGET_AVX inline float _mm256_horizontal_add(__m256 x) {
   /* x0, x1, x2, x3, x4, x5, x6, x7 */
   __m256 x1 = x;
 
@@ -34,8 +34,8 @@ inline float _mm256_horizontal_add(__m256 x) {
 #endif
 
 // https://bit.ly/2UqZqAp
-#if defined(__AVX512F__)
-inline float _mm512_horizontal_add(__m512 x) {
+#if defined(__x86_64__)
+IDG_TARGET_AVX512 inline float _mm512_horizontal_add(__m512 x) {
   /* x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15 */
   __m512 x1 = x;
 
@@ -123,14 +123,14 @@ inline void compute_reduction_scalar(
   output[3] += std::complex<float>(output_yy_real, output_yy_imag);
 }  // end compute_reduction_scalar
 
-inline void compute_reduction_avx_fma(
+IDG_TARGET_AVX2 inline void compute_reduction_avx_fma(
     int* offset, const int n, const float* input_xx_real,
     const float* input_xy_real, const float* input_yx_real,
     const float* input_yy_real, const float* input_xx_imag,
     const float* input_xy_imag, const float* input_yx_imag,
     const float* input_yy_imag, const float* phasor_real,
     const float* phasor_imag, std::complex<float> output[4]) {
-#if defined(__FMA__)
+#if defined(__x86_64__)
   const int vector_length = 8;
 
   __m256 output_xx_r = _mm256_setzero_ps();
@@ -287,14 +287,14 @@ inline void compute_reduction_altivec(
 #endif
 }  // end compute_reduction_altivec
 
-inline void compute_reduction_avx(
+IDG_TARGET_AVX inline void compute_reduction_avx(
     int* offset, const int n, const float* input_xx_real,
     const float* input_xy_real, const float* input_yx_real,
     const float* input_yy_real, const float* input_xx_imag,
     const float* input_xy_imag, const float* input_yx_imag,
     const float* input_yy_imag, const float* phasor_real,
     const float* phasor_imag, std::complex<float> output[4]) {
-#if defined(__AVX__)
+#if defined(__x86_64__)
   const int vector_length = 8;
 
   __m256 output_xx_r = _mm256_setzero_ps();
@@ -363,14 +363,14 @@ inline void compute_reduction_avx(
 #endif
 }  // end compute_reduction_avx
 
-inline void compute_reduction_avx512(
+IDG_TARGET_AVX512 inline void compute_reduction_avx512(
     int* offset, const int n, const float* input_xx_real,
     const float* input_xy_real, const float* input_yx_real,
     const float* input_yy_real, const float* input_xx_imag,
     const float* input_xy_imag, const float* input_yx_imag,
     const float* input_yy_imag, const float* phasor_real,
     const float* phasor_imag, std::complex<float> output[4]) {
-#if defined(__AVX512F__)
+#if defined(__x86_64__)
   const int vector_length = 16;
 
   __m512 output_xx_r = _mm512_setzero_ps();
@@ -446,6 +446,8 @@ inline void compute_reduction(
     const float* input_yx_imag, const float* input_yy_imag,
     const float* phasor_real, const float* phasor_imag,
     std::complex<float> output[4]) {
+  using idg::kernel::cpu::optimized::IsaLevel;
+  const IsaLevel isa_level = idg::kernel::cpu::optimized::get_isa_level();
   int offset = 0;
 
   // Initialize output to zero
@@ -458,22 +460,28 @@ inline void compute_reduction(
                             phasor_real, phasor_imag, output);
 
   // Vectorized loop, 16-elements, AVX512
-  compute_reduction_avx512(&offset, n, input_xx_real, input_xy_real,
-                           input_yx_real, input_yy_real, input_xx_imag,
-                           input_xy_imag, input_yx_imag, input_yy_imag,
-                           phasor_real, phasor_imag, output);
+  if (isa_level >= IsaLevel::kAvx512) {
+    compute_reduction_avx512(&offset, n, input_xx_real, input_xy_real,
+                             input_yx_real, input_yy_real, input_xx_imag,
+                             input_xy_imag, input_yx_imag, input_yy_imag,
+                             phasor_real, phasor_imag, output);
+  }
 
   // Vectorized loop, 8-elements, AVX FMA
-  compute_reduction_avx_fma(&offset, n, input_xx_real, input_xy_real,
-                            input_yx_real, input_yy_real, input_xx_imag,
-                            input_xy_imag, input_yx_imag, input_yy_imag,
-                            phasor_real, phasor_imag, output);
+  if (isa_level >= IsaLevel::kAvx2) {
+    compute_reduction_avx_fma(&offset, n, input_xx_real, input_xy_real,
+                              input_yx_real, input_yy_real, input_xx_imag,
+                              input_xy_imag, input_yx_imag, input_yy_imag,
+                              phasor_real, phasor_imag, output);
+  }
 
   // Vectorized loop, 8-elements, AVX
-  compute_reduction_avx(&offset, n, input_xx_real, input_xy_real, input_yx_real,
-                        input_yy_real, input_xx_imag, input_xy_imag,
-                        input_yx_imag, input_yy_imag, phasor_real, phasor_imag,
-                        output);
+  if (isa_level >= IsaLevel::kAvx) {
+    compute_reduction_avx(&offset, n, input_xx_real, input_xy_real,
+                          input_yx_real, input_yy_real, input_xx_imag,
+                          input_xy_imag, input_yx_imag, input_yy_imag,
+                          phasor_real, phasor_imag, output);
+  }
 
   // Remainder loop, scalar
   compute_reduction_scalar(&offset, n, input_xx_real, input_xy_real,
@@ -518,6 +526,168 @@ inline void compute_reduction_scalar(
   output[1] += std::complex<float>(output_yy_real, output_yy_imag);
 }  // end compute_reduction_scalar
 
+IDG_TARGET_AVX512 inline void compute_reduction_avx512(
+    int* offset, const int n, const float* input_xx_real,
+    const float* input_yy_real, const float* input_xx_imag,
+    const float* input_yy_imag, const float* phasor_real,
+    const float* phasor_imag, std::complex<float> output[2]) {
+#if defined(__x86_64__)
+  const int vector_length = 16;
+
+  __m512 output_xx_r = _mm512_setzero_ps();
+  __m512 output_yy_r = _mm512_setzero_ps();
+  __m512 output_xx_i = _mm512_setzero_ps();
+  __m512 output_yy_i = _mm512_setzero_ps();
+
+  for (int i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m512 input_xx, input_yy;
+    __m512 phasor_r, phasor_i;
+
+    phasor_r = _mm512_load_ps(&phasor_real[i]);
+    phasor_i = _mm512_load_ps(&phasor_imag[i]);
+
+    // Load real part of input
+    input_xx = _mm512_load_ps(&input_xx_real[i]);
+    input_yy = _mm512_load_ps(&input_yy_real[i]);
+
+    // Update output
+    output_xx_r = _mm512_fmadd_ps(input_xx, phasor_r, output_xx_r);
+    output_xx_i = _mm512_fmadd_ps(input_xx, phasor_i, output_xx_i);
+    output_yy_r = _mm512_fmadd_ps(input_yy, phasor_r, output_yy_r);
+    output_yy_i = _mm512_fmadd_ps(input_yy, phasor_i, output_yy_i);
+
+    // Load imag part of input
+    input_xx = _mm512_load_ps(&input_xx_imag[i]);
+    input_yy = _mm512_load_ps(&input_yy_imag[i]);
+
+    // Update output
+    output_xx_r = _mm512_fnmadd_ps(input_xx, phasor_i, output_xx_r);
+    output_xx_i = _mm512_fmadd_ps(input_xx, phasor_r, output_xx_i);
+    output_yy_r = _mm512_fnmadd_ps(input_yy, phasor_i, output_yy_r);
+    output_yy_i = _mm512_fmadd_ps(input_yy, phasor_r, output_yy_i);
+  }
+
+  // Reduce all vectors
+  if (n - *offset > 0) {
+    output[0] += std::complex<float>(_mm512_horizontal_add(output_xx_r),
+                                     _mm512_horizontal_add(output_xx_i));
+    output[1] += std::complex<float>(_mm512_horizontal_add(output_yy_r),
+                                     _mm512_horizontal_add(output_yy_i));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}  // end compute_reduction_avx512
+
+IDG_TARGET_AVX2 inline void compute_reduction_avx_fma(
+    int* offset, const int n, const float* input_xx_real,
+    const float* input_yy_real, const float* input_xx_imag,
+    const float* input_yy_imag, const float* phasor_real,
+    const float* phasor_imag, std::complex<float> output[2]) {
+#if defined(__x86_64__)
+  const int vector_length = 8;
+
+  __m256 output_xx_r = _mm256_setzero_ps();
+  __m256 output_yy_r = _mm256_setzero_ps();
+  __m256 output_xx_i = _mm256_setzero_ps();
+  __m256 output_yy_i = _mm256_setzero_ps();
+
+  for (int i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m256 input_xx, input_yy;
+    __m256 phasor_r, phasor_i;
+
+    phasor_r = _mm256_load_ps(&phasor_real[i]);
+    phasor_i = _mm256_load_ps(&phasor_imag[i]);
+
+    // Load real part of input
+    input_xx = _mm256_load_ps(&input_xx_real[i]);
+    input_yy = _mm256_load_ps(&input_yy_real[i]);
+
+    // Update output
+    output_xx_r = _mm256_fmadd_ps(input_xx, phasor_r, output_xx_r);
+    output_xx_i = _mm256_fmadd_ps(input_xx, phasor_i, output_xx_i);
+    output_yy_r = _mm256_fmadd_ps(input_yy, phasor_r, output_yy_r);
+    output_yy_i = _mm256_fmadd_ps(input_yy, phasor_i, output_yy_i);
+
+    // Load imag part of input
+    input_xx = _mm256_load_ps(&input_xx_imag[i]);
+    input_yy = _mm256_load_ps(&input_yy_imag[i]);
+
+    // Update output
+    output_xx_r = _mm256_fnmadd_ps(input_xx, phasor_i, output_xx_r);
+    output_xx_i = _mm256_fmadd_ps(input_xx, phasor_r, output_xx_i);
+    output_yy_r = _mm256_fnmadd_ps(input_yy, phasor_i, output_yy_r);
+    output_yy_i = _mm256_fmadd_ps(input_yy, phasor_r, output_yy_i);
+  }
+
+  // Reduce all vectors
+  if (n - *offset > 0) {
+    output[0] += std::complex<float>(_mm256_horizontal_add(output_xx_r),
+                                     _mm256_horizontal_add(output_xx_i));
+    output[1] += std::complex<float>(_mm256_horizontal_add(output_yy_r),
+                                     _mm256_horizontal_add(output_yy_i));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}  // end compute_reduction_avx_fma
+
+IDG_TARGET_AVX inline void compute_reduction_avx(
+    int* offset, const int n, const float* input_xx_real,
+    const float* input_yy_real, const float* input_xx_imag,
+    const float* input_yy_imag, const float* phasor_real,
+    const float* phasor_imag, std::complex<float> output[2]) {
+#if defined(__x86_64__)
+  const int vector_length = 8;
+
+  __m256 output_xx_r = _mm256_setzero_ps();
+  __m256 output_yy_r = _mm256_setzero_ps();
+  __m256 output_xx_i = _mm256_setzero_ps();
+  __m256 output_yy_i = _mm256_setzero_ps();
+
+  for (int i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m256 input_xx, input_yy;
+    __m256 phasor_r, phasor_i;
+
+    phasor_r = _mm256_load_ps(&phasor_real[i]);
+    phasor_i = _mm256_load_ps(&phasor_imag[i]);
+
+    // Load real part of input
+    input_xx = _mm256_load_ps(&input_xx_real[i]);
+    input_yy = _mm256_load_ps(&input_yy_real[i]);
+
+    // Update output
+    output_xx_r = _mm256_add_ps(output_xx_r, _mm256_mul_ps(input_xx, phasor_r));
+    output_xx_i = _mm256_add_ps(output_xx_i, _mm256_mul_ps(input_xx, phasor_i));
+    output_yy_r = _mm256_add_ps(output_yy_r, _mm256_mul_ps(input_yy, phasor_r));
+    output_yy_i = _mm256_add_ps(output_yy_i, _mm256_mul_ps(input_yy, phasor_i));
+
+    // Load imag part of input
+    input_xx = _mm256_load_ps(&input_xx_imag[i]);
+    input_yy = _mm256_load_ps(&input_yy_imag[i]);
+
+    // Update output
+    output_xx_r = _mm256_sub_ps(output_xx_r, _mm256_mul_ps(input_xx, phasor_i));
+    output_xx_i = _mm256_add_ps(output_xx_i, _mm256_mul_ps(input_xx, phasor_r));
+    output_yy_r = _mm256_sub_ps(output_yy_r, _mm256_mul_ps(input_yy, phasor_i));
+    output_yy_i = _mm256_add_ps(output_yy_i, _mm256_mul_ps(input_yy, phasor_r));
+  }
+
+  // Reduce all vectors
+  if (n - *offset > 0) {
+    output[0] += std::complex<float>(_mm256_horizontal_add(output_xx_r),
+                                     _mm256_horizontal_add(output_xx_i));
+    output[1] += std::complex<float>(_mm256_horizontal_add(output_yy_r),
+                                     _mm256_horizontal_add(output_yy_i));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}  // end compute_reduction_avx
+
 inline void compute_reduction(const int n, const float* input_xx_real,
                               const float* input_yy_real,
                               const float* input_xx_imag,
@@ -525,13 +695,219 @@ inline void compute_reduction(const int n, const float* input_xx_real,
                               const float* phasor_real,
                               const float* phasor_imag,
                               std::complex<float> output[2]) {
+  using idg::kernel::cpu::optimized::IsaLevel;
+  const IsaLevel isa_level = idg::kernel::cpu::optimized::get_isa_level();
   int offset = 0;
 
   // Initialize output to zero
   memset(static_cast<void*>(output), 0, 2 * sizeof(std::complex<float>));
 
+  // Vectorized loop, 16-elements, AVX512
+  if (isa_level >= IsaLevel::kAvx512) {
+    compute_reduction_avx512(&offset, n, input_xx_real, input_yy_real,
+                             input_xx_imag, input_yy_imag, phasor_real,
+                             phasor_imag, output);
+  }
+
+  // Vectorized loop, 8-elements, AVX FMA
+  if (isa_level >= IsaLevel::kAvx2) {
+    compute_reduction_avx_fma(&offset, n, input_xx_real, input_yy_real,
+                              input_xx_imag, input_yy_imag, phasor_real,
+                              phasor_imag, output);
+  }
+
+  // Vectorized loop, 8-elements, AVX
+  if (isa_level >= IsaLevel::kAvx) {
+    compute_reduction_avx(&offset, n, input_xx_real, input_yy_real,
+                          input_xx_imag, input_yy_imag, phasor_real,
+                          phasor_imag, output);
+  }
+
   // Remainder loop, scalar
   compute_reduction_scalar(&offset, n, input_xx_real, input_yy_real,
                            input_xx_imag, input_yy_imag, phasor_real,
                            phasor_imag, output);
 }
+
+inline void compute_reduction_scalar(int* offset, const int n,
+                                     const float* input_real,
+                                     const float* input_imag,
+                                     const float* phasor_real,
+                                     const float* phasor_imag,
+                                     std::complex<float> output[1]) {
+  float output_real = 0.0f;
+  float output_imag = 0.0f;
+
+#if defined(__INTEL_COMPILER)
+#pragma omp simd reduction(+:output_real,output_imag)
+#endif
+  for (int i = *offset; i < n; i++) {
+    float phasor_real_ = phasor_real[i];
+    float phasor_imag_ = phasor_imag[i];
+
+    output_real += input_real[i] * phasor_real_;
+    output_imag += input_real[i] * phasor_imag_;
+    output_real -= input_imag[i] * phasor_imag_;
+    output_imag += input_imag[i] * phasor_real_;
+  }
+
+  *offset = n;
+
+  // Update output
+  output[0] += std::complex<float>(output_real, output_imag);
+}  // end compute_reduction_scalar
+
+IDG_TARGET_AVX512 inline void compute_reduction_avx512(
+    int* offset, const int n, const float* input_real,
+    const float* input_imag, const float* phasor_real,
+    const float* phasor_imag, std::complex<float> output[1]) {
+#if defined(__x86_64__)
+  const int vector_length = 16;
+
+  // The real and imaginary parts of the input are accumulated separately, such
+  // that there are four independent chains of additions
+  __m512 output_r_r = _mm512_setzero_ps();
+  __m512 output_r_i = _mm512_setzero_ps();
+  __m512 output_i_r = _mm512_setzero_ps();
+  __m512 output_i_i = _mm512_setzero_ps();
+
+  for (int i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m512 phasor_r = _mm512_load_ps(&phasor_real[i]);
+    __m512 phasor_i = _mm512_load_ps(&phasor_imag[i]);
+    __m512 input_r = _mm512_load_ps(&input_real[i]);
+    __m512 input_i = _mm512_load_ps(&input_imag[i]);
+
+    // Update output
+    output_r_r = _mm512_fmadd_ps(input_r, phasor_r, output_r_r);
+    output_r_i = _mm512_fmadd_ps(input_r, phasor_i, output_r_i);
+    output_i_r = _mm512_fnmadd_ps(input_i, phasor_i, output_i_r);
+    output_i_i = _mm512_fmadd_ps(input_i, phasor_r, output_i_i);
+  }
+
+  // Reduce all vectors
+  if (n - *offset > 0) {
+    const __m512 output_r = _mm512_add_ps(output_r_r, output_i_r);
+    const __m512 output_i = _mm512_add_ps(output_r_i, output_i_i);
+    output[0] += std::complex<float>(_mm512_horizontal_add(output_r),
+                                     _mm512_horizontal_add(output_i));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}  // end compute_reduction_avx512
+
+IDG_TARGET_AVX2 inline void compute_reduction_avx_fma(
+    int* offset, const int n, const float* input_real,
+    const float* input_imag, const float* phasor_real,
+    const float* phasor_imag, std::complex<float> output[1]) {
+#if defined(__x86_64__)
+  const int vector_length = 8;
+
+  // The real and imaginary parts of the input are accumulated separately, such
+  // that there are four independent chains of additions
+  __m256 output_r_r = _mm256_setzero_ps();
+  __m256 output_r_i = _mm256_setzero_ps();
+  __m256 output_i_r = _mm256_setzero_ps();
+  __m256 output_i_i = _mm256_setzero_ps();
+
+  for (int i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m256 phasor_r = _mm256_load_ps(&phasor_real[i]);
+    __m256 phasor_i = _mm256_load_ps(&phasor_imag[i]);
+    __m256 input_r = _mm256_load_ps(&input_real[i]);
+    __m256 input_i = _mm256_load_ps(&input_imag[i]);
+
+    // Update output
+    output_r_r = _mm256_fmadd_ps(input_r, phasor_r, output_r_r);
+    output_r_i = _mm256_fmadd_ps(input_r, phasor_i, output_r_i);
+    output_i_r = _mm256_fnmadd_ps(input_i, phasor_i, output_i_r);
+    output_i_i = _mm256_fmadd_ps(input_i, phasor_r, output_i_i);
+  }
+
+  // Reduce all vectors
+  if (n - *offset > 0) {
+    const __m256 output_r = _mm256_add_ps(output_r_r, output_i_r);
+    const __m256 output_i = _mm256_add_ps(output_r_i, output_i_i);
+    output[0] += std::complex<float>(_mm256_horizontal_add(output_r),
+                                     _mm256_horizontal_add(output_i));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}  // end compute_reduction_avx_fma
+
+IDG_TARGET_AVX inline void compute_reduction_avx(
+    int* offset, const int n, const float* input_real,
+    const float* input_imag, const float* phasor_real,
+    const float* phasor_imag, std::complex<float> output[1]) {
+#if defined(__x86_64__)
+  const int vector_length = 8;
+
+  // The real and imaginary parts of the input are accumulated separately, such
+  // that there are four independent chains of additions
+  __m256 output_r_r = _mm256_setzero_ps();
+  __m256 output_r_i = _mm256_setzero_ps();
+  __m256 output_i_r = _mm256_setzero_ps();
+  __m256 output_i_i = _mm256_setzero_ps();
+
+  for (int i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    __m256 phasor_r = _mm256_load_ps(&phasor_real[i]);
+    __m256 phasor_i = _mm256_load_ps(&phasor_imag[i]);
+    __m256 input_r = _mm256_load_ps(&input_real[i]);
+    __m256 input_i = _mm256_load_ps(&input_imag[i]);
+
+    // Update output
+    output_r_r = _mm256_add_ps(output_r_r, _mm256_mul_ps(input_r, phasor_r));
+    output_r_i = _mm256_add_ps(output_r_i, _mm256_mul_ps(input_r, phasor_i));
+    output_i_r = _mm256_sub_ps(output_i_r, _mm256_mul_ps(input_i, phasor_i));
+    output_i_i = _mm256_add_ps(output_i_i, _mm256_mul_ps(input_i, phasor_r));
+  }
+
+  // Reduce all vectors
+  if (n - *offset > 0) {
+    const __m256 output_r = _mm256_add_ps(output_r_r, output_i_r);
+    const __m256 output_i = _mm256_add_ps(output_r_i, output_i_i);
+    output[0] += std::complex<float>(_mm256_horizontal_add(output_r),
+                                     _mm256_horizontal_add(output_i));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}  // end compute_reduction_avx
+
+inline void compute_reduction(const int n, const float* input_real,
+                              const float* input_imag,
+                              const float* phasor_real,
+                              const float* phasor_imag,
+                              std::complex<float> output[1]) {
+  using idg::kernel::cpu::optimized::IsaLevel;
+  const IsaLevel isa_level = idg::kernel::cpu::optimized::get_isa_level();
+  int offset = 0;
+
+  // Initialize output to zero
+  output[0] = 0;
+
+  // Vectorized loop, 16-elements, AVX512
+  if (isa_level >= IsaLevel::kAvx512) {
+    compute_reduction_avx512(&offset, n, input_real, input_imag, phasor_real,
+                             phasor_imag, output);
+  }
+
+  // Vectorized loop, 8-elements, AVX FMA
+  if (isa_level >= IsaLevel::kAvx2) {
+    compute_reduction_avx_fma(&offset, n, input_real, input_imag, phasor_real,
+                              phasor_imag, output);
+  }
+
+  // Vectorized loop, 8-elements, AVX
+  if (isa_level >= IsaLevel::kAvx) {
+    compute_reduction_avx(&offset, n, input_real, input_imag, phasor_real,
+                          phasor_imag, output);
+  }
+
+  // Remainder loop, scalar
+  compute_reduction_scalar(&offset, n, input_real, input_imag, phasor_real,
+                           phasor_imag, output);
+}
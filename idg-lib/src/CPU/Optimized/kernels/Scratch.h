@@ -0,0 +1,60 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_OPTIMIZED_SCRATCH_H_
+#define IDG_OPTIMIZED_SCRATCH_H_
+
+#include <cassert>
+#include <cstdlib>
+
+#include "common/memory.h"
+
+/*
+ * Scratch memory for use by a single thread. The arena only grows: reserve()
+ * reallocates when a larger size is requested and otherwise just rewinds, such
+ * that buffers handed out by allocate() are reused without touching the heap.
+ */
+class ScratchArena {
+ public:
+  ScratchArena() = default;
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+
+  ~ScratchArena() { free(data_); }
+
+  // Make sure that at least bytes are available and rewind the arena
+  void reserve(size_t bytes) {
+    if (bytes > capacity_) {
+      free(data_);
+      data_ = allocate_memory<char>(bytes);
+      capacity_ = bytes;
+    }
+    offset_ = 0;
+  }
+
+  // Hand out an aligned buffer for n elements of type T
+  template <class T>
+  T* allocate(size_t n) {
+    const size_t bytes = sizeof_buffer<T>(n);
+    assert(offset_ + bytes <= capacity_);
+    T* ptr = reinterpret_cast<T*>(data_ + offset_);
+    offset_ += bytes;
+    return ptr;
+  }
+
+  // Release all buffers at once, the memory is kept for the next use
+  void reset() { offset_ = 0; }
+
+  // Number of bytes used in the arena by a buffer of n elements of type T
+  template <class T>
+  static size_t sizeof_buffer(size_t n) {
+    return ((n * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  }
+
+ private:
+  char* data_ = nullptr;
+  size_t capacity_ = 0;
+  size_t offset_ = 0;
+};
+
+#endif
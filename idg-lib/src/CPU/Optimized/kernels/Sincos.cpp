@@ -0,0 +1,254 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Sincos.h"
+
+#include <cmath>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "Isa.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+namespace {
+
+SincosAccuracy sincos_accuracy = SincosAccuracy::kFull;
+
+constexpr float kTwoOverPi = 0.636619772367581343f;
+
+/*
+ * Coefficients per accuracy level. After range reduction to r in [-pi/4, pi/4],
+ * sin(r) = r * P(r^2) and cos(r) = Q(r^2), with the coefficients of P (kSin)
+ * and Q (kCos) in increasing order. The value of pi/2 is split in parts
+ * (kPio2), the leading parts have few enough significant bits to make the
+ * subtraction of k * pi/2 exact.
+ */
+template <SincosAccuracy kAccuracy>
+struct Coefficients;
+
+template <>
+struct Coefficients<SincosAccuracy::kFull> {
+  static constexpr int kNrPio2 = 3;
+  static constexpr float kPio2[kNrPio2] = {1.5703125f, 4.837512969970703125e-4f,
+                                           7.54978995489188216e-8f};
+  static constexpr int kNrSin = 4;
+  static constexpr float kSin[kNrSin] = {1.0f, -1.6666654611e-1f,
+                                         8.3321608736e-3f, -1.9515295891e-4f};
+  static constexpr int kNrCos = 5;
+  static constexpr float kCos[kNrCos] = {
+      1.0f, -0.5f, 4.166664568298827e-2f, -1.388731625493765e-3f,
+      2.443315711809948e-5f};
+};
+
+template <>
+struct Coefficients<SincosAccuracy::kImaging> {
+  static constexpr int kNrPio2 = 2;
+  static constexpr float kPio2[kNrPio2] = {1.5703125f, 4.8382679489e-4f};
+  static constexpr int kNrSin = 2;
+  static constexpr float kSin[kNrSin] = {9.9903142291e-1f, -1.6034401672e-1f};
+  static constexpr int kNrCos = 3;
+  static constexpr float kCos[kNrCos] = {9.9999003496e-1f, -4.9970814036e-1f,
+                                         4.0398535969e-2f};
+};
+
+/*
+ * The quadrant k of the phase determines how sin(r) and cos(r) are combined:
+ *  k = 0: sin(x) =  sin(r), cos(x) =  cos(r)
+ *  k = 1: sin(x) =  cos(r), cos(x) = -sin(r)
+ *  k = 2: sin(x) = -sin(r), cos(x) = -cos(r)
+ *  k = 3: sin(x) = -cos(r), cos(x) =  sin(r)
+ */
+template <SincosAccuracy kAccuracy>
+void compute_sincos_scalar(unsigned* offset, const unsigned n,
+                           const float* __restrict__ x,
+                           float* __restrict__ sin, float* __restrict__ cos) {
+  using C = Coefficients<kAccuracy>;
+
+  for (unsigned i = *offset; i < n; i++) {
+    // Range reduction
+    const float k = std::nearbyint(x[i] * kTwoOverPi);
+    float r = x[i];
+    for (int j = 0; j < C::kNrPio2; j++) {
+      r -= k * C::kPio2[j];
+    }
+    const float z = r * r;
+
+    // Polynomials
+    float p = C::kSin[C::kNrSin - 1];
+    for (int j = C::kNrSin - 2; j >= 0; j--) {
+      p = p * z + C::kSin[j];
+    }
+    p *= r;
+    float q = C::kCos[C::kNrCos - 1];
+    for (int j = C::kNrCos - 2; j >= 0; j--) {
+      q = q * z + C::kCos[j];
+    }
+
+    // Select and negate depending on the quadrant
+    const int quadrant = static_cast<int>(k);
+    const float sin_r = (quadrant & 1) ? q : p;
+    const float cos_r = (quadrant & 1) ? p : q;
+    sin[i] = (quadrant & 2) ? -sin_r : sin_r;
+    cos[i] = ((quadrant + 1) & 2) ? -cos_r : cos_r;
+  }
+
+  *offset = n;
+}
+
+template <SincosAccuracy kAccuracy>
+IDG_TARGET_AVX2 void compute_sincos_avx2(unsigned* offset, const unsigned n,
+                                         const float* __restrict__ x,
+                                         float* __restrict__ sin,
+                                         float* __restrict__ cos) {
+#if defined(__x86_64__)
+  using C = Coefficients<kAccuracy>;
+  const unsigned vector_length = 8;
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i two = _mm256_set1_epi32(2);
+
+  for (unsigned i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    // Range reduction
+    const __m256 x_ = _mm256_loadu_ps(&x[i]);
+    const __m256 k =
+        _mm256_round_ps(_mm256_mul_ps(x_, _mm256_set1_ps(kTwoOverPi)),
+                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = x_;
+    for (int j = 0; j < C::kNrPio2; j++) {
+      r = _mm256_fnmadd_ps(k, _mm256_set1_ps(C::kPio2[j]), r);
+    }
+    const __m256 z = _mm256_mul_ps(r, r);
+
+    // Polynomials
+    __m256 p = _mm256_set1_ps(C::kSin[C::kNrSin - 1]);
+    for (int j = C::kNrSin - 2; j >= 0; j--) {
+      p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(C::kSin[j]));
+    }
+    p = _mm256_mul_ps(p, r);
+    __m256 q = _mm256_set1_ps(C::kCos[C::kNrCos - 1]);
+    for (int j = C::kNrCos - 2; j >= 0; j--) {
+      q = _mm256_fmadd_ps(q, z, _mm256_set1_ps(C::kCos[j]));
+    }
+
+    // Select and negate depending on the quadrant
+    const __m256i quadrant = _mm256_cvtps_epi32(k);
+    const __m256 swap = _mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+    const __m256 sin_sign = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+    const __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+    _mm256_storeu_ps(&sin[i],
+                     _mm256_xor_ps(_mm256_blendv_ps(p, q, swap), sin_sign));
+    _mm256_storeu_ps(&cos[i],
+                     _mm256_xor_ps(_mm256_blendv_ps(q, p, swap), cos_sign));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}
+
+template <SincosAccuracy kAccuracy>
+IDG_TARGET_AVX512 void compute_sincos_avx512(unsigned* offset,
+                                             const unsigned n,
+                                             const float* __restrict__ x,
+                                             float* __restrict__ sin,
+                                             float* __restrict__ cos) {
+#if defined(__x86_64__)
+  using C = Coefficients<kAccuracy>;
+  const unsigned vector_length = 16;
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i two = _mm512_set1_epi32(2);
+
+  for (unsigned i = *offset; i < (n / vector_length) * vector_length;
+       i += vector_length) {
+    // Range reduction
+    const __m512 x_ = _mm512_loadu_ps(&x[i]);
+    const __m512 k =
+        _mm512_roundscale_ps(_mm512_mul_ps(x_, _mm512_set1_ps(kTwoOverPi)),
+                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = x_;
+    for (int j = 0; j < C::kNrPio2; j++) {
+      r = _mm512_fnmadd_ps(k, _mm512_set1_ps(C::kPio2[j]), r);
+    }
+    const __m512 z = _mm512_mul_ps(r, r);
+
+    // Polynomials
+    __m512 p = _mm512_set1_ps(C::kSin[C::kNrSin - 1]);
+    for (int j = C::kNrSin - 2; j >= 0; j--) {
+      p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(C::kSin[j]));
+    }
+    p = _mm512_mul_ps(p, r);
+    __m512 q = _mm512_set1_ps(C::kCos[C::kNrCos - 1]);
+    for (int j = C::kNrCos - 2; j >= 0; j--) {
+      q = _mm512_fmadd_ps(q, z, _mm512_set1_ps(C::kCos[j]));
+    }
+
+    // Select and negate depending on the quadrant
+    const __m512i quadrant = _mm512_cvtps_epi32(k);
+    const __mmask16 swap = _mm512_test_epi32_mask(quadrant, one);
+    const __m512i sin_sign =
+        _mm512_slli_epi32(_mm512_and_si512(quadrant, two), 30);
+    const __m512i cos_sign = _mm512_slli_epi32(
+        _mm512_and_si512(_mm512_add_epi32(quadrant, one), two), 30);
+    const __m512 sin_r = _mm512_mask_blend_ps(swap, p, q);
+    const __m512 cos_r = _mm512_mask_blend_ps(swap, q, p);
+    _mm512_storeu_ps(&sin[i], _mm512_castsi512_ps(_mm512_xor_si512(
+                                  _mm512_castps_si512(sin_r), sin_sign)));
+    _mm512_storeu_ps(&cos[i], _mm512_castsi512_ps(_mm512_xor_si512(
+                                  _mm512_castps_si512(cos_r), cos_sign)));
+  }
+
+  *offset += vector_length * ((n - *offset) / vector_length);
+#endif
+}
+
+template <SincosAccuracy kAccuracy>
+void compute_sincos_polynomial(const unsigned n, const float* __restrict__ x,
+                               float* __restrict__ sin,
+                               float* __restrict__ cos) {
+  const IsaLevel isa_level = get_isa_level();
+  unsigned offset = 0;
+
+  // Vectorized loop, 16-elements, AVX512
+  if (isa_level >= IsaLevel::kAvx512) {
+    compute_sincos_avx512<kAccuracy>(&offset, n, x, sin, cos);
+  }
+
+  // Vectorized loop, 8-elements, AVX2
+  if (isa_level >= IsaLevel::kAvx2) {
+    compute_sincos_avx2<kAccuracy>(&offset, n, x, sin, cos);
+  }
+
+  // Remainder loop, scalar
+  compute_sincos_scalar<kAccuracy>(&offset, n, x, sin, cos);
+}
+
+}  // namespace
+
+SincosAccuracy get_sincos_accuracy() { return sincos_accuracy; }
+
+void set_sincos_accuracy(SincosAccuracy accuracy) {
+  sincos_accuracy = accuracy;
+}
+
+void compute_sincos_polynomial(const unsigned n, const float* __restrict__ x,
+                               float* __restrict__ sin,
+                               float* __restrict__ cos) {
+  if (sincos_accuracy == SincosAccuracy::kImaging) {
+    compute_sincos_polynomial<SincosAccuracy::kImaging>(n, x, sin, cos);
+  } else {
+    compute_sincos_polynomial<SincosAccuracy::kFull>(n, x, sin, cos);
+  }
+}
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
@@ -0,0 +1,35 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_OPTIMIZED_SINCOS_H_
+#define IDG_OPTIMIZED_SINCOS_H_
+
+#include "../KernelOptions.h"
+
+namespace idg {
+namespace kernel {
+namespace cpu {
+namespace optimized {
+
+// Returns the accuracy used by the kernels, kFull by default
+SincosAccuracy get_sincos_accuracy();
+
+void set_sincos_accuracy(SincosAccuracy accuracy);
+
+/*
+ * Computes the sine and cosine of n phases. The phase is reduced to
+ * [-pi/4, pi/4] using a multi-part representation of pi/2, after which sin and
+ * cos are approximated with minimax polynomials. The reduction is accurate for
+ * |x| < 1e5, which covers the phases computed by the kernels. The
+ * implementation (AVX-512, AVX2 or scalar) is selected using get_isa_level().
+ */
+void compute_sincos_polynomial(const unsigned n, const float* __restrict__ x,
+                               float* __restrict__ sin,
+                               float* __restrict__ cos);
+
+}  // end namespace optimized
+}  // end namespace cpu
+}  // end namespace kernel
+}  // end namespace idg
+
+#endif
@@ -0,0 +1,19 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_OPTIMIZED_SPECIALIZATION_H_
+#define IDG_OPTIMIZED_SPECIALIZATION_H_
+
+/*
+ * The gridder, degridder, adder and splitter are templated on the subgrid size
+ * and on the number of correlations (gridder, degridder) or polarizations
+ * (adder, splitter). Besides the generic kernel, which has both template
+ * arguments set to zero and uses the runtime values instead, these kernels are
+ * instantiated for the subgrid sizes listed below. With the subgrid size known
+ * at compile-time, the compiler can fully unroll and vectorize the loops over
+ * pixels.
+ */
+#define IDG_FOR_EACH_SUBGRID_SIZE(F, n) \
+  F(24, n) F(32, n) F(40, n) F(48, n) F(64, n)
+
+#endif
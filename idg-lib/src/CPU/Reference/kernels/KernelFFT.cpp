@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include "common/Types.h"
+#include "fft/FFTPlanCache.h"
 
 namespace idg {
 namespace kernel {
@@ -19,33 +20,20 @@ void kernel_fft(long gridsize, long size, long batch, std::complex<float>* data,
 ) {
   fftwf_complex* data_ptr = reinterpret_cast<fftwf_complex*>(data);
 
-  // 2D FFT
-  int rank = 2;
-
-  // For grids of size*size elements
-  int n[] = {(int)size, (int)size};
-
-  // Set stride
-  int istride = 1;
-  int ostride = istride;
-
-  // Set dist
-  int idist = n[0] * n[1];
-  int odist = idist;
-
-  // Planner flags
-  int flags = FFTW_ESTIMATE;
-
-  // Create plan
-  fftwf_plan plan;
-#pragma omp critical
-  {
-    plan = fftwf_plan_many_dft(rank, n, batch, data_ptr, n, istride, idist,
-                               data_ptr, n, ostride, odist, sign, flags);
-  }
+  // Get a plan for a single 2D FFT of size*size elements from the cache,
+  // such that a plan is not created for every batch size. It can use aligned
+  // access when every grid in the batch is aligned.
+  const bool aligned =
+      FFTPlanCache::is_aligned(data) &&
+      (batch == 1 || FFTPlanCache::is_aligned(data + size * size));
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_2d(size, size, sign, aligned);
 
   // Execute FFTs
-  fftwf_execute_dft(plan, data_ptr, data_ptr);
+  for (long i = 0; i < batch; i++) {
+    fftwf_execute_dft(plan, data_ptr + i * size * size,
+                      data_ptr + i * size * size);
+  }
 
   // Scaling in case of an inverse FFT, so that FFT(iFFT())=identity()
   if (sign == FFTW_BACKWARD) {
@@ -66,10 +54,6 @@ void kernel_fft(long gridsize, long size, long batch, std::complex<float>* data,
       data_ptr[i][1] *= scale_imag;
     }
   }
-
-// Destroy plan
-#pragma omp critical
-  fftwf_destroy_plan(plan);
 }
 
 }  // end namespace reference
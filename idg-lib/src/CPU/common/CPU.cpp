@@ -6,6 +6,7 @@
 #include <climits>
 
 #include "fftw3.h"
+#include "fft/FFT.h"
 
 #include "CPU.h"
 
@@ -30,11 +31,14 @@ CPU::~CPU() {
   std::cout << "CPU::" << __func__ << std::endl;
 #endif
 
-  // Deallocate FFTWs internally allocated memory
-  fftwf_cleanup();
+  // FFTW is not cleaned up here, since fftwf_cleanup would invalidate the
+  // plans in the process-wide FFTPlanCache, which other proxies keep using
 }
 
 std::unique_ptr<auxiliary::Memory> CPU::allocate_memory(size_t bytes) {
+  if (has_memory_policy()) {
+    return Proxy::allocate_memory(bytes);
+  }
   return std::unique_ptr<auxiliary::Memory>(
       new auxiliary::AlignedMemory(bytes));
 }
@@ -46,8 +50,7 @@ std::unique_ptr<Plan> CPU::make_plan(
         baselines,
     const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
     Plan::Options options) {
-  if (supports_wtiling() && m_cache_state.w_step != 0.0 &&
-      m_wtiles.get_wtile_buffer_size()) {
+  if (WTiles* wtiles = get_plan_wtiles()) {
     options.w_step = m_cache_state.w_step;
     options.nr_w_layers = INT_MAX;
     const size_t grid_size = get_grid().shape(2);
@@ -55,7 +58,7 @@ std::unique_ptr<Plan> CPU::make_plan(
     return std::unique_ptr<Plan>(
         new Plan(kernel_size, m_cache_state.subgrid_size, grid_size,
                  m_cache_state.cell_size, m_cache_state.shift, frequencies, uvw,
-                 baselines, aterm_offsets, m_wtiles, options));
+                 baselines, aterm_offsets, *wtiles, options));
   } else {
     return Proxy::make_plan(kernel_size, frequencies, uvw, baselines,
                             aterm_offsets, options);
@@ -68,12 +71,31 @@ void CPU::init_cache(int subgrid_size, float cell_size, float w_step,
   const int nr_polarizations = get_grid().shape(1);
   const size_t grid_size = get_grid().shape(2);
   assert(get_grid().shape(3) == grid_size);
+  const int wtile_size =
+      m_wtile_size ? m_wtile_size : kernel::cpu::InstanceCPU::kDefaultWTileSize;
   const int nr_wtiles =
-      m_kernels->init_wtiles(nr_polarizations, grid_size, subgrid_size);
-  m_wtiles = WTiles(nr_wtiles, kernel::cpu::InstanceCPU::kWTileSize);
+      m_kernels->init_wtiles(nr_polarizations, grid_size, subgrid_size,
+                             wtile_size, m_wtile_buffer_bytes);
+  m_kernels->set_wtile_flush_queue_size(m_wtile_flush_queue_size);
+  m_kernels->set_wtile_prefetch_depth(m_wtile_prefetch_depth);
+  m_wtiles = WTiles(nr_wtiles, wtile_size);
+}
+
+void CPU::set_grid(aocommon::xt::Span<std::complex<float>, 4>& grid) {
+  // Flushes that are pending write to the current grid
+  m_kernels->synchronize_wtiles();
+  Proxy::set_grid(grid);
+}
+
+void CPU::free_grid() {
+  m_kernels->synchronize_wtiles();
+  Proxy::free_grid();
 }
 
 aocommon::xt::Span<std::complex<float>, 4>& CPU::get_final_grid() {
+  // wait for the Wtiles that are flushed in the background
+  m_kernels->synchronize_wtiles();
+
   // flush all pending Wtiles
   WTileUpdateInfo wtile_flush_info = m_wtiles.clear();
   if (wtile_flush_info.wtile_ids.size()) {
@@ -198,6 +220,7 @@ void CPU::do_gridding(
 
     // Performance measurement
     get_report()->initialize(nr_channels, subgrid_size, grid_size);
+    get_report()->update(Report::plan, plan.get_initialize_runtime());
     pmt::State states[2];
     states[0] = power_meter_->Read();
 
@@ -215,7 +238,9 @@ void CPU::do_gridding(
       const float* wavenumbers_ptr = wavenumbers.Span().data();
       auto* taper_ptr = taper.data();
       auto* aterm_ptr =
-          reinterpret_cast<const std::complex<float>*>(aterms.data());
+          aterms.size()
+              ? reinterpret_cast<const std::complex<float>*>(aterms.data())
+              : nullptr;
       const unsigned int* aterm_idx_ptr = plan.get_aterm_indices_ptr();
       auto* avg_aterm_ptr = m_avg_aterm_correction.size()
                                 ? m_avg_aterm_correction.data()
@@ -233,26 +258,36 @@ void CPU::do_gridding(
           nr_stations, uvw_ptr, wavenumbers_ptr, visibilities_ptr, taper_ptr,
           aterm_ptr, aterm_idx_ptr, avg_aterm_ptr, metadata_ptr, subgrids_ptr);
 
-      // FFT kernel
-      m_kernels->run_subgrid_fft(grid_size, subgrid_size,
-                                 current_nr_subgrids * nr_correlations,
-                                 subgrids_ptr, FFTW_BACKWARD);
-
-      // Adder kernel
-      if (plan.get_use_wtiles()) {
+      // FFT and adder kernels
+      if (m_kernels->do_supports_fused_fft()) {
         auto subgrid_offset = plan.get_subgrid_offset(bl);
-        m_kernels->run_adder_wtiles(current_nr_subgrids, nr_polarizations,
-                                    grid_size, subgrid_size, image_size, w_step,
-                                    shift_ptr, subgrid_offset, wtile_flush_set,
-                                    metadata_ptr, subgrids_ptr, grid_ptr);
-      } else if (w_step != 0.0) {
-        m_kernels->run_adder_wstack(current_nr_subgrids, nr_polarizations,
-                                    grid_size, subgrid_size, metadata_ptr,
-                                    subgrids_ptr, grid_ptr);
+        m_kernels->run_fft_adder(current_nr_subgrids, nr_polarizations,
+                                 grid_size, subgrid_size, image_size, w_step,
+                                 shift_ptr, plan.get_use_wtiles(),
+                                 subgrid_offset, wtile_flush_set, metadata_ptr,
+                                 subgrids_ptr, grid_ptr);
       } else {
-        m_kernels->run_adder(current_nr_subgrids, nr_polarizations, grid_size,
-                             subgrid_size, metadata_ptr, subgrids_ptr,
-                             grid_ptr);
+        // FFT kernel
+        m_kernels->run_subgrid_fft(grid_size, subgrid_size,
+                                   current_nr_subgrids * nr_correlations,
+                                   subgrids_ptr, FFTW_BACKWARD);
+
+        // Adder kernel
+        if (plan.get_use_wtiles()) {
+          auto subgrid_offset = plan.get_subgrid_offset(bl);
+          m_kernels->run_adder_wtiles(
+              current_nr_subgrids, nr_polarizations, grid_size, subgrid_size,
+              image_size, w_step, shift_ptr, subgrid_offset, wtile_flush_set,
+              metadata_ptr, subgrids_ptr, grid_ptr);
+        } else if (w_step != 0.0) {
+          m_kernels->run_adder_wstack(current_nr_subgrids, nr_polarizations,
+                                      grid_size, subgrid_size, metadata_ptr,
+                                      subgrids_ptr, grid_ptr);
+        } else {
+          m_kernels->run_adder(current_nr_subgrids, nr_polarizations,
+                               grid_size, subgrid_size, metadata_ptr,
+                               subgrids_ptr, grid_ptr);
+        }
       }
 
       // Performance reporting
@@ -301,6 +336,9 @@ void CPU::do_degridding(
 
   m_kernels->set_report(get_report());
 
+  // The splitter reads from the grid
+  m_kernels->synchronize_wtiles();
+
   Tensor<float, 1> wavenumbers = compute_wavenumbers(frequencies);
 
   // Arguments
@@ -333,6 +371,7 @@ void CPU::do_degridding(
 
     // Performance measurement
     get_report()->initialize(nr_channels, subgrid_size, grid_size);
+    get_report()->update(Report::plan, plan.get_initialize_runtime());
     pmt::State states[2];
     states[0] = power_meter_->Read();
 
@@ -350,7 +389,9 @@ void CPU::do_degridding(
       const float* wavenumbers_ptr = wavenumbers.Span().data();
       auto* taper_ptr = taper.data();
       auto* aterm_ptr =
-          reinterpret_cast<const std::complex<float>*>(aterms.data());
+          aterms.size()
+              ? reinterpret_cast<const std::complex<float>*>(aterms.data())
+              : nullptr;
       const unsigned int* aterm_idx_ptr = plan.get_aterm_indices_ptr();
       auto* metadata_ptr = plan.get_metadata_ptr(first_bl);
       const UVW<float>* uvw_ptr = uvw.data();
@@ -358,27 +399,37 @@ void CPU::do_degridding(
       std::complex<float>* subgrids_ptr = subgrids.Span().data();
       const std::complex<float>* grid_ptr = get_grid().data();
 
-      // Splitter kernel
-      if (plan.get_use_wtiles()) {
+      // Splitter and FFT kernels
+      if (m_kernels->do_supports_fused_fft()) {
         auto subgrid_offset = plan.get_subgrid_offset(bl);
-        m_kernels->run_splitter_wtiles(
-            current_nr_subgrids, nr_polarizations, grid_size, subgrid_size,
-            image_size, w_step, shift_ptr, subgrid_offset, wtile_initialize_set,
-            metadata_ptr, subgrids_ptr, grid_ptr);
-      } else if (w_step != 0.0) {
-        m_kernels->run_splitter_wstack(current_nr_subgrids, nr_polarizations,
-                                       grid_size, subgrid_size, metadata_ptr,
-                                       subgrids_ptr, grid_ptr);
+        m_kernels->run_splitter_fft(current_nr_subgrids, nr_polarizations,
+                                    grid_size, subgrid_size, image_size, w_step,
+                                    shift_ptr, plan.get_use_wtiles(),
+                                    subgrid_offset, wtile_initialize_set,
+                                    metadata_ptr, subgrids_ptr, grid_ptr);
       } else {
-        m_kernels->run_splitter(current_nr_subgrids, nr_polarizations,
-                                grid_size, subgrid_size, metadata_ptr,
-                                subgrids_ptr, grid_ptr);
-      }
+        // Splitter kernel
+        if (plan.get_use_wtiles()) {
+          auto subgrid_offset = plan.get_subgrid_offset(bl);
+          m_kernels->run_splitter_wtiles(
+              current_nr_subgrids, nr_polarizations, grid_size, subgrid_size,
+              image_size, w_step, shift_ptr, subgrid_offset,
+              wtile_initialize_set, metadata_ptr, subgrids_ptr, grid_ptr);
+        } else if (w_step != 0.0) {
+          m_kernels->run_splitter_wstack(current_nr_subgrids, nr_polarizations,
+                                         grid_size, subgrid_size, metadata_ptr,
+                                         subgrids_ptr, grid_ptr);
+        } else {
+          m_kernels->run_splitter(current_nr_subgrids, nr_polarizations,
+                                  grid_size, subgrid_size, metadata_ptr,
+                                  subgrids_ptr, grid_ptr);
+        }
 
-      // FFT kernel
-      m_kernels->run_subgrid_fft(grid_size, subgrid_size,
-                                 current_nr_subgrids * nr_correlations,
-                                 subgrids_ptr, FFTW_FORWARD);
+        // FFT kernel
+        m_kernels->run_subgrid_fft(grid_size, subgrid_size,
+                                   current_nr_subgrids * nr_correlations,
+                                   subgrids_ptr, FFTW_FORWARD);
+      }
 
       // Degridder kernel
       m_kernels->run_degridder(
@@ -425,6 +476,8 @@ void CPU::do_calibrate_init(
     Tensor<UVW<float>, 3>&& uvw,
     Tensor<std::pair<unsigned int, unsigned int>, 2>&& baselines,
     const aocommon::xt::Span<float, 2>& taper) {
+  m_kernels->synchronize_wtiles();
+
   // Arguments
   const size_t nr_antennas = plans.size();
   const size_t nr_polarizations = get_grid().shape(1);
@@ -688,10 +741,27 @@ void CPU::do_transform(DomainAtoDomainB direction) {
 
       pmt::State states[2];
       states[0] = power_meter_->Read();
-      m_kernels->fftshift_grid(grid_w);
-      m_kernels->run_fft(grid_size, grid_size, nr_correlations, grid_w.data(),
-                         sign);
-      m_kernels->fftshift_grid(grid_w);
+      if (is_grid_out_of_core() && grid_size % 2 == 0) {
+        // The grid is in a scratch file, transform it slab by slab. The
+        // scaling of the backward FFT matches that of the grid FFT kernels.
+        const std::complex<float> scale =
+            sign == FFTW_BACKWARD
+                ? std::complex<float>(2.0f / (grid_size * grid_size), 0)
+                : std::complex<float>(1.0f, 1.0f);
+        fft2f_out_of_core(nr_correlations, grid_size, grid_size,
+                          grid_w.data(), sign, true, scale,
+                          get_scratch_buffer_size());
+        get_report()->update(Report::grid_fft, states[0],
+                             power_meter_->Read());
+      } else if (m_kernels->do_supports_fft_shift() && grid_size % 2 == 0) {
+        m_kernels->run_fft_shift(grid_size, grid_size, nr_correlations,
+                                 grid_w.data(), sign);
+      } else {
+        m_kernels->fftshift_grid(grid_w);
+        m_kernels->run_fft(grid_size, grid_size, nr_correlations,
+                           grid_w.data(), sign);
+        m_kernels->fftshift_grid(grid_w);
+      }
       states[1] = power_meter_->Read();
       get_report()->update(Report::host, states[0], states[1]);
     }
@@ -34,6 +34,10 @@ class CPU : public Proxy {
     return m_kernels->do_supports_wtiling();
   }
 
+  virtual bool do_supports_identity_aterms() override {
+    return m_kernels->do_supports_identity_aterms();
+  }
+
   std::shared_ptr<kernel::cpu::InstanceCPU> get_kernels() { return m_kernels; }
 
   std::unique_ptr<Plan> make_plan(
@@ -44,9 +48,20 @@ class CPU : public Proxy {
       const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
       Plan::Options options) override;
 
+  WTiles* get_plan_wtiles() override {
+    return supports_wtiling() && m_cache_state.w_step != 0.0 &&
+                   m_wtiles.get_wtile_buffer_size()
+               ? &m_wtiles
+               : nullptr;
+  }
+
   void init_cache(int subgrid_size, float cell_size, float w_step,
                   const std::array<float, 2>& shift) override;
 
+  void set_grid(aocommon::xt::Span<std::complex<float>, 4>& grid) override;
+
+  void free_grid() override;
+
   aocommon::xt::Span<std::complex<float>, 4>& get_final_grid() override;
 
  private:
@@ -16,7 +16,8 @@ namespace idg::kernel::cpu {
 
 class InstanceCPU : public KernelsInstance {
  public:
-  static constexpr int kWTileSize = 128;
+  // Size of the w-tiles in pixels, unless specified otherwise in init_wtiles
+  static constexpr int kDefaultWTileSize = 128;
 
   // Constructor
   InstanceCPU();
@@ -50,10 +51,20 @@ class InstanceCPU : public KernelsInstance {
       const idg::Metadata *metadata, const std::complex<float>*subgrid
   virtual void run_degridder(KERNEL_DEGRIDDER_ARGUMENTS) = 0;
 
+  // Whether the gridder and degridder accept aterms == nullptr, which denotes
+  // identity aterms
+  virtual bool do_supports_identity_aterms() { return false; };
+
 #define KERNEL_FFT_ARGUMENTS \
   long grid_size, long size, long batch, std::complex<float>*data, int sign
   virtual void run_fft(KERNEL_FFT_ARGUMENTS) = 0;
 
+  // Whether run_fft_shift is supported, which computes
+  // fftshift(fft(ifftshift(data))) for grids of even size, without separate
+  // passes over the grid for the shifts
+  virtual bool do_supports_fft_shift() { return false; };
+  virtual void run_fft_shift(KERNEL_FFT_ARGUMENTS){};
+
 #define KERNEL_SUBGRID_FFT_ARGUMENTS \
   long grid_size, long size, long batch, std::complex<float>*data, int sign
   virtual void run_subgrid_fft(KERNEL_SUBGRID_FFT_ARGUMENTS) = 0;
@@ -153,21 +164,77 @@ class InstanceCPU : public KernelsInstance {
   /**
    * Creates the buffer to store the wtiles
    *
-   * The size of buffer in number of wtiles is determined by a heuristic based
-   * on grid_size and wtile size kWTileSize.
+   * The size of buffer in number of wtiles is derived from max_bytes, or when
+   * max_bytes is zero, determined by a heuristic based on grid_size and
+   * wtile_size.
    *
    * @param nr_polarizations number of polarizations in the grid
    * @param grid_size size of the grid
    * @param subgrid_size size of the subgrids
+   * @param wtile_size size of the wtiles
+   * @param max_bytes memory budget for the buffer in bytes, zero for no budget,
+   * throws std::invalid_argument when it does not hold four wtiles
    * @return The number of wtiles
    */
   virtual size_t init_wtiles(int nr_polarizations, size_t grid_size,
-                             int subgrid_size) {
+                             int subgrid_size, int wtile_size,
+                             size_t max_bytes) {
     return 0;
   };
 
+  int get_wtile_size() const { return wtile_size_; }
+
+  /**
+   * Let run_adder_wtiles (and run_fft_adder) add the flushed wtiles to the
+   * grid on a background thread, with at most max_nr_pending flushes in
+   * flight. Every pending flush keeps a copy of its wtiles. Zero adds the
+   * wtiles to the grid before run_adder_wtiles returns.
+   */
+  virtual void set_wtile_flush_queue_size(int max_nr_pending){};
+
+  /**
+   * Let run_splitter_wtiles (and run_splitter_fft) initialize the wtiles of
+   * the next depth initialize events on a background thread, while the
+   * subgrids before these events are processed. Zero disables prefetching.
+   */
+  virtual void set_wtile_prefetch_depth(int depth){};
+
+  // Wait until the wtiles flushed by run_adder_wtiles are added to the grid,
+  // and discard the prefetched wtiles. To be called before the grid changes.
+  virtual void synchronize_wtiles(){};
+
+  /*
+   * Fused subgrid FFT and adder/splitter
+   */
+  // Whether run_fft_adder and run_splitter_fft are supported. These kernels
+  // process the subgrids in blocks that fit in cache, such that the adder
+  // (splitter) accesses the subgrids directly after (before) their FFT.
+  virtual bool do_supports_fused_fft() { return false; };
+
+  // The subgrid FFT (backward) followed by the adder. Depending on use_wtiles
+  // and w_step, the subgrids are added to the w-tiles, to the w-layers or to
+  // the grid. The subgrids are transformed in place.
+#define KERNEL_FFT_ADDER_ARGUMENTS                                         \
+  int nr_subgrids, int nr_polarizations, int grid_size, int subgrid_size,  \
+      float image_size, float w_step, const float *shift, bool use_wtiles, \
+      int subgrid_offset, WTileUpdateSet &wtile_flush_set,                 \
+      const idg::Metadata *metadata, std::complex<float>*subgrid,          \
+      std::complex<float>*grid
+  virtual void run_fft_adder(KERNEL_FFT_ADDER_ARGUMENTS){};
+
+  // The splitter followed by the subgrid FFT (forward), the mirror of
+  // run_fft_adder
+#define KERNEL_SPLITTER_FFT_ARGUMENTS                                      \
+  int nr_subgrids, int nr_polarizations, int grid_size, int subgrid_size,  \
+      float image_size, float w_step, const float *shift, bool use_wtiles, \
+      int subgrid_offset, WTileUpdateSet &wtile_initialize_set,            \
+      const idg::Metadata *metadata, std::complex<float>*subgrid,          \
+      const std::complex<float>*grid
+  virtual void run_splitter_fft(KERNEL_SPLITTER_FFT_ARGUMENTS){};
+
  protected:
   xt::xtensor<std::complex<float>, 4> wtiles_buffer_;
+  int wtile_size_ = kDefaultWTileSize;
 };
 
 }  // end namespace idg::kernel::cpu
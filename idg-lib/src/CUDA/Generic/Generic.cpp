@@ -142,6 +142,10 @@ std::unique_ptr<Plan> Generic::make_plan(
         baselines,
     const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
     Plan::Options options) {
+  // The GPU kernels index the visibilities relative to the first baseline of
+  // a job, which requires the subgrids of every baseline to stay in place
+  options.subgrid_order = Plan::BASELINE_ORDER;
+
   if (do_supports_wtiling() && !m_disable_wtiling) {
     const size_t grid_size = get_grid().shape(2);
     assert(get_grid().shape(3) == grid_size);
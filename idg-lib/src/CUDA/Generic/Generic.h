@@ -71,6 +71,10 @@ class Generic : public CUDA {
       const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
       Plan::Options options) override;
 
+  WTiles* get_plan_wtiles() override {
+    return do_supports_wtiling() && !m_disable_wtiling ? &m_wtiles : nullptr;
+  }
+
   void init_cache(int subgrid_size, float cell_size, float w_step,
                   const std::array<float, 2>& shift) override;
 
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <iostream>
 
 #include "../CUDA.h"
 #include "../InstanceCUDA.h"
@@ -93,6 +94,15 @@ void CUDA::init_buffers_wtiling(unsigned int subgrid_size) {
   const kernel::cuda::InstanceCUDA& device = get_device(0);
   const cu::Context& context = get_device(0).get_context();
 
+  // The size of the tiles is fixed and their number depends on the device
+  // memory, the w-tile options only apply to w-tiling on the CPU
+  if ((m_wtile_size && m_wtile_size != int(m_tile_size)) ||
+      m_wtile_buffer_bytes) {
+    std::clog << "Warning: wtile_size and wtile_buffer_bytes are ignored by "
+                 "w-tiling on the GPU, which uses w-tiles of "
+              << m_tile_size << " pixels." << std::endl;
+  }
+
   // Memory in use prior to allocating buffers for w-tiling
 #if defined(DEBUG)
   size_t bytes_reserved = device.get_free_memory();
@@ -68,6 +68,10 @@ std::unique_ptr<Plan> GenericOptimized::make_plan(
         baselines,
     const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
     Plan::Options options) {
+  // The GPU kernels index the visibilities relative to the first baseline of
+  // a job, which requires the subgrids of every baseline to stay in place
+  options.subgrid_order = Plan::BASELINE_ORDER;
+
   if (!m_disable_wtiling && !m_disable_wtiling_gpu) {
     options.w_step = m_cache_state.w_step;
     options.nr_w_layers = INT_MAX;
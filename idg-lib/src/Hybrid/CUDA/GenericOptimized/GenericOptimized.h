@@ -37,6 +37,21 @@ class GenericOptimized : public cuda::CUDA {
     cpuProxy->set_disable_wtiling(v);
   }
 
+  void set_wtile_options(int wtile_size, size_t wtile_buffer_bytes) override {
+    Proxy::set_wtile_options(wtile_size, wtile_buffer_bytes);
+    cpuProxy->set_wtile_options(wtile_size, wtile_buffer_bytes);
+  }
+
+  void set_wtile_flush_queue_size(int size) override {
+    Proxy::set_wtile_flush_queue_size(size);
+    cpuProxy->set_wtile_flush_queue_size(size);
+  }
+
+  void set_wtile_prefetch_depth(int depth) override {
+    Proxy::set_wtile_prefetch_depth(depth);
+    cpuProxy->set_wtile_prefetch_depth(depth);
+  }
+
   void set_disable_wtiling_gpu(bool v) { m_disable_wtiling_gpu = v; }
 
   void set_grid(aocommon::xt::Span<std::complex<float>, 4>& grid) override;
@@ -54,6 +69,12 @@ class GenericOptimized : public cuda::CUDA {
       const aocommon::xt::Span<unsigned int, 1>& aterm_offsets,
       Plan::Options options) override;
 
+  WTiles* get_plan_wtiles() override {
+    return !m_disable_wtiling && !m_disable_wtiling_gpu
+               ? &m_wtiles
+               : cpuProxy->get_plan_wtiles();
+  }
+
  private:
   void run_imaging(
       const Plan& plan, const aocommon::xt::Span<float, 1>& frequencies,
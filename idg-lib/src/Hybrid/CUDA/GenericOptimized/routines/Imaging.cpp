@@ -63,6 +63,7 @@ void GenericOptimized::run_imaging(
 
   // Performance measurements
   get_report()->initialize(nr_channels, subgrid_size, grid_size);
+  get_report()->update(Report::plan, plan.get_initialize_runtime());
   device.set_report(get_report());
   cpuKernels->set_report(get_report());
   std::vector<pmt::State> startStates(nr_devices + 1);
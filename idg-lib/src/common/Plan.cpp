@@ -5,12 +5,14 @@
 #include <cassert>    // assert
 #include <algorithm>  // max_element
 #include <memory.h>   // memcpy
+#include <tuple>      // tie
 
 #include <xtensor/xview.hpp>
 #include <xtensor/xsort.hpp>
 
 #include "Plan.h"
 #include "auxiliary.h"
+#include "Serialization.h"
 
 using namespace std;
 
@@ -244,6 +246,101 @@ std::vector<std::pair<int, int>> make_channel_groups(
   return result;
 }
 
+// Position of (x, y) along the Z-order (Morton) curve,
+// given by interleaving the bits of x and y
+inline uint64_t morton_index(uint32_t x, uint32_t y) {
+  auto spread = [](uint64_t v) {
+    v = (v | (v << 16)) & 0x0000ffff0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0f;
+    v = (v | (v << 2)) & 0x3333333333333333;
+    v = (v | (v << 1)) & 0x5555555555555555;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+// Position of (x, y) along the Hilbert curve that fills an n x n square,
+// with n a power of two and x, y < n
+inline uint64_t hilbert_index(uint32_t n, uint32_t x, uint32_t y) {
+  uint64_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    const uint32_t rx = (x & s) > 0;
+    const uint32_t ry = (y & s) > 0;
+    d += uint64_t(s) * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant, such that the curve is continuous
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+// Sort the subgrids in every group of nr_baselines_per_group baselines by
+// w index and then along the space-filling curve given by order. The number
+// of subgrids per group is unchanged, such that the subgrid offsets of the
+// first baseline of every group remain valid.
+void order_subgrids(Plan::SubgridOrder order, size_t nr_baselines_per_group,
+                    int grid_size, const std::vector<int>& subgrid_offset,
+                    std::vector<Metadata>& metadata) {
+  const size_t nr_baselines = subgrid_offset.size() - 1;
+  if (nr_baselines_per_group == 0) {
+    nr_baselines_per_group = std::max(nr_baselines, size_t(1));
+  }
+  const size_t nr_groups =
+      (nr_baselines + nr_baselines_per_group - 1) / nr_baselines_per_group;
+
+  uint32_t curve_size = 1;
+  while (curve_size < uint32_t(grid_size)) {
+    curve_size *= 2;
+  }
+
+  struct SubgridKey {
+    int w_index;
+    uint64_t curve_index;
+    int subgrid_index;
+    bool operator<(const SubgridKey& other) const {
+      return std::tie(w_index, curve_index, subgrid_index) <
+             std::tie(other.w_index, other.curve_index, other.subgrid_index);
+    }
+  };
+
+#pragma omp parallel for schedule(dynamic)
+  for (size_t group = 0; group < nr_groups; group++) {
+    const size_t first_bl = group * nr_baselines_per_group;
+    const size_t last_bl =
+        std::min(first_bl + nr_baselines_per_group, nr_baselines);
+    const int first_subgrid = subgrid_offset[first_bl];
+    const int last_subgrid = subgrid_offset[last_bl];
+
+    std::vector<SubgridKey> keys;
+    keys.reserve(last_subgrid - first_subgrid);
+    for (int i = first_subgrid; i < last_subgrid; i++) {
+      const Coordinate& coordinate = metadata[i].coordinate;
+      const uint32_t x = std::max(coordinate.x, 0);
+      const uint32_t y = std::max(coordinate.y, 0);
+      const uint64_t curve_index = order == Plan::HILBERT_ORDER
+                                       ? hilbert_index(curve_size, x, y)
+                                       : morton_index(x, y);
+      keys.push_back({coordinate.z, curve_index, i});
+    }
+    std::sort(keys.begin(), keys.end());
+
+    // Permute the subgrids of the group through the sorted keys
+    std::vector<Metadata> metadata_group;
+    metadata_group.reserve(keys.size());
+    for (const SubgridKey& key : keys) {
+      metadata_group.push_back(metadata[key.subgrid_index]);
+    }
+    std::copy(metadata_group.begin(), metadata_group.end(),
+              metadata.begin() + first_subgrid);
+  }
+}
+
 void Plan::initialize(
     const int kernel_size, const int subgrid_size, const int grid_size,
     const float cell_size, const aocommon::xt::Span<float, 1>& frequencies,
@@ -259,6 +356,8 @@ void Plan::initialize(
   std::clog << "grid_size    : " << grid_size << std::endl;
 #endif
 
+  m_initialize_runtime = -omp_get_wtime();
+
   // Initialize arguments
   const size_t nr_baselines = uvw.shape(0);
   assert(baselines.size() == nr_baselines);
@@ -277,21 +376,12 @@ void Plan::initialize(
       options.max_nr_channels_per_subgrid;
   const bool plan_strict = options.plan_strict;
 
-  // Temporary metadata vector for individual baselines
-  const size_t max_nr_subgrids_per_baseline =
-      max_nr_timesteps_per_subgrid > 0
-          ? ((nr_timesteps + max_nr_timesteps_per_subgrid) /
-             max_nr_timesteps_per_subgrid) +
-                1
-          : nr_timesteps;
-  xt::xtensor<Metadata, 2> metadata_(
-      {nr_baselines, nr_channels * max_nr_subgrids_per_baseline});
-
-  // Count the actual number of subgrids per baseline
-  std::vector<unsigned int> nr_subgrids_per_baseline(nr_baselines);
+  // Temporary metadata vectors for individual baselines, these grow with
+  // the actual number of subgrids per baseline
+  std::vector<std::vector<Metadata>> metadata_per_baseline(nr_baselines);
 
-// Iterate all baselines
-#pragma omp parallel for
+// Iterate all baselines, the number of subgrids varies per baseline
+#pragma omp parallel for schedule(dynamic)
   for (unsigned bl = 0; bl < nr_baselines; bl++) {
     // Get baseline
     unsigned int antenna1 = baselines(bl).first;
@@ -452,11 +542,7 @@ void Plan::initialize(
               .nr_aterms = -1     // nr of aterms, to be filled in later
           };
 
-          unsigned subgrid_idx = nr_subgrids_per_baseline[bl];
-          metadata_(bl, subgrid_idx++) = m;
-
-          // Update number of subgrids
-          nr_subgrids_per_baseline[bl] = subgrid_idx;
+          metadata_per_baseline[bl].push_back(m);
         } else if (plan_strict) {
 #pragma omp critical
           {
@@ -473,34 +559,34 @@ void Plan::initialize(
     }    // end for channel_groups
   }      // end for bl
 
-  // Find the total number of subgrids for all baselines
-  int total_nr_subgrids = std::accumulate(nr_subgrids_per_baseline.begin(),
-                                          nr_subgrids_per_baseline.end(), 0);
+  // The subgrids of every baseline are placed after those of all prior
+  // baselines: the subgrid offsets are the prefix sum of the number of
+  // subgrids, with the total number of subgrids as sentinel
+  subgrid_offset.resize(nr_baselines + 1);
+  subgrid_offset[0] = 0;
+  for (unsigned bl = 0; bl < nr_baselines; bl++) {
+    subgrid_offset[bl + 1] =
+        subgrid_offset[bl] + metadata_per_baseline[bl].size();
+  }
+  const int total_nr_subgrids = subgrid_offset[nr_baselines];
 
   // Allocate member variables
   metadata.resize(total_nr_subgrids);
   total_nr_timesteps_per_baseline.resize(nr_baselines);
   total_nr_visibilities_per_baseline.resize(nr_baselines);
-  subgrid_offset.resize(nr_baselines);
 
-  // Combine data structures
-  unsigned subgrid_index = 0;
+// Combine data structures
+#pragma omp parallel for
   for (unsigned bl = 0; bl < nr_baselines; bl++) {
-    // The subgrid offset is the number of subgrids for all prior baselines
-    subgrid_offset[bl] = subgrid_index;
-
     // Count total number of timesteps for baseline
     int total_nr_timesteps = 0;
 
-    for (unsigned int i = 0; i < nr_subgrids_per_baseline[bl]; i++) {
-      Metadata& m = metadata_(bl, i);
-
-      // Set wtile_index
-      Coordinate& wtile_coordinate = m.wtile_coordinate;
-      m.wtile_index = wtiles.add_subgrid(subgrid_index, wtile_coordinate);
+    std::vector<Metadata>& metadata_baseline = metadata_per_baseline[bl];
+    for (unsigned int i = 0; i < metadata_baseline.size(); i++) {
+      const Metadata& m = metadata_baseline[i];
 
       // Append subgrid
-      metadata[subgrid_index++] = m;
+      metadata[subgrid_offset[bl] + i] = m;
 
       // Accumulate timesteps, taking only the
       // first channel group into account
@@ -509,6 +595,9 @@ void Plan::initialize(
       }
     }
 
+    // Release the temporary metadata of this baseline
+    std::vector<Metadata>().swap(metadata_baseline);
+
     // Set total total number of timesteps for baseline
     total_nr_timesteps_per_baseline[bl] = total_nr_timesteps;
 
@@ -518,6 +607,16 @@ void Plan::initialize(
     total_nr_visibilities_per_baseline[bl] = total_nr_visibilities;
   }  // end for bl
 
+  // Bring subgrids that are close together on the grid together in the plan,
+  // for the locality of the adder, the splitter and the w-tiles
+  if (options.subgrid_order != BASELINE_ORDER) {
+    order_subgrids(options.subgrid_order, options.subgrid_order_nr_baselines,
+                   grid_size, subgrid_offset, metadata);
+  }
+
+  // Set wtile_index, in the order of the subgrids
+  wtiles.add_subgrids(metadata);
+
   // Reserve aterm indices
   aterm_indices.resize({nr_baselines, nr_timesteps});
 
@@ -562,12 +661,11 @@ void Plan::initialize(
     m.nr_aterms = nr_aterms;
   }
 
-  // Set sentinel
-  subgrid_offset.push_back(metadata.size());
-
   m_wtile_initialize_set = wtiles.get_initialize_set();
   m_wtile_flush_set = wtiles.get_flush_set();
 
+  m_initialize_runtime += omp_get_wtime();
+
 #if defined(DEBUG)
   std::clog << "nr_baselines    : " << nr_baselines << " (input)" << std::endl;
   std::clog << "nr_timesteps    : " << nr_timesteps << " (per baseline)"
@@ -702,6 +800,69 @@ void Plan::initialize_job(const unsigned int nr_baselines,
   (*current_nr_baselines_) = last_bl - first_bl;
 }
 
+namespace {
+// Increment when the layout written by Plan::save changes
+constexpr uint32_t kPlanFormatVersion = 3;
+}  // namespace
+
+void Plan::save(std::ostream& stream) const {
+  serialization::write(stream, kPlanFormatVersion);
+  serialization::write(stream, m_shift);
+  serialization::write(stream, m_subgrid_size);
+  serialization::write(stream, m_w_step);
+  serialization::write(stream, m_cell_size);
+  serialization::write_vector(stream, metadata);
+  serialization::write_vector(stream, subgrid_offset);
+  serialization::write_vector(stream, total_nr_timesteps_per_baseline);
+  serialization::write_vector(stream, total_nr_visibilities_per_baseline);
+  save_wtile_update_set(stream, m_wtile_initialize_set);
+  save_wtile_update_set(stream, m_wtile_flush_set);
+  serialization::write(stream, uint64_t(aterm_indices.shape(0)));
+  serialization::write(stream, uint64_t(aterm_indices.shape(1)));
+  stream.write(reinterpret_cast<const char*>(aterm_indices.data()),
+               aterm_indices.size() * sizeof(unsigned int));
+  serialization::write(stream, use_wtiles);
+  serialization::write(stream, m_options);
+}
+
+void Plan::load(std::istream& stream) {
+  // The runtime of a restored plan is the time it takes to load it
+  m_initialize_runtime = -omp_get_wtime();
+
+  uint32_t version;
+  serialization::read(stream, version);
+  if (version != kPlanFormatVersion) {
+    throw std::runtime_error("unsupported plan format version");
+  }
+  serialization::read(stream, m_shift);
+  serialization::read(stream, m_subgrid_size);
+  serialization::read(stream, m_w_step);
+  serialization::read(stream, m_cell_size);
+  serialization::read_vector(stream, metadata);
+  serialization::read_vector(stream, subgrid_offset);
+  serialization::read_vector(stream, total_nr_timesteps_per_baseline);
+  serialization::read_vector(stream, total_nr_visibilities_per_baseline);
+  m_wtile_initialize_set = load_wtile_update_set(stream);
+  m_wtile_flush_set = load_wtile_update_set(stream);
+  uint64_t nr_baselines;
+  uint64_t nr_timesteps;
+  serialization::read(stream, nr_baselines);
+  serialization::read(stream, nr_timesteps);
+  if (nr_timesteps) {
+    serialization::check_size(stream, nr_baselines,
+                              nr_timesteps * sizeof(unsigned int));
+  }
+  aterm_indices.resize({nr_baselines, nr_timesteps});
+  if (!stream.read(reinterpret_cast<char*>(aterm_indices.data()),
+                   aterm_indices.size() * sizeof(unsigned int))) {
+    throw std::runtime_error("unexpected end of serialized data");
+  }
+  serialization::read(stream, use_wtiles);
+  serialization::read(stream, m_options);
+
+  m_initialize_runtime += omp_get_wtime();
+}
+
 size_t Plan::baseline_index(size_t antenna1, size_t antenna2,
                             size_t nr_stations) {
   assert(antenna1 < antenna2);
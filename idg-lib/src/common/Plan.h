@@ -10,6 +10,8 @@
 #include <cmath>
 #include <numeric>
 #include <iterator>
+#include <istream>
+#include <ostream>
 
 #include <aocommon/xt/span.h>
 #include <omp.h>
@@ -36,6 +38,8 @@ class Plan {
  public:
   enum Mode { FULL_POLARIZATION, STOKES_I_ONLY };
 
+  enum SubgridOrder { BASELINE_ORDER, MORTON_ORDER, HILBERT_ORDER };
+
   struct Options {
     Options() {}
 
@@ -56,6 +60,16 @@ class Plan {
 
     // Imaging mode
     Mode mode = Mode::FULL_POLARIZATION;
+
+    // Order of the subgrids within every group of subgrid_order_nr_baselines
+    // consecutive baselines. With MORTON_ORDER or HILBERT_ORDER, the subgrids
+    // are sorted by w index and then along a space-filling curve over their
+    // position in the grid, such that consecutive subgrids are close together
+    SubgridOrder subgrid_order = SubgridOrder::BASELINE_ORDER;
+
+    // number of baselines per group of reordered subgrids
+    // zero means all baselines
+    unsigned subgrid_order_nr_baselines = 0;
   };
 
   // Constructors
@@ -105,6 +119,9 @@ class Plan {
   int get_nr_subgrids(int baseline, int n) const;
 
   // returns index of first index of baseline
+  // when the subgrids are reordered (see Options::subgrid_order), the subgrids
+  // of baselines b1 to b1+n-1 are still in the range given by the offsets of
+  // b1 and b1+n, but not necessarily in the range of their own baseline
   int get_subgrid_offset(int baseline) const;
 
   // max number of subgrids for n baselines between bl1 and bl2+n
@@ -162,6 +179,16 @@ class Plan {
 
   bool get_use_wtiles() const { return use_wtiles; }
 
+  // time in seconds spent in initialize, or in load for a restored plan
+  double get_initialize_runtime() const { return m_initialize_runtime; }
+
+  // Write the plan to stream in binary form, such that it can be restored
+  // with load, for instance to reuse it for the same uvw coordinates
+  void save(std::ostream& stream) const;
+
+  // Restore a plan that was written by save
+  void load(std::istream& stream);
+
   /* Creates a baseline index for use in a baselines array.
    *   0 implies antenna1=0, antenna2=1 ;
    *   1 implies antenna1=0, antenna2=2 ;
@@ -191,6 +218,7 @@ class Plan {
   xt::xtensor<unsigned int, 2> aterm_indices;
   bool use_wtiles;
   Options m_options;
+  double m_initialize_runtime = 0;
 };  // class Plan
 
 }  // namespace idg
@@ -3,6 +3,7 @@
 
 #include <ThrowAssert.hpp>  // assert
 #include <cmath>            // M_PI
+#include <algorithm>
 #include <climits>
 #include <memory>
 #include "Proxy.h"
@@ -40,6 +41,12 @@ void Proxy::gridding(
         "W-stacking or W-tiling.");
   }
 
+  if (aterms.size() == 0 && !do_supports_identity_aterms()) {
+    throw std::invalid_argument(
+        "aterms is empty, but this Proxy does not support gridding without "
+        "aterms.");
+  }
+
   do_gridding(plan, frequencies, visibilities, uvw, baselines, aterms,
               aterm_offsets, taper);
 }
@@ -64,6 +71,12 @@ void Proxy::degridding(
         "W-stacking.");
   }
 
+  if (aterms.size() == 0 && !do_supports_identity_aterms()) {
+    throw std::invalid_argument(
+        "aterms is empty, but this Proxy does not support degridding without "
+        "aterms.");
+  }
+
   do_degridding(plan, frequencies, visibilities, uvw, baselines, aterms,
                 aterm_offsets, taper);
 }
@@ -330,8 +343,11 @@ void Proxy::check_dimensions(
   throw_assert(uvw_nr_coordinates == 3, "");
   throw_assert(baselines_two == 2, "");
   throw_assert(grid_height == grid_width, "");  // TODO: remove restriction
-  throw_assert(aterms_nr_timeslots + 1 == aterm_offsets_nr_timeslots_plus_one,
-               "");
+  // No aterm timeslots denotes identity aterms
+  throw_assert(
+      aterms_nr_timeslots == 0 ||
+          aterms_nr_timeslots + 1 == aterm_offsets_nr_timeslots_plus_one,
+      "");
   throw_assert(aterms_aterm_height == aterms_aterm_width,
                "");  // TODO: remove restriction
   throw_assert(taper_height == subgrid_size, "");
@@ -380,10 +396,52 @@ void Proxy::set_grid(aocommon::xt::Span<std::complex<float>, 4>& grid) {
   grid_ = grid;
 }
 
+aocommon::xt::Span<std::complex<float>, 4> Proxy::allocate_grid(
+    size_t nr_w_layers, size_t nr_polarizations, size_t height, size_t width) {
+  if (!is_grid_out_of_core()) {
+    aocommon::xt::Span<std::complex<float>, 4> grid =
+        allocate_span<std::complex<float>, 4>(
+            {nr_w_layers, nr_polarizations, height, width});
+
+    if (m_numa_policy != auxiliary::NumaPolicy::kRowBands) {
+      grid.fill(std::complex<float>(0, 0));
+      return grid;
+    }
+
+    // The first touch of a page places it on the NUMA node of the thread. All
+    // threads zero the grid in parallel, every thread the same band of rows
+    // in every plane, such that the grid is spread over the NUMA nodes in
+    // bands of rows, rather than placed on a single node.
+    const size_t nr_planes = nr_w_layers * nr_polarizations;
+    std::complex<float>* ptr = grid.data();
+#pragma omp parallel
+    for (size_t plane = 0; plane < nr_planes; plane++) {
+#pragma omp for schedule(static) nowait
+      for (size_t y = 0; y < height; y++) {
+        std::fill_n(ptr + (plane * height + y) * width, width,
+                    std::complex<float>(0, 0));
+      }
+    }
+    return grid;
+  }
+
+  // A new scratch file is zero, without touching its pages
+  const size_t bytes = nr_w_layers * nr_polarizations * height * width *
+                       sizeof(std::complex<float>);
+  std::unique_ptr<auxiliary::Memory> memory(
+      new auxiliary::MappedMemory(bytes, m_scratch_directory));
+  std::complex<float>* ptr =
+      reinterpret_cast<std::complex<float>*>(memory->data());
+  memory_.push_back(std::move(memory));
+  return aocommon::xt::CreateSpan<std::complex<float>, 4>(
+      ptr, {nr_w_layers, nr_polarizations, height, width});
+}
+
 void Proxy::free_grid() {
   for (auto memory_iterator = std::begin(memory_);
        memory_iterator != std::end(memory_); ++memory_iterator) {
-    if (memory_iterator->get() == reinterpret_cast<void*>(get_grid().data())) {
+    if ((*memory_iterator)->data() ==
+        reinterpret_cast<void*>(get_grid().data())) {
       memory_.erase(memory_iterator);
       break;
     }
@@ -397,6 +455,10 @@ aocommon::xt::Span<std::complex<float>, 4>& Proxy::get_final_grid() {
 }
 
 std::unique_ptr<auxiliary::Memory> Proxy::allocate_memory(size_t bytes) {
+  if (has_memory_policy()) {
+    return std::unique_ptr<auxiliary::Memory>(
+        new auxiliary::NumaMemory(bytes, m_numa_policy, m_huge_pages));
+  }
   return std::unique_ptr<auxiliary::Memory>(
       new auxiliary::DefaultMemory(bytes));
 };
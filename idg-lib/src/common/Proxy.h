@@ -8,6 +8,7 @@
 #include <vector>
 #include <limits>
 #include <cstring>
+#include <string>
 #include <utility>  // pair
 
 #include <aocommon/xt/span.h>
@@ -258,6 +259,70 @@ class Proxy {
     return (!m_disable_wtiling && do_supports_wtiling());
   }
 
+  /**
+   * @brief Set the size of the w-tiles and the memory for the w-tile buffer.
+   *
+   * Takes effect at the next call to init_cache. Larger w-tiles have less
+   * padding overhead relative to their size, while more w-tiles in the
+   * buffer reduce the number of flushes. Only w-tiling on the CPU uses these
+   * options, w-tiling on the GPU ignores them (with a warning).
+   *
+   * @param wtile_size Size of a w-tile in pixels, zero selects the default.
+   * @param wtile_buffer_bytes Memory budget for the w-tile buffer in bytes,
+   * zero derives the number of w-tiles from the grid size. The budget should
+   * hold at least four w-tiles. It does not include the copies of w-tiles
+   * kept by pending flushes and prefetched initializations, see
+   * set_wtile_flush_queue_size and set_wtile_prefetch_depth.
+   */
+  virtual void set_wtile_options(int wtile_size, size_t wtile_buffer_bytes) {
+    if (wtile_size < 0) {
+      throw std::invalid_argument("wtile_size should not be negative");
+    }
+    m_wtile_size = wtile_size;
+    m_wtile_buffer_bytes = wtile_buffer_bytes;
+  }
+
+  /**
+   * @brief Set the number of w-tile flushes that may be pending.
+   *
+   * Takes effect at the next call to init_cache. The flushed w-tiles are
+   * added to the grid on a background thread, while gridding continues with
+   * the next subgrids. Every pending flush keeps a copy of its w-tiles.
+   *
+   * @param size Maximum number of pending flushes, zero adds the w-tiles to
+   * the grid before gridding continues.
+   */
+  virtual void set_wtile_flush_queue_size(int size) {
+    if (size < 0) {
+      throw std::invalid_argument(
+          "wtile_flush_queue_size should not be negative");
+    }
+    m_wtile_flush_queue_size = size;
+  }
+
+  /**
+   * @brief Set the number of w-tile initializations that are prefetched.
+   *
+   * Takes effect at the next call to init_cache. During degridding, the
+   * w-tiles of the next initialize events are computed from the grid on a
+   * background thread, while the subgrids before these events are processed.
+   * Every prefetched event keeps a copy of its w-tiles.
+   *
+   * @param depth Number of events that are prefetched, zero disables
+   * prefetching.
+   */
+  virtual void set_wtile_prefetch_depth(int depth) {
+    if (depth < 0) {
+      throw std::invalid_argument(
+          "wtile_prefetch_depth should not be negative");
+    }
+    m_wtile_prefetch_depth = depth;
+  }
+
+  //! Whether an empty aterms span may be passed to gridding and degridding,
+  //! denoting identity aterms. The aterm computations are then skipped.
+  bool supports_identity_aterms() { return do_supports_identity_aterms(); }
+
   void set_avg_aterm_correction(
       const aocommon::xt::Span<std::complex<float>, 4>& avg_aterm_correction);
   void unset_avg_aterm_correction();
@@ -265,6 +330,23 @@ class Proxy {
   //! Methods for memory management
   virtual std::unique_ptr<auxiliary::Memory> allocate_memory(size_t bytes);
 
+  /**
+   * @brief Set the NUMA placement and the use of huge pages for host memory.
+   *
+   * Applies to the memory allocated by allocate_memory (and thus by
+   * allocate_tensor, allocate_span and allocate_grid) afterwards, in proxies
+   * that allocate regular host memory. Proxies that allocate pinned memory
+   * for a GPU are not affected.
+   *
+   * @param numa_policy see auxiliary::NumaPolicy
+   * @param huge_pages see auxiliary::HugePages
+   */
+  void set_memory_policy(auxiliary::NumaPolicy numa_policy,
+                         auxiliary::HugePages huge_pages) {
+    m_numa_policy = numa_policy;
+    m_huge_pages = huge_pages;
+  }
+
   template <typename T, size_t Dimensions>
   Tensor<T, Dimensions> allocate_tensor(
       const std::initializer_list<size_t> shape) {
@@ -296,6 +378,35 @@ class Proxy {
     return aocommon::xt::CreateSpan(ptr, shape_array);
   }
 
+  /**
+   * @brief Allocate a zeroed grid.
+   *
+   * When a scratch directory is set, the grid is kept in a memory-mapped file
+   * in that directory instead of in RAM, and transform works on it out of
+   * core. The grid should be freed with free_grid.
+   */
+  aocommon::xt::Span<std::complex<float>, 4> allocate_grid(
+      size_t nr_w_layers, size_t nr_polarizations, size_t height,
+      size_t width);
+
+  /**
+   * @brief Set the directory for grids that do not fit in memory.
+   *
+   * @param directory Directory on fast local storage, such as NVMe. An empty
+   * string (the default) keeps grids in memory.
+   * @param buffer_size Memory in bytes used by the out-of-core transform.
+   */
+  void set_scratch_directory(const std::string& directory,
+                             size_t buffer_size = size_t(1) << 30) {
+    m_scratch_directory = directory;
+    m_scratch_buffer_size = buffer_size;
+  }
+
+  //! Whether grids from allocate_grid are kept in a scratch file
+  bool is_grid_out_of_core() const { return !m_scratch_directory.empty(); }
+
+  size_t get_scratch_buffer_size() const { return m_scratch_buffer_size; }
+
   /**
    * Set grid to be used for gridding, degridding or calibration.
    */
@@ -378,6 +489,17 @@ class Proxy {
                                   baselines, aterm_offsets, options);
   }
 
+  /**
+   * @brief Get the w-tiles to which make_plan assigns the subgrids
+   *
+   * A Plan that is made with w-tiles depends on, and updates, their state.
+   * To reuse such a plan (see Plan::save), the state of the w-tiles after
+   * making the plan needs to be restored as well (see WTiles::save).
+   *
+   * @return WTiles* or nullptr when make_plan does not use w-tiles
+   */
+  virtual WTiles* get_plan_wtiles() { return nullptr; }
+
  private:
   //! Degrid the visibilities from a uniform grid
   virtual void do_gridding(
@@ -479,9 +601,27 @@ class Proxy {
  protected:
   virtual bool do_supports_wstacking() { return false; }
   virtual bool do_supports_wtiling() { return false; }
+  virtual bool do_supports_identity_aterms() { return false; }
 
   bool m_disable_wstacking = false;
   bool m_disable_wtiling = false;
+  int m_wtile_size = 0;
+  size_t m_wtile_buffer_bytes = 0;
+  int m_wtile_flush_queue_size = 2;
+  int m_wtile_prefetch_depth = 1;
+
+  std::string m_scratch_directory;
+  size_t m_scratch_buffer_size = size_t(1) << 30;
+
+  // Whether allocate_memory returns auxiliary::NumaMemory, see
+  // set_memory_policy
+  bool has_memory_policy() const {
+    return m_numa_policy != auxiliary::NumaPolicy::kDefault ||
+           m_huge_pages != auxiliary::HugePages::kNone;
+  }
+
+  auxiliary::NumaPolicy m_numa_policy = auxiliary::NumaPolicy::kDefault;
+  auxiliary::HugePages m_huge_pages = auxiliary::HugePages::kNone;
 
   struct {
     int subgrid_size;
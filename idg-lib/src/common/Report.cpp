@@ -83,4 +83,19 @@ void report_visibilities(string name, double runtime, size_t nr_visibilities) {
 #endif
 }
 
+void report_allocations(string name, uint64_t nr_allocations) {
+#if defined(PERFORMANCE_REPORT)
+  clog << setw(FW1) << left << string(name) + ": " << nr_allocations
+       << " allocations" << endl;
+#endif
+}
+
+void report_wtiles(string name, uint64_t nr_wtiles, double w_padding_overhead) {
+#if defined(PERFORMANCE_REPORT)
+  clog << setw(FW1) << left << string(name) + ": " << nr_wtiles << " w-tiles, "
+       << fixed << setprecision(1) << w_padding_overhead * 100
+       << " % w-padding overhead" << endl;
+#endif
+}
+
 }  // end namespace idg
@@ -37,6 +37,7 @@ const std::string name_scaler("scaler");
 const std::string name_average_beam("average-beam");
 const std::string name_wtiling_forward("wtiling");
 const std::string name_wtiling_backward("iwtiling");
+const std::string name_plan("plan");
 const std::string name_host("host");
 const std::string name_device("device");
 }  // namespace auxiliary
@@ -55,6 +56,11 @@ void report(const std::string name, uint64_t flops, uint64_t bytes,
 void report_visibilities(const std::string name, double runtime,
                          uint64_t nr_visibilities);
 
+void report_allocations(const std::string name, uint64_t nr_allocations);
+
+void report_wtiles(const std::string name, uint64_t nr_wtiles,
+                   double w_padding_overhead);
+
 class Report {
   struct State {
     double current_seconds = 0;
@@ -97,6 +103,7 @@ class Report {
     average_beam,
     wtiling_forward,
     wtiling_backward,
+    plan,
     host,
     device,
     sentinel
@@ -136,6 +143,8 @@ class Report {
         return auxiliary::name_wtiling_forward;
       case wtiling_backward:
         return auxiliary::name_wtiling_backward;
+      case plan:
+        return auxiliary::name_plan;
       case host:
         return auxiliary::name_host;
       case device:
@@ -222,6 +231,10 @@ class Report {
       energy_current = 0;
       runtime_total = 0;
       energy_total = 0;
+      allocations_total = 0;
+      wtiles_total = 0;
+      wtile_pixels_total = 0;
+      w_padded_wtile_pixels_total = 0;
     }
 
     ID id;
@@ -231,6 +244,10 @@ class Report {
     double energy_current = 0;
     double runtime_total = 0;
     double energy_total = 0;
+    uint64_t allocations_total = 0;
+    uint64_t wtiles_total = 0;
+    uint64_t wtile_pixels_total = 0;
+    uint64_t w_padded_wtile_pixels_total = 0;
   };
 
  public:
@@ -284,6 +301,27 @@ class Report {
     update(id, start, end);
   }
 
+  // Record the number of heap allocations done by item id
+  void update_allocations(ID id, uint64_t nr_allocations) {
+    items[id].allocations_total += nr_allocations;
+  }
+
+  uint64_t get_nr_allocations(ID id) const {
+    return items[id].allocations_total;
+  }
+
+  // Record the number of wtiles flushed (initialized) by item id, with the
+  // number of pixels in their padded tiles, without and with w-padding
+  void update_wtiles(ID id, uint64_t nr_wtiles, uint64_t nr_pixels,
+                     uint64_t nr_w_padded_pixels) {
+    auto& item = items[id];
+    item.wtiles_total += nr_wtiles;
+    item.wtile_pixels_total += nr_pixels;
+    item.w_padded_wtile_pixels_total += nr_w_padded_pixels;
+  }
+
+  uint64_t get_nr_wtiles(ID id) const { return items[id].wtiles_total; }
+
   void update_total(int nr_subgrids, int nr_timesteps, int nr_visibilities) {
     counters.total_nr_subgrids += nr_subgrids;
     counters.total_nr_timesteps += nr_timesteps;
@@ -308,6 +346,18 @@ class Report {
         auto bytes = get_bytes(item.id, parameters);
         report(prefix + get_name(item.id), seconds, joules, flops, bytes,
                ignore_short);
+        if (total && item.allocations_total) {
+          report_allocations(prefix + get_name(item.id),
+                             item.allocations_total);
+        }
+        if (total && item.wtiles_total) {
+          const double w_padding_overhead =
+              double(item.w_padded_wtile_pixels_total) /
+                  item.wtile_pixels_total -
+              1.0;
+          report_wtiles(prefix + get_name(item.id), item.wtiles_total,
+                        w_padding_overhead);
+        }
         item.updated = false;
       }
     }
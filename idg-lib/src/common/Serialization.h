@@ -0,0 +1,80 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ *  Helpers to write and read trivially copyable values, and vectors of such
+ *  values, in binary form. Used to store plans, see Plan::save.
+ */
+
+#ifndef IDG_SERIALIZATION_H_
+#define IDG_SERIALIZATION_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace idg {
+namespace serialization {
+
+template <typename T>
+void write(std::ostream& stream, const T& value) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "only trivially copyable types can be written");
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void read(std::istream& stream, T& value) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "only trivially copyable types can be read");
+  if (!stream.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error("unexpected end of serialized data");
+  }
+}
+
+/*
+ * Throws std::runtime_error when the remainder of stream is too short for
+ * count values of at least element_size bytes each, e.g. because a count read
+ * from corrupt data is too large. This check precedes allocations for count
+ * values. Streams that can not seek are not checked.
+ */
+inline void check_size(std::istream& stream, uint64_t count,
+                       size_t element_size) {
+  const std::streampos position = stream.tellg();
+  if (position == std::streampos(-1)) {
+    return;
+  }
+  const std::streampos end = stream.seekg(0, std::ios::end).tellg();
+  stream.clear();
+  stream.seekg(position);
+  if (end != std::streampos(-1) &&
+      count > uint64_t(end - position) / element_size) {
+    throw std::runtime_error("invalid size in serialized data");
+  }
+}
+
+template <typename T>
+void write_vector(std::ostream& stream, const std::vector<T>& values) {
+  write(stream, uint64_t(values.size()));
+  stream.write(reinterpret_cast<const char*>(values.data()),
+               values.size() * sizeof(T));
+}
+
+template <typename T>
+void read_vector(std::istream& stream, std::vector<T>& values) {
+  uint64_t size;
+  read(stream, size);
+  check_size(stream, size, sizeof(T));
+  values.resize(size);
+  if (!stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T))) {
+    throw std::runtime_error("unexpected end of serialized data");
+  }
+}
+
+}  // namespace serialization
+}  // namespace idg
+
+#endif
@@ -3,9 +3,11 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
 
 #include "WTiles.h"
 #include "Math.h"
+#include "Serialization.h"
 
 namespace idg {
 
@@ -16,25 +18,110 @@ int WTiles::add_subgrid(int subgrid_index, Coordinate wtile_coordinate) {
   // Get the w-tile from the map of active tiles
   // If the w-tile is not found, it will be default constructed, with wtile_id
   // = -1 and added to the map
-  WTileInfo& wtile_info = m_wtile_map[wtile_coordinate];
-
-  // Update the last access time, and increment the counter
-  wtile_info.last_access = m_subgrid_count++;
+  WTileMap::value_type& wtile =
+      *m_wtile_map.try_emplace(wtile_coordinate).first;
+  WTileInfo& wtile_info = wtile.second;
 
   // If this is a newly constructed tile it needs to be initialized
   if (wtile_info.wtile_id == -1) {
-    wtile_info.wtile_id = get_new_wtile(subgrid_index);
-    if (m_initialize_set.size() == 0) {
-      WTileUpdateInfo wtiles_to_initialize;
-      wtiles_to_initialize.subgrid_index = subgrid_index;
-      m_initialize_set.push_back(wtiles_to_initialize);
+    wtile_info.wtile_id = initialize_wtile(subgrid_index, wtile_coordinate);
+  }
+
+  // Update the last access time, and increment the counter
+  touch_wtile(wtile);
+  return wtile_info.wtile_id;
+}
+
+void WTiles::add_subgrids(std::vector<Metadata>& metadata) {
+  const size_t nr_subgrids = metadata.size();
+
+  // If this is a dummy WTiles instance, no w-tiles are assigned
+  if (m_wtile_buffer_size == 0) {
+    for (Metadata& m : metadata) {
+      m.wtile_index = -1;
     }
+    return;
+  }
 
-    WTileUpdateInfo& wtiles_to_initialize = m_initialize_set.back();
-    wtiles_to_initialize.wtile_coordinates.push_back(wtile_coordinate);
-    wtiles_to_initialize.wtile_ids.push_back(wtile_info.wtile_id);
+  // Every thread finds the distinct w-tile coordinates in a contiguous range
+  // of subgrids, after which these (short) sorted lists are merged
+  const CompareCoordinate compare;
+  auto equal = [&](const Coordinate& lhs, const Coordinate& rhs) {
+    return !compare(lhs, rhs) && !compare(rhs, lhs);
+  };
+  std::vector<std::vector<Coordinate>> thread_coordinates(
+      omp_get_max_threads());
+#pragma omp parallel
+  {
+    std::vector<Coordinate>& local = thread_coordinates[omp_get_thread_num()];
+#pragma omp for schedule(static)
+    for (size_t i = 0; i < nr_subgrids; i++) {
+      local.push_back(metadata[i].wtile_coordinate);
+    }
+    std::sort(local.begin(), local.end(), compare);
+    local.erase(std::unique(local.begin(), local.end(), equal), local.end());
+  }
+
+  std::vector<Coordinate> coordinates;
+  for (const std::vector<Coordinate>& local : thread_coordinates) {
+    std::vector<Coordinate> merged;
+    merged.reserve(coordinates.size() + local.size());
+    std::set_union(coordinates.begin(), coordinates.end(), local.begin(),
+                   local.end(), std::back_inserter(merged), compare);
+    coordinates.swap(merged);
+  }
+
+  auto find_coordinate = [&](const Coordinate& coordinate) {
+    return std::lower_bound(coordinates.begin(), coordinates.end(), coordinate,
+                            compare) -
+           coordinates.begin();
+  };
+
+  std::vector<int> coordinate_indices(nr_subgrids);
+#pragma omp parallel for
+  for (size_t i = 0; i < nr_subgrids; i++) {
+    coordinate_indices[i] = find_coordinate(metadata[i].wtile_coordinate);
+  }
+
+  // Look up the active w-tiles once per distinct coordinate, and remember
+  // for every wtile_id the index of the coordinate it holds
+  std::vector<WTileMap::iterator> active_wtiles(coordinates.size());
+  std::vector<int> wtile_coordinate_indices(m_wtile_buffer_size, -1);
+  for (size_t i = 0; i < coordinates.size(); i++) {
+    active_wtiles[i] = m_wtile_map.find(coordinates[i]);
+    if (active_wtiles[i] != m_wtile_map.end()) {
+      wtile_coordinate_indices[active_wtiles[i]->second.wtile_id] = i;
+    }
+  }
+
+  // Sequentially assign w-tiles, in the order of the subgrids
+  for (size_t i = 0; i < nr_subgrids; i++) {
+    WTileMap::iterator& active_wtile = active_wtiles[coordinate_indices[i]];
+    if (active_wtile == m_wtile_map.end()) {
+      const Coordinate& wtile_coordinate = metadata[i].wtile_coordinate;
+      const size_t nr_flushes = m_flush_set.size();
+      const int wtile_id = initialize_wtile(i, wtile_coordinate);
+
+      // Forget the w-tiles that were retired to obtain wtile_id
+      if (m_flush_set.size() != nr_flushes) {
+        for (int retired_wtile_id : m_flush_set.back().wtile_ids) {
+          int& index = wtile_coordinate_indices[retired_wtile_id];
+          if (index != -1) {
+            active_wtiles[index] = m_wtile_map.end();
+            index = -1;
+          }
+        }
+      }
+
+      WTileInfo wtile_info;
+      wtile_info.wtile_id = wtile_id;
+      active_wtile = m_wtile_map.emplace(wtile_coordinate, wtile_info).first;
+      wtile_coordinate_indices[wtile_id] = coordinate_indices[i];
+    }
+
+    touch_wtile(*active_wtile);
+    metadata[i].wtile_index = active_wtile->second.wtile_id;
   }
-  return wtile_info.wtile_id;
 }
 
 WTileUpdateInfo WTiles::clear() {
@@ -46,32 +133,100 @@ WTileUpdateInfo WTiles::clear() {
     m_free_wtiles.push_back(wtile.second.wtile_id);
   }
   m_wtile_map.clear();
+  reset_lru();
+
+  // Return to the state of a newly constructed cache, such that the state
+  // (see save) does not depend on what was cached before
+  m_subgrid_count = 0;
+  m_free_wtiles.resize(m_wtile_buffer_size);
+  std::iota(m_free_wtiles.begin(), m_free_wtiles.end(), 0);
   return wtiles_to_flush;
 }
 
+void WTiles::save(std::ostream& stream) const {
+  serialization::write(stream, uint64_t(m_subgrid_count));
+  serialization::write(stream, m_wtile_size);
+  serialization::write(stream, m_update_fraction);
+  serialization::write(stream, m_wtile_buffer_size);
+  serialization::write(stream, uint64_t(m_wtile_map.size()));
+  for (const auto& [wtile_coordinate, wtile_info] : m_wtile_map) {
+    serialization::write(stream, wtile_coordinate);
+    serialization::write(stream, wtile_info);
+  }
+  serialization::write_vector(stream, m_free_wtiles);
+  save_wtile_update_set(stream, m_flush_set);
+  save_wtile_update_set(stream, m_initialize_set);
+}
+
+void WTiles::load(std::istream& stream) {
+  uint64_t subgrid_count;
+  serialization::read(stream, subgrid_count);
+  m_subgrid_count = subgrid_count;
+  serialization::read(stream, m_wtile_size);
+  serialization::read(stream, m_update_fraction);
+  serialization::read(stream, m_wtile_buffer_size);
+  uint64_t nr_active_wtiles;
+  serialization::read(stream, nr_active_wtiles);
+  m_wtile_map.clear();
+  for (uint64_t i = 0; i < nr_active_wtiles; i++) {
+    Coordinate wtile_coordinate;
+    WTileInfo wtile_info;
+    serialization::read(stream, wtile_coordinate);
+    serialization::read(stream, wtile_info);
+    m_wtile_map.emplace_hint(m_wtile_map.end(), wtile_coordinate, wtile_info);
+  }
+  serialization::read_vector(stream, m_free_wtiles);
+  m_flush_set = load_wtile_update_set(stream);
+  m_initialize_set = load_wtile_update_set(stream);
+
+  // Rebuild the LRU list from the last access times
+  reset_lru();
+  std::vector<std::pair<Coordinate, WTileInfo>> active_wtiles(
+      m_wtile_map.begin(), m_wtile_map.end());
+  std::sort(active_wtiles.begin(), active_wtiles.end(), CompareLastAccess());
+  for (const auto& [wtile_coordinate, wtile_info] : active_wtiles) {
+    m_lru_coordinates[wtile_info.wtile_id] = wtile_coordinate;
+    link_wtile(wtile_info.wtile_id);
+  }
+}
+
+int WTiles::initialize_wtile(int subgrid_index,
+                             const Coordinate& wtile_coordinate) {
+  const int wtile_id = get_new_wtile(subgrid_index);
+  if (m_initialize_set.size() == 0) {
+    WTileUpdateInfo wtiles_to_initialize;
+    wtiles_to_initialize.subgrid_index = subgrid_index;
+    m_initialize_set.push_back(wtiles_to_initialize);
+  }
+
+  WTileUpdateInfo& wtiles_to_initialize = m_initialize_set.back();
+  wtiles_to_initialize.wtile_coordinates.push_back(wtile_coordinate);
+  wtiles_to_initialize.wtile_ids.push_back(wtile_id);
+  return wtile_id;
+}
+
 int WTiles::get_new_wtile(int subgrid_index) {
   // If there are no more free w-tiles
   // a fraction of the active tiles needs to be retired
   if (!m_free_wtiles.size()) {
     WTileUpdateInfo wtiles_to_flush;
     wtiles_to_flush.subgrid_index = subgrid_index;
-    // Sort the w-tiles by last access time
-    WTilesOrderedByLastAccess wtiles_ordered_by_last_access(m_wtile_map.begin(),
-                                                            m_wtile_map.end());
-    unsigned int n = ceil(m_wtile_buffer_size * m_update_fraction);
-    // Loop over the sorted w-tiles
+    const unsigned int n =
+        std::max(1.0f, ceilf(m_wtile_buffer_size * m_update_fraction));
+    // Retire w-tiles from the front of the LRU list,
     // starting at the least recently used w-tile
-    for (auto wtile : wtiles_ordered_by_last_access) {
+    const int sentinel = m_wtile_buffer_size;
+    while (m_free_wtiles.size() < n && m_lru_next[sentinel] != sentinel) {
+      const int wtile_id = m_lru_next[sentinel];
+      const Coordinate& wtile_coordinate = m_lru_coordinates[wtile_id];
+      unlink_wtile(wtile_id);
       // Remove w-tile from the active set
-      m_wtile_map.erase(wtile.first);
+      m_wtile_map.erase(wtile_coordinate);
       // Add w-tile to the flush set
-      wtiles_to_flush.wtile_coordinates.push_back(wtile.first);
-      wtiles_to_flush.wtile_ids.push_back(wtile.second.wtile_id);
+      wtiles_to_flush.wtile_coordinates.push_back(wtile_coordinate);
+      wtiles_to_flush.wtile_ids.push_back(wtile_id);
       // Add w-tile to the set of free w-tiles
-      m_free_wtiles.push_back(wtile.second.wtile_id);
-      // Break out of the loop when the desired number of w-tiles have been
-      // retired
-      if (m_free_wtiles.size() == n) break;
+      m_free_wtiles.push_back(wtile_id);
     }
 
     // Add the update events to the flush and initialize sets
@@ -88,6 +243,66 @@ int WTiles::get_new_wtile(int subgrid_index) {
   return wtile_id;
 }
 
+void WTiles::touch_wtile(WTileMap::value_type& wtile) {
+  const int wtile_id = wtile.second.wtile_id;
+  wtile.second.last_access = m_subgrid_count++;
+  if (m_lru_next[wtile_id] == -1) {
+    m_lru_coordinates[wtile_id] = wtile.first;
+  } else {
+    unlink_wtile(wtile_id);
+  }
+  link_wtile(wtile_id);
+}
+
+void WTiles::reset_lru() {
+  const int sentinel = m_wtile_buffer_size;
+  m_lru_next.assign(m_wtile_buffer_size + 1, -1);
+  m_lru_prev.assign(m_wtile_buffer_size + 1, -1);
+  m_lru_coordinates.resize(m_wtile_buffer_size);
+  m_lru_next[sentinel] = sentinel;
+  m_lru_prev[sentinel] = sentinel;
+}
+
+void WTiles::unlink_wtile(int wtile_id) {
+  m_lru_next[m_lru_prev[wtile_id]] = m_lru_next[wtile_id];
+  m_lru_prev[m_lru_next[wtile_id]] = m_lru_prev[wtile_id];
+  m_lru_next[wtile_id] = -1;
+  m_lru_prev[wtile_id] = -1;
+}
+
+void WTiles::link_wtile(int wtile_id) {
+  const int sentinel = m_wtile_buffer_size;
+  const int last = m_lru_prev[sentinel];
+  m_lru_prev[wtile_id] = last;
+  m_lru_next[wtile_id] = sentinel;
+  m_lru_next[last] = wtile_id;
+  m_lru_prev[sentinel] = wtile_id;
+}
+
+void save_wtile_update_set(std::ostream& stream,
+                           const WTileUpdateSet& wtile_set) {
+  serialization::write(stream, uint64_t(wtile_set.size()));
+  for (const WTileUpdateInfo& wtile_info : wtile_set) {
+    serialization::write(stream, wtile_info.subgrid_index);
+    serialization::write_vector(stream, wtile_info.wtile_ids);
+    serialization::write_vector(stream, wtile_info.wtile_coordinates);
+  }
+}
+
+WTileUpdateSet load_wtile_update_set(std::istream& stream) {
+  uint64_t size;
+  serialization::read(stream, size);
+  // Every update info holds an index and the sizes of two vectors
+  serialization::check_size(stream, size, sizeof(int) + 2 * sizeof(uint64_t));
+  WTileUpdateSet wtile_set(size);
+  for (WTileUpdateInfo& wtile_info : wtile_set) {
+    serialization::read(stream, wtile_info.subgrid_index);
+    serialization::read_vector(stream, wtile_info.wtile_ids);
+    serialization::read_vector(stream, wtile_info.wtile_coordinates);
+  }
+  return wtile_set;
+}
+
 int compute_w_padded_tile_size(const idg::Coordinate& coordinate,
                                const float w_step, const float image_size,
                                const float image_size_shift,
@@ -4,6 +4,7 @@
 #ifndef IDG_WTILES_H_
 #define IDG_WTILES_H_
 
+#include <istream>
 #include <iterator>
 #include <limits>
 #include <map>
@@ -13,6 +14,7 @@
 #include <stdexcept>  // runtime_error
 #include <cmath>
 #include <numeric>
+#include <ostream>
 #include <omp.h>
 
 #include "Types.h"
@@ -57,13 +59,6 @@ struct CompareLastAccess {
  */
 typedef std::map<Coordinate, WTileInfo, CompareCoordinate> WTileMap;
 
-/**
- * @brief A set type to sort W-tiles by last time accessed
- *
- */
-typedef std::set<std::pair<Coordinate, WTileInfo>, CompareLastAccess>
-    WTilesOrderedByLastAccess;
-
 /**
  * @brief A structure to store the information needed for an update event
  *
@@ -105,6 +100,7 @@ class WTiles {
         m_wtile_buffer_size(wtile_buffer_size),
         m_free_wtiles(wtile_buffer_size) {
     std::iota(m_free_wtiles.begin(), m_free_wtiles.end(), 0);
+    reset_lru();
   }
 
   int get_wtile_buffer_size() { return m_wtile_buffer_size; }
@@ -120,6 +116,19 @@ class WTiles {
    */
   int add_subgrid(int subgrid_index, Coordinate wtile_coordinate);
 
+  /**
+   * @brief Assign a wtile_index to all subgrids of a Plan
+   *
+   * Equivalent to calling add_subgrid for every subgrid in order, with the
+   * position of the subgrid in metadata as subgrid_index. The distinct w-tile
+   * coordinates are found in parallel, such that the remaining sequential
+   * pass over the subgrids does not need to search the map of active w-tiles.
+   *
+   * @param metadata subgrids for which wtile_coordinate is set, on return
+   * wtile_index is set as well
+   */
+  void add_subgrids(std::vector<Metadata>& metadata);
+
   /**
    * @brief Get the flush set object
    *
@@ -143,10 +152,26 @@ class WTiles {
   /**
    * @brief clear entire cache...
    *
+   * Afterwards the cache is in the same state as a newly constructed one.
+   *
    * @return * WTileUpdateInfo object with the w-tiles that need to be flushed
    */
   WTileUpdateInfo clear();
 
+  /**
+   * @brief Write the state of the cache to stream
+   *
+   * Used to store the state of the cache together with a Plan, see
+   * Plan::save, such that the state after creating the Plan can be restored
+   * with load.
+   */
+  void save(std::ostream& stream) const;
+
+  /**
+   * @brief Restore a state that was written by save
+   */
+  void load(std::istream& stream);
+
  private:
   /**
    * @brief Get a new wtile
@@ -161,16 +186,48 @@ class WTiles {
    */
   int get_new_wtile(int subgrid_index);
 
+  /**
+   * @brief Get a new wtile for the tile at wtile_coordinate, and add it to the
+   * initialize set
+   */
+  int initialize_wtile(int subgrid_index, const Coordinate& wtile_coordinate);
+
+  /**
+   * @brief Mark the active w-tile as the most recently used one
+   *
+   * The w-tile is (re)inserted at the back of the LRU list, the w-tiles at
+   * the front of the list are the first to be retired by get_new_wtile
+   */
+  void touch_wtile(WTileMap::value_type& wtile);
+
+  // Helper functions for the LRU list
+  void reset_lru();
+  void unlink_wtile(int wtile_id);
+  void link_wtile(int wtile_id);
+
   size_t m_subgrid_count;
   int m_wtile_size;
   float m_update_fraction;
   WTileMap m_wtile_map;
   int m_wtile_buffer_size;
   std::vector<int> m_free_wtiles;
+  // Doubly linked list of the active w-tiles in order of last access,
+  // indexed by wtile_id. The element at index m_wtile_buffer_size is the
+  // sentinel: its next element is the least recently used w-tile and its
+  // previous element the most recently used one. Every w-tile in the list
+  // keeps its coordinate, to find it in m_wtile_map when it is retired.
+  std::vector<int> m_lru_next;
+  std::vector<int> m_lru_prev;
+  std::vector<Coordinate> m_lru_coordinates;
   WTileUpdateSet m_flush_set;
   WTileUpdateSet m_initialize_set;
 };
 
+// Helper functions to write and read a WTileUpdateSet in binary form
+void save_wtile_update_set(std::ostream& stream,
+                           const WTileUpdateSet& wtile_set);
+WTileUpdateSet load_wtile_update_set(std::istream& stream);
+
 // Helper function to compute the size of a w_padded tile
 int compute_w_padded_tile_size(const idg::Coordinate& coordinate,
                                const float w_step, const float image_size,
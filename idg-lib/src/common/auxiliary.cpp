@@ -1,13 +1,20 @@
 // Copyright (C) 2020 ASTRON (Netherlands Institute for Radio Astronomy)
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <cstdint>
 #include <cstdlib>
 #include <omp.h>
+#include <fcntl.h>
 #include <sys/resource.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+#include <stdexcept>
 #include <string>
 
 #include "idg-config.h"
@@ -354,5 +361,115 @@ AlignedMemory::AlignedMemory(size_t size)
 
 AlignedMemory::~AlignedMemory() { free(data()); };
 
+MappedMemory::MappedMemory(size_t size, const std::string& directory)
+    : Memory(size) {
+  std::string filename = directory + "/idg-scratch-XXXXXX";
+  fd_ = mkstemp(&filename[0]);
+  if (fd_ == -1) {
+    throw std::runtime_error("Could not create scratch file in " + directory);
+  }
+  // The file stays accessible through fd_ and is removed on close
+  unlink(filename.c_str());
+
+  if (ftruncate(fd_, size) != 0) {
+    close(fd_);
+    throw std::runtime_error("Could not resize scratch file in " + directory);
+  }
+
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (ptr == MAP_FAILED) {
+    close(fd_);
+    throw std::runtime_error("Could not map scratch file in " + directory);
+  }
+  set(ptr);
+}
+
+MappedMemory::~MappedMemory() {
+  munmap(data(), size());
+  close(fd_);
+}
+
+void MappedMemory::zero() {
+  // Truncating the file discards all its blocks, the pages read back as zeros
+  if (ftruncate(fd_, 0) != 0 || ftruncate(fd_, size()) != 0) {
+    Memory::zero();
+  }
+}
+
+namespace {
+
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+// Interleave the pages of [ptr, ptr + size) over the NUMA nodes that the
+// process may use. The NUMA system calls are used directly, to not depend on
+// libnuma. Failure, e.g. on a kernel without NUMA support, is not an error,
+// the pages are then placed as usual.
+void interleave_pages(void* ptr, size_t size) {
+#if defined(__linux__)
+  constexpr unsigned long kMaxNode = 1024;
+  unsigned long nodemask[kMaxNode / (8 * sizeof(unsigned long))] = {};
+  if (syscall(SYS_get_mempolicy, nullptr, nodemask, kMaxNode, nullptr,
+              MPOL_F_MEMS_ALLOWED) == 0) {
+    syscall(SYS_mbind, ptr, size, MPOL_INTERLEAVE, nodemask, kMaxNode, 0);
+  }
+#endif
+}
+
+}  // namespace
+
+NumaMemory::NumaMemory(size_t size, NumaPolicy numa_policy,
+                       HugePages huge_pages)
+    : Memory(size), mapping_(MAP_FAILED), mapping_size_(0) {
+  const size_t min_size = std::max(size, size_t(1));
+  void* ptr = MAP_FAILED;
+  // Part of the mapping that the NUMA policy applies to
+  size_t region_size = min_size;
+  // Memory smaller than a huge page would mostly be padding
+  if (size < kHugePageSize) {
+    huge_pages = HugePages::kNone;
+  }
+
+#if defined(MAP_HUGETLB)
+  if (huge_pages == HugePages::kExplicit) {
+    mapping_size_ =
+        (min_size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    ptr = mapping_;
+    region_size = mapping_size_;
+  }
+#endif
+
+  if (mapping_ == MAP_FAILED) {
+    // With transparent huge pages, the mapping is padded such that the memory
+    // can start at a multiple of the huge page size
+    const bool use_huge_pages = huge_pages != HugePages::kNone;
+    mapping_size_ = use_huge_pages ? min_size + kHugePageSize : min_size;
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping_ == MAP_FAILED) {
+      throw std::runtime_error("Could not map " + std::to_string(size) +
+                               " bytes of memory");
+    }
+    ptr = mapping_;
+    region_size = min_size;
+    if (use_huge_pages) {
+      const uintptr_t address = reinterpret_cast<uintptr_t>(mapping_);
+      ptr = reinterpret_cast<void*>((address + kHugePageSize - 1) /
+                                    kHugePageSize * kHugePageSize);
+#if defined(MADV_HUGEPAGE)
+      madvise(ptr, region_size, MADV_HUGEPAGE);
+#endif
+    }
+  }
+
+  if (numa_policy == NumaPolicy::kInterleaved) {
+    interleave_pages(ptr, region_size);
+  }
+  set(ptr);
+}
+
+NumaMemory::~NumaMemory() { munmap(mapping_, mapping_size_); }
+
 }  // namespace auxiliary
 }  // namespace idg
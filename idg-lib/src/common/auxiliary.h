@@ -136,7 +136,7 @@ class Memory {
 
  protected:
   explicit Memory(size_t size) : size_(size) {}
-  Memory(void* ptr, size_t size) : ptr_(ptr) {}
+  Memory(void* ptr, size_t size) : ptr_(ptr), size_(size) {}
   void set(void* ptr) { ptr_ = ptr; }
 
  private:
@@ -159,6 +159,65 @@ class AlignedMemory : public Memory {
   static const unsigned int alignment_ = 64;
 };
 
+/*
+ * Memory backed by an (unlinked) scratch file in directory, for buffers that
+ * are too large to be kept in RAM. The file is mapped shared, such that pages
+ * that are evicted by the kernel are written back to the file instead of to
+ * swap. The file is removed when the memory is released.
+ */
+class MappedMemory : public Memory {
+ public:
+  MappedMemory(size_t size, const std::string& directory);
+  ~MappedMemory() override;
+
+  // Drops the contents of the file instead of writing zeros to every page
+  void zero() override;
+
+ private:
+  int fd_;
+};
+
+/*
+ * Placement of the pages of memory on NUMA nodes:
+ *  - kDefault: a page is placed on the node of the thread that first touches
+ *    it.
+ *  - kInterleaved: the pages are interleaved over all NUMA nodes that the
+ *    process may use.
+ *  - kRowBands: as kDefault, but Proxy::allocate_grid zeroes the grid with
+ *    all threads in parallel, every thread the same band of rows in every
+ *    plane, instead of with a single thread. The grid is thereby spread over
+ *    the nodes in bands of rows.
+ */
+enum class NumaPolicy { kDefault, kInterleaved, kRowBands };
+
+/*
+ * Use of 2 MB huge pages, for memory of at least that size:
+ *  - kNone: regular pages.
+ *  - kTransparent: the memory is aligned to 2 MB and marked for transparent
+ *    huge pages (madvise), which the kernel uses when available.
+ *  - kExplicit: the memory is allocated from the reserved huge pages
+ *    (MAP_HUGETLB, see /proc/sys/vm/nr_hugepages). When there are not enough
+ *    of those, transparent huge pages are used instead.
+ */
+enum class HugePages { kNone, kTransparent, kExplicit };
+
+/*
+ * Anonymous memory mapping with a NUMA policy and huge pages, see NumaPolicy
+ * and HugePages. The memory is aligned to the page size, or to the huge page
+ * size when huge pages are used. Smaller memory uses regular pages. The pages
+ * are not touched on allocation, such that their placement is determined by
+ * the code that initializes them.
+ */
+class NumaMemory : public Memory {
+ public:
+  NumaMemory(size_t size, NumaPolicy numa_policy, HugePages huge_pages);
+  ~NumaMemory() override;
+
+ private:
+  void* mapping_;
+  size_t mapping_size_;
+};
+
 }  // namespace auxiliary
 }  // namespace idg
 
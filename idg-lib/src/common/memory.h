@@ -1,6 +1,11 @@
 // Copyright (C) 2020 ASTRON (Netherlands Institute for Radio Astronomy)
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#ifndef IDG_MEMORY_H_
+#define IDG_MEMORY_H_
+
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -8,10 +13,17 @@
 
 #define ALIGNMENT 64
 
+// Number of calls to allocate_memory, used to verify that the kernels do not
+// allocate memory once they reach their steady state.
+inline std::atomic<uint64_t> allocate_memory_count(0);
+
+inline uint64_t get_allocate_memory_count() { return allocate_memory_count; }
+
 template <class T>
 T* allocate_memory(size_t n, unsigned int alignment = ALIGNMENT) {
   void* ptr = nullptr;
   if (n > 0) {
+    allocate_memory_count++;
     size_t bytes = n * sizeof(T);
     bytes = (((bytes - 1) / alignment) * alignment) + alignment;
 
@@ -36,3 +48,5 @@ T* allocate_memory(size_t n, unsigned int alignment = ALIGNMENT) {
   }
   return (T*)ptr;
 }
+
+#endif
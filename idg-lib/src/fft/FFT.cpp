@@ -2,6 +2,13 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "FFT.h"
+#include "FFTPlanCache.h"
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <new>
+#include <vector>
 
 #include <fftw3.h>
 
@@ -14,17 +21,17 @@ void kernel_fft_composite(unsigned batch, unsigned int m, unsigned int n,
   fftwf_complex* in_ptr = reinterpret_cast<fftwf_complex*>(data);
   fftwf_complex* out_ptr = reinterpret_cast<fftwf_complex*>(data);
 
-  // Initialize FFT plans
-  fftwf_plan plan_col = fftwf_plan_dft_1d(n, NULL, NULL, sign, FFTW_ESTIMATE);
-  fftwf_plan plan_row =
-      m == n ? plan_col : fftwf_plan_dft_1d(m, NULL, NULL, sign, FFTW_ESTIMATE);
+  // Get FFT plans, the rows and (copied) columns are not necessarily aligned
+  FFTPlanCache& plan_cache = FFTPlanCache::get_instance();
+  fftwf_plan plan_row = plan_cache.get_plan_dft_1d(n, sign, false);
+  fftwf_plan plan_col = plan_cache.get_plan_dft_1d(m, sign, false);
 
   for (size_t i = 0; i < batch; i++) {
 // FFT over rows
 #pragma omp parallel for
     for (size_t y = 0; y < m; y++) {
       uint64_t offset = i * m * n + y * n;
-      fftwf_execute_dft(plan_col, in_ptr + offset, out_ptr + offset);
+      fftwf_execute_dft(plan_row, in_ptr + offset, out_ptr + offset);
     }
 
     // Iterate all columns
@@ -60,22 +67,17 @@ void kernel_fft_composite(unsigned batch, unsigned int m, unsigned int n,
       }
     }
   }
-
-  // Free FFT plans
-  fftwf_destroy_plan(plan_col);
-  if (m != n) {
-    fftwf_destroy_plan(plan_row);
-  }
 }
 
 void kernel_fft_coarse(int batch, int height, int width,
                        std::complex<float>* data, int sign) {
   fftwf_complex* data_ptr = reinterpret_cast<fftwf_complex*>(data);
 
-  // Create plan
-  fftwf_plan plan;
-  plan =
-      fftwf_plan_dft_2d(height, width, data_ptr, data_ptr, sign, FFTW_ESTIMATE);
+  // Get plan, which can use aligned access when every transform is aligned
+  const bool aligned = FFTPlanCache::is_aligned(data) &&
+                       FFTPlanCache::is_aligned(data + height * width);
+  FFTPlanCache& plan_cache = FFTPlanCache::get_instance();
+  fftwf_plan plan = plan_cache.get_plan_dft_2d(height, width, sign, aligned);
 
 #pragma omp parallel for private(data_ptr)
   for (int i = 0; i < batch; i++) {
@@ -84,9 +86,6 @@ void kernel_fft_coarse(int batch, int height, int width,
     // Execute FFTs
     fftwf_execute_dft(plan, data_ptr, data_ptr);
   }  // end for batch
-
-  // Cleanup
-  fftwf_destroy_plan(plan);
 }
 
 void kernel_fft(unsigned batch, int height, int width,
@@ -103,36 +102,43 @@ void kernel_fft(unsigned batch, int height, int width,
   }
 }
 
-void fft2f(unsigned batch, int m, int n, complex<float>* data) {
-  ifftshift(batch, m, n, data);
+void fft2f(unsigned batch, int m, int n, complex<float>* data, bool shift) {
+  if (shift) {
+    ifftshift(batch, m, n, data);
+  }
   kernel_fft(batch, m, n, data, FFTW_FORWARD);
-  fftshift(batch, m, n, data);
+  if (shift) {
+    fftshift(batch, m, n, data);
+  }
 }
 
 void fft2f(int m, int n, std::complex<float>* data) { fft2f(1, m, n, data); }
 
 void fft2f(int n, std::complex<float>* data) { fft2f(n, n, data); }
 
-void ifft2f(unsigned batch, int m, int n, complex<float>* data) {
-  ifftshift(batch, m, n, data);
+void ifft2f(unsigned batch, int m, int n, complex<float>* data, bool shift) {
+  if (shift) {
+    ifftshift(batch, m, n, data);
+  }
   kernel_fft(batch, m, n, data, FFTW_BACKWARD);
-  fftshift(batch, m, n, data);
+  if (shift) {
+    fftshift(batch, m, n, data);
+  }
 }
 
-void ifft2f(int m, int n, std::complex<float>* data) { ifft2f(1, n, n, data); }
+void ifft2f(int m, int n, std::complex<float>* data) { ifft2f(1, m, n, data); }
 
 void ifft2f(int n, std::complex<float>* data) { ifft2f(n, n, data); }
 
 void fft2f_r2c(int m, int n, float* data_in, complex<float>* data_out) {
   fftwf_complex* tmp = (fftwf_complex*)data_out;
-  fftwf_plan plan;
-
-#pragma omp critical
-  plan = fftwf_plan_dft_r2c_2d(m, n, data_in, tmp, FFTW_ESTIMATE);
+  const bool aligned =
+      FFTPlanCache::is_aligned(data_in) && FFTPlanCache::is_aligned(data_out);
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_r2c_2d(m, n, aligned);
   ifftshift(m, n, tmp);
-  fftwf_execute(plan);
+  fftwf_execute_dft_r2c(plan, data_in, tmp);
   fftshift(m, n, tmp);
-  fftwf_destroy_plan(plan);
 }
 
 void fft2f_r2c(int n, float* data_in, complex<float>* data_out) {
@@ -141,20 +147,358 @@ void fft2f_r2c(int n, float* data_in, complex<float>* data_out) {
 
 void ifft2f_c2r(int m, int n, complex<float>* data_in, float* data_out) {
   fftwf_complex* tmp = (fftwf_complex*)data_in;
-  fftwf_plan plan;
-
-#pragma omp critical
-  plan = fftwf_plan_dft_c2r_2d(m, n, tmp, data_out, FFTW_ESTIMATE);
+  const bool aligned =
+      FFTPlanCache::is_aligned(data_in) && FFTPlanCache::is_aligned(data_out);
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_c2r_2d(m, n, aligned);
   ifftshift(m, n, tmp);
-  fftwf_execute(plan);
+  fftwf_execute_dft_c2r(plan, tmp, data_out);
   fftshift(m, n, tmp);
-  fftwf_destroy_plan(plan);
 }
 
 void ifft2f_c2r(int n, complex<float>* data_in, float* data_out) {
   ifft2f_c2r(n, n, data_in, data_out);
 }
 
+namespace {
+
+// fftshift for a real m-by-n image with row stride get_real_fft_stride(n)
+void fftshift_real(int m, int n, float* image) {
+  if (m % 2 != 0 || n % 2 != 0)
+    throw std::invalid_argument(
+        "Only grids with even height and width are supported.");
+
+  const size_t stride = get_real_fft_stride(n);
+
+#pragma omp parallel
+  {
+    std::vector<float> buffer(n);
+#pragma omp for
+    for (int i = 0; i < m / 2; i++) {
+      float* row_i = &image[i * stride];
+      float* row_j = &image[(i + m / 2) * stride];
+      std::copy_n(row_i, n, buffer.data());
+      std::copy_n(row_j, n / 2, &row_i[n / 2]);
+      std::copy_n(&row_j[n / 2], n / 2, row_i);
+      std::copy_n(&buffer[n / 2], n / 2, row_j);
+      std::copy_n(buffer.data(), n / 2, &row_j[n / 2]);
+    }
+  }
+}
+
+/*
+ * Move the rows of an m-by-n array between the full layout (row stride n) and
+ * the half plane layout (row stride n / 2 + 1, which keeps the first n / 2 + 1
+ * values of every row). Rows are moved in blocks that do not overlap with
+ * rows that are not moved yet, the rows within a block are moved in parallel.
+ */
+void expand_half_plane(int m, int n, std::complex<float>* data) {
+  const size_t half = n / 2 + 1;
+  long end = m;
+  while (end > 1) {
+    // Rows [begin, end) are written beyond the rows that still need to move
+    const long begin =
+        std::min(end - 1, std::max(1L, long((end * half + n - 1) / n)));
+#pragma omp parallel for
+    for (long y = begin; y < end; y++) {
+      std::memmove(&data[y * n], &data[y * half], half * sizeof(*data));
+    }
+    end = begin;
+  }
+}
+
+void compact_half_plane(int m, int n, std::complex<float>* data) {
+  const size_t half = n / 2 + 1;
+  long begin = 1;
+  while (begin < m) {
+    const long end =
+        std::max(begin + 1, std::min(long(m), long(begin * n / half)));
+#pragma omp parallel for
+    for (long y = begin; y < end; y++) {
+      std::memmove(&data[y * half], &data[y * n], half * sizeof(*data));
+    }
+    begin = end;
+  }
+}
+
+// Expand the half plane of a Hermitian m-by-n array to the full array, using
+// F(-u, -v) = conj(F(u, v)) for the right half of every row
+void complete_hermitian(int m, int n, std::complex<float>* data) {
+  expand_half_plane(m, n, data);
+#pragma omp parallel for
+  for (int y = 0; y < m; y++) {
+    const std::complex<float>* row_mirror = &data[size_t((m - y) % m) * n];
+    for (int x = n / 2 + 1; x < n; x++) {
+      data[size_t(y) * n + x] = std::conj(row_mirror[n - x]);
+    }
+  }
+}
+
+// Replace the m-by-n array F by the half plane of its Hermitian part
+// (F(u, v) + conj(F(-u, -v))) / 2
+void extract_hermitian(int m, int n, std::complex<float>* data) {
+  // The rows y and -y are updated by the same thread
+#pragma omp parallel for
+  for (int y = 0; y <= m / 2; y++) {
+    const int y_mirror = (m - y) % m;
+    std::complex<float>* row = &data[size_t(y) * n];
+    std::complex<float>* row_mirror = &data[size_t(y_mirror) * n];
+    for (int x = 0; x < n; x++) {
+      const int x_mirror = (n - x) % n;
+      if (y == y_mirror && x > x_mirror) {
+        continue;
+      }
+      const std::complex<float> value =
+          0.5f * (row[x] + std::conj(row_mirror[x_mirror]));
+      row[x] = value;
+      row_mirror[x_mirror] = std::conj(value);
+    }
+  }
+
+  compact_half_plane(m, n, data);
+}
+
+// 1D FFTs over the rows in the cyclic range [first_row, first_row + nr_rows)
+// of an m-by-n array
+void fft_rows(int m, int n, std::complex<float>* data, int first_row,
+              int nr_rows, int sign) {
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_1d(n, sign, false);
+
+#pragma omp parallel for
+  for (int i = 0; i < nr_rows; i++) {
+    std::complex<float>* row = &data[size_t((first_row + i) % m) * n];
+    fftwf_execute_dft(plan, reinterpret_cast<fftwf_complex*>(row),
+                      reinterpret_cast<fftwf_complex*>(row));
+  }
+}
+
+// 1D FFTs over all columns of an m-by-n array with row stride ld, in blocks of
+// adjacent columns that share cache lines
+void fft_columns(int m, int n, int ld, std::complex<float>* data, int sign) {
+  constexpr int kBlockSize = 8;
+  FFTPlanCache& plan_cache = FFTPlanCache::get_instance();
+  const int nr_blocks = (n + kBlockSize - 1) / kBlockSize;
+  const int remainder = n - (nr_blocks - 1) * kBlockSize;
+  fftwf_plan plan_block =
+      plan_cache.get_plan_many_dft(1, &m, kBlockSize, ld, 1, sign, false);
+  fftwf_plan plan_remainder =
+      plan_cache.get_plan_many_dft(1, &m, remainder, ld, 1, sign, false);
+
+#pragma omp parallel for
+  for (int block = 0; block < nr_blocks; block++) {
+    fftwf_complex* column =
+        reinterpret_cast<fftwf_complex*>(data) + block * kBlockSize;
+    fftwf_plan plan = block == nr_blocks - 1 ? plan_remainder : plan_block;
+    fftwf_execute_dft(plan, column, column);
+  }
+}
+
+// Processes nr_slabs slabs, using three buffers of slab_size elements: while
+// slab i is transformed, a background thread stores slab i - 1 and loads
+// slab i + 1.
+template <typename Load, typename Transform, typename Store>
+void pipeline_slabs(int nr_slabs, size_t slab_size,
+                    std::complex<float>* buffers, Load load,
+                    Transform transform, Store store) {
+  auto buffer = [&](int slab) { return &buffers[(slab % 3) * slab_size]; };
+
+  std::future<void> io =
+      std::async(std::launch::async, [&] { load(0, buffer(0)); });
+  for (int slab = 0; slab < nr_slabs; slab++) {
+    io.get();
+    io = std::async(std::launch::async, [&, slab] {
+      if (slab > 0) {
+        store(slab - 1, buffer(slab - 1));
+      }
+      if (slab + 1 < nr_slabs) {
+        load(slab + 1, buffer(slab + 1));
+      }
+    });
+    transform(slab, buffer(slab));
+  }
+  io.get();
+  store(nr_slabs - 1, buffer(nr_slabs - 1));
+}
+
+}  // namespace
+
+void fft2f_pruned(int m, int n, std::complex<float>* data, int first_row,
+                  int nr_rows) {
+  // The other rows are zero, and remain zero after the FFT over the rows
+  fft_rows(m, n, data, first_row, nr_rows, FFTW_FORWARD);
+  fft_columns(m, n, n, data, FFTW_FORWARD);
+}
+
+void ifft2f_pruned(int m, int n, std::complex<float>* data, int first_row,
+                   int nr_rows) {
+  fft_columns(m, n, n, data, FFTW_BACKWARD);
+  fft_rows(m, n, data, first_row, nr_rows, FFTW_BACKWARD);
+}
+
+void fft2f_real_pruned(int m, int n, std::complex<float>* data,
+                       int first_row, int nr_rows) {
+  const size_t half = n / 2 + 1;
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_r2c_1d(n, false, true);
+
+  // Real-to-complex FFTs over the non-zero rows, followed by complex FFTs
+  // over the columns of the half plane
+#pragma omp parallel for
+  for (int i = 0; i < nr_rows; i++) {
+    std::complex<float>* row = &data[((first_row + i) % m) * half];
+    fftwf_execute_dft_r2c(plan, reinterpret_cast<float*>(row),
+                          reinterpret_cast<fftwf_complex*>(row));
+  }
+  fft_columns(m, half, half, data, FFTW_FORWARD);
+
+  complete_hermitian(m, n, data);
+}
+
+void ifft2f_real_pruned(int m, int n, std::complex<float>* data,
+                        int first_row, int nr_rows) {
+  const size_t half = n / 2 + 1;
+  fftwf_plan plan =
+      FFTPlanCache::get_instance().get_plan_dft_c2r_1d(n, false, true);
+
+  // Complex FFTs over the columns of the half plane, followed by
+  // complex-to-real FFTs over the rows that are used
+  extract_hermitian(m, n, data);
+  fft_columns(m, half, half, data, FFTW_BACKWARD);
+#pragma omp parallel for
+  for (int i = 0; i < nr_rows; i++) {
+    std::complex<float>* row = &data[((first_row + i) % m) * half];
+    fftwf_execute_dft_c2r(plan, reinterpret_cast<fftwf_complex*>(row),
+                          reinterpret_cast<float*>(row));
+  }
+}
+
+void fft2f_real(int m, int n, std::complex<float>* data, bool shift) {
+  if (shift) {
+    fftshift_real(m, n, reinterpret_cast<float*>(data));
+  }
+
+  // The 1D FFTs over the rows and columns are done in parallel
+  fft2f_real_pruned(m, n, data, 0, m);
+
+  if (shift) {
+    fftshift(m, n, data);
+  }
+}
+
+void ifft2f_real(int m, int n, std::complex<float>* data, bool shift) {
+  if (shift) {
+    ifftshift(m, n, data);
+  }
+
+  ifft2f_real_pruned(m, n, data, 0, m);
+
+  if (shift) {
+    fftshift_real(m, n, reinterpret_cast<float*>(data));
+  }
+}
+
+void fft2f_out_of_core(unsigned batch, int m, int n, std::complex<float>* data,
+                       int sign, bool shift, std::complex<float> scale,
+                       size_t buffer_size) {
+  if (shift && (m % 2 != 0 || n % 2 != 0)) {
+    throw std::invalid_argument(
+        "Only grids with even height and width are supported.");
+  }
+
+  // Every slab holds at least one row or column
+  const size_t slab_size =
+      std::max(buffer_size / (3 * sizeof(std::complex<float>)),
+               size_t(std::max(m, n)));
+  const int rows_per_slab = std::min(size_t(m), slab_size / n);
+  const int columns_per_slab = std::min(size_t(n), slab_size / m);
+  const int nr_row_slabs = (m + rows_per_slab - 1) / rows_per_slab;
+  const int nr_column_slabs = (n + columns_per_slab - 1) / columns_per_slab;
+  // The buffers are not initialized, since they are overwritten by every
+  // load, and zeroing up to buffer_size bytes on every call is costly
+  std::unique_ptr<fftwf_complex, decltype(&fftwf_free)> buffers(
+      fftwf_alloc_complex(3 * slab_size), &fftwf_free);
+  if (!buffers) {
+    throw std::bad_alloc();
+  }
+  std::complex<float>* buffers_ptr =
+      reinterpret_cast<std::complex<float>*>(buffers.get());
+
+  for (unsigned b = 0; b < batch; b++) {
+    std::complex<float>* array = &data[size_t(b) * m * n];
+
+    // Pass over slabs of adjacent rows, which are contiguous in data
+    auto row_range = [&](int slab) {
+      const int first_row = slab * rows_per_slab;
+      return std::make_pair(first_row, std::min(rows_per_slab, m - first_row));
+    };
+    auto load_rows = [&](int slab, std::complex<float>* buffer) {
+      const auto [first_row, nr_rows] = row_range(slab);
+      std::copy_n(&array[size_t(first_row) * n], size_t(nr_rows) * n, buffer);
+    };
+    auto store_rows = [&](int slab, const std::complex<float>* buffer) {
+      const auto [first_row, nr_rows] = row_range(slab);
+      std::copy_n(buffer, size_t(nr_rows) * n, &array[size_t(first_row) * n]);
+    };
+    auto transform_rows = [&](int slab, std::complex<float>* buffer) {
+      const auto [first_row, nr_rows] = row_range(slab);
+      if (shift) {
+#pragma omp parallel for
+        for (int y = 0; y < nr_rows; y++) {
+          for (int x = 0; x < n; x++) {
+            buffer[size_t(y) * n + x] *=
+                get_checkerboard_sign(first_row + y, x);
+          }
+        }
+      }
+      fft_rows(nr_rows, n, buffer, 0, nr_rows, sign);
+    };
+    pipeline_slabs(nr_row_slabs, slab_size, buffers_ptr, load_rows,
+                   transform_rows, store_rows);
+
+    // Pass over slabs of adjacent columns, which are gathered from every row
+    auto column_range = [&](int slab) {
+      const int first_column = slab * columns_per_slab;
+      return std::make_pair(first_column,
+                            std::min(columns_per_slab, n - first_column));
+    };
+    auto load_columns = [&](int slab, std::complex<float>* buffer) {
+      const auto [first_column, nr_columns] = column_range(slab);
+      for (int y = 0; y < m; y++) {
+        std::copy_n(&array[size_t(y) * n + first_column], nr_columns,
+                    &buffer[size_t(y) * nr_columns]);
+      }
+    };
+    auto store_columns = [&](int slab, const std::complex<float>* buffer) {
+      const auto [first_column, nr_columns] = column_range(slab);
+      for (int y = 0; y < m; y++) {
+        std::copy_n(&buffer[size_t(y) * nr_columns], nr_columns,
+                    &array[size_t(y) * n + first_column]);
+      }
+    };
+    // The shifts are equivalent to modulating both the input and the output
+    // with the checkerboard, up to the sign (-1)^(m / 2 + n / 2)
+    const float shift_sign = get_checkerboard_sign(m / 2, n / 2);
+    auto transform_columns = [&](int slab, std::complex<float>* buffer) {
+      const auto [first_column, nr_columns] = column_range(slab);
+      fft_columns(m, nr_columns, nr_columns, buffer, sign);
+#pragma omp parallel for
+      for (int y = 0; y < m; y++) {
+        for (int x = 0; x < nr_columns; x++) {
+          std::complex<float>& value = buffer[size_t(y) * nr_columns + x];
+          const float factor =
+              shift ? shift_sign * get_checkerboard_sign(y, first_column + x)
+                    : 1.0f;
+          value = {factor * value.real() * scale.real(),
+                   factor * value.imag() * scale.imag()};
+        }
+      }
+    };
+    pipeline_slabs(nr_column_slabs, slab_size, buffers_ptr, load_columns,
+                   transform_columns, store_columns);
+  }
+}
+
 void resize2f(int m_in, int n_in, complex<float>* data_in, int m_out, int n_out,
               complex<float>* data_out) {
   // scale before FFT
@@ -16,8 +16,24 @@
 
 namespace idg {
 
+// The fftshift and ifftshift in the batched and real 2d-FFTs can be left out
+// (shift = false) when the caller reorders the image in a pass over the data
+// that it needs anyway: element (y, x) of the unshifted transform input (FFT)
+// or output (iFFT) then corresponds to image pixel
+// (get_shifted_index(y, m), get_shifted_index(x, n)), multiplied by
+// get_checkerboard_sign(y, x). The grid remains centered. This requires even
+// m and n.
+inline size_t get_shifted_index(size_t i, size_t n) {
+  return i < n / 2 ? i + n / 2 : i - n / 2;
+}
+
+inline float get_checkerboard_sign(size_t y, size_t x) {
+  return (y + x) % 2 ? -1.0f : 1.0f;
+}
+
 // in-place batched 2d-FFT for complex float  m-by-n arrays
-void fft2f(unsigned batch, int m, int n, std::complex<float>* data);
+void fft2f(unsigned batch, int m, int n, std::complex<float>* data,
+           bool shift = true);
 
 // in-place 2d-FFT for complex float m-by-n array
 void fft2f(int m, int n, std::complex<float>* data);
@@ -26,7 +42,8 @@ void fft2f(int m, int n, std::complex<float>* data);
 void fft2f(int n, std::complex<float>* data);
 
 // in-place batched 2d-iFFT for complex float  m-b-n arrays
-void ifft2f(unsigned batch, int m, int n, std::complex<float>* data);
+void ifft2f(unsigned batch, int m, int n, std::complex<float>* data,
+            bool shift = true);
 
 // in-place 2d-iFFT for complex float m-by-n arrays
 void ifft2f(int m, int n, std::complex<float>* data);
@@ -46,6 +63,52 @@ void ifft2f_c2r(int m, int n, std::complex<float>* data_in, float* data_out);
 // complex-to-real 2d-FFT for n-by-n array
 void ifft2f_c2r(int n, std::complex<float>* data_in, float* data_out);
 
+// row stride (in floats) of a real m-by-n image that is transformed in-place
+// by fft2f_real or ifft2f_real: every row is padded to n / 2 + 1 complex values
+inline size_t get_real_fft_stride(int n) { return 2 * (size_t(n) / 2 + 1); }
+
+// in-place 2d-FFT for a real m-by-n image, stored in data with row stride
+// get_real_fft_stride(n). On return, data holds the complex m-by-n result of
+// fft2f for this image. Only a half plane is transformed, the other half
+// follows from Hermitian symmetry.
+void fft2f_real(int m, int n, std::complex<float>* data, bool shift = true);
+
+// in-place 2d-iFFT for a complex m-by-n array, of which only the real part of
+// the result is used. On return, data holds the real part of the result of
+// ifft2f as an m-by-n image with row stride get_real_fft_stride(n). Only the
+// Hermitian part of the input contributes to the real part, such that only a
+// half plane is transformed.
+void ifft2f_real(int m, int n, std::complex<float>* data, bool shift = true);
+
+// Pruned versions of the FFTs above, for an image that only covers the rows in
+// the cyclic range [first_row, first_row + nr_rows) modulo m. The FFTs skip
+// the rows outside this range: on input to fft2f_pruned and fft2f_real_pruned
+// these rows (including their padding) have to be zero, on output of
+// ifft2f_pruned and ifft2f_real_pruned their contents is undefined. The shifts
+// are not applied, see get_shifted_index.
+void fft2f_pruned(int m, int n, std::complex<float>* data, int first_row,
+                  int nr_rows);
+void ifft2f_pruned(int m, int n, std::complex<float>* data, int first_row,
+                   int nr_rows);
+void fft2f_real_pruned(int m, int n, std::complex<float>* data,
+                       int first_row, int nr_rows);
+void ifft2f_real_pruned(int m, int n, std::complex<float>* data,
+                        int first_row, int nr_rows);
+
+// in-place batched 2d-FFT (sign -1) or 2d-iFFT (sign 1) for complex float
+// m-by-n arrays that are too large to be kept in memory, such as grids in a
+// memory-mapped scratch file. The FFT is done as a pass over slabs of rows
+// followed by a pass over slabs of columns, that are copied to buffers of in
+// total buffer_size bytes. The copies are done on a background thread,
+// overlapped with the FFT of the previous slab. With shift, the fftshift and
+// ifftshift are applied through get_checkerboard_sign, which requires even m
+// and n. The real and imaginary parts of the result are multiplied by the real
+// and imaginary part of scale.
+void fft2f_out_of_core(unsigned batch, int m, int n, std::complex<float>* data,
+                       int sign, bool shift,
+                       std::complex<float> scale = {1.0f, 1.0f},
+                       size_t buffer_size = size_t(1) << 30);
+
 // fftshift for m-by-n array of type T
 // TODO: make work for odd dimensions
 template <typename T>
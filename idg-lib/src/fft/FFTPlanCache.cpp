@@ -0,0 +1,195 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "FFTPlanCache.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+namespace idg {
+
+namespace {
+
+FFTPlannerEffort parse_planner_effort(const std::string& name) {
+  if (name == "estimate") {
+    return FFTPlannerEffort::kEstimate;
+  } else if (name == "measure") {
+    return FFTPlannerEffort::kMeasure;
+  } else if (name == "patient") {
+    return FFTPlannerEffort::kPatient;
+  }
+  throw std::invalid_argument("Unknown FFTW planner effort: " + name);
+}
+
+unsigned get_planner_flags(FFTPlannerEffort effort) {
+  switch (effort) {
+    case FFTPlannerEffort::kPatient:
+      return FFTW_PATIENT;
+    case FFTPlannerEffort::kMeasure:
+      return FFTW_MEASURE;
+    default:
+      return FFTW_ESTIMATE;
+  }
+}
+
+}  // namespace
+
+FFTPlanCache& FFTPlanCache::get_instance() {
+  static FFTPlanCache instance;
+  return instance;
+}
+
+FFTPlanCache::FFTPlanCache() {
+  const char* effort = getenv("IDG_FFTW_PLANNER");
+  if (effort) {
+    effort_ = parse_planner_effort(effort);
+  }
+
+  const char* wisdom_file = getenv("IDG_FFTW_WISDOM");
+  if (wisdom_file) {
+    set_wisdom_file(wisdom_file);
+  }
+}
+
+FFTPlanCache::~FFTPlanCache() {
+  if (nr_plans_created_ && !wisdom_file_.empty()) {
+    // Exceptions can not be propagated from here, a failed export only means
+    // that the next run has to plan again
+    fftwf_export_wisdom_to_filename(wisdom_file_.c_str());
+  }
+
+  for (auto& entry : plans_) {
+    fftwf_destroy_plan(entry.second);
+  }
+}
+
+fftwf_plan FFTPlanCache::get_plan_many_dft(int rank, const int* n, int howmany,
+                                           int stride, int dist, int sign,
+                                           bool aligned) {
+  if (rank != 1 && rank != 2) {
+    throw std::invalid_argument("Only 1D and 2D FFTs are supported.");
+  }
+  return get_plan({Kind::kComplex, rank, n[0], rank == 2 ? n[1] : 1, howmany,
+                   stride, dist, sign, aligned, true});
+}
+
+fftwf_plan FFTPlanCache::get_plan_dft_r2c_2d(int m, int n, bool aligned,
+                                             bool in_place) {
+  return get_plan({Kind::kRealToComplex, 2, m, n, 1, 1, m * n, FFTW_FORWARD,
+                   aligned, in_place});
+}
+
+fftwf_plan FFTPlanCache::get_plan_dft_c2r_2d(int m, int n, bool aligned,
+                                             bool in_place) {
+  return get_plan({Kind::kComplexToReal, 2, m, n, 1, 1, m * n, FFTW_BACKWARD,
+                   aligned, in_place});
+}
+
+fftwf_plan FFTPlanCache::get_plan_dft_r2c_1d(int n, bool aligned,
+                                             bool in_place) {
+  return get_plan({Kind::kRealToComplex, 1, n, 1, 1, 1, n, FFTW_FORWARD,
+                   aligned, in_place});
+}
+
+fftwf_plan FFTPlanCache::get_plan_dft_c2r_1d(int n, bool aligned,
+                                             bool in_place) {
+  return get_plan({Kind::kComplexToReal, 1, n, 1, 1, 1, n, FFTW_BACKWARD,
+                   aligned, in_place});
+}
+
+bool FFTPlanCache::is_aligned(const void* ptr) {
+  return fftwf_alignment_of(
+             const_cast<float*>(reinterpret_cast<const float*>(ptr))) == 0;
+}
+
+void FFTPlanCache::set_effort(FFTPlannerEffort effort) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  effort_ = effort;
+}
+
+FFTPlannerEffort FFTPlanCache::get_effort() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return effort_;
+}
+
+void FFTPlanCache::set_wisdom_file(const std::string& filename) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A missing file is not an error, it is created at exit
+  if (std::ifstream(filename).good() &&
+      !fftwf_import_wisdom_from_filename(filename.c_str())) {
+    throw std::runtime_error("Could not import FFTW wisdom from " + filename);
+  }
+  wisdom_file_ = filename;
+}
+
+void FFTPlanCache::export_wisdom(const std::string& filename) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!fftwf_export_wisdom_to_filename(filename.c_str())) {
+    throw std::runtime_error("Could not export FFTW wisdom to " + filename);
+  }
+}
+
+size_t FFTPlanCache::get_nr_plans_created() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return nr_plans_created_;
+}
+
+fftwf_plan FFTPlanCache::get_plan(const Key& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = plans_.find(key);
+  if (it != plans_.end()) {
+    return it->second;
+  }
+
+  fftwf_plan plan = create_plan(key);
+  plans_.emplace(key, plan);
+  nr_plans_created_++;
+  return plan;
+}
+
+fftwf_plan FFTPlanCache::create_plan(const Key& key) {
+  const auto [kind, rank, n0, n1, howmany, stride, dist, sign, aligned,
+              in_place] = key;
+  const int n[2] = {n0, n1};
+  unsigned flags = get_planner_flags(effort_);
+  if (!aligned) {
+    flags |= FFTW_UNALIGNED;
+  }
+
+  // Plan on scratch arrays, since measuring overwrites the data
+  fftwf_plan plan = nullptr;
+  if (kind == Kind::kComplex) {
+    // For rank 1, n1 is 1
+    const size_t size =
+        size_t(howmany - 1) * dist + (size_t(n0) * n1 - 1) * stride + 1;
+    fftwf_complex* data = fftwf_alloc_complex(size);
+    plan = fftwf_plan_many_dft(rank, n, howmany, data, nullptr, stride, dist,
+                               data, nullptr, stride, dist, sign, flags);
+    fftwf_free(data);
+  } else {
+    // The last dimension is halved in the complex array, for rank 1 this is n0
+    const size_t nr_rows = rank == 2 ? n0 : 1;
+    const size_t nr_columns = rank == 2 ? n1 : n0;
+    fftwf_complex* complex =
+        fftwf_alloc_complex(nr_rows * (nr_columns / 2 + 1));
+    float* real = in_place ? reinterpret_cast<float*>(complex)
+                           : fftwf_alloc_real(nr_rows * nr_columns);
+    plan = kind == Kind::kRealToComplex
+               ? fftwf_plan_many_dft_r2c(rank, n, 1, real, nullptr, 1, 0,
+                                         complex, nullptr, 1, 0, flags)
+               : fftwf_plan_many_dft_c2r(rank, n, 1, complex, nullptr, 1, 0,
+                                         real, nullptr, 1, 0, flags);
+    if (!in_place) {
+      fftwf_free(real);
+    }
+    fftwf_free(complex);
+  }
+
+  if (!plan) {
+    throw std::runtime_error("Could not create FFTW plan.");
+  }
+  return plan;
+}
+
+}  // namespace idg
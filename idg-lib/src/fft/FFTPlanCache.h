@@ -0,0 +1,123 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IDG_FFT_PLAN_CACHE_H_
+#define IDG_FFT_PLAN_CACHE_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include <fftw3.h>
+
+namespace idg {
+
+/*
+ * Planning effort, corresponding to FFTW_ESTIMATE, FFTW_MEASURE and
+ * FFTW_PATIENT.
+ */
+enum class FFTPlannerEffort { kEstimate = 0, kMeasure = 1, kPatient = 2 };
+
+/*
+ * Process-wide cache of single precision FFTW plans. A plan is created once for
+ * every combination of transform size, batch layout, direction, placement and
+ * alignment, and is kept until the end of the process. The plans are created
+ * on scratch arrays, such that measuring does not overwrite user data, and are
+ * meant to be executed with the new-array execute functions
+ * (fftwf_execute_dft, fftwf_execute_dft_r2c and fftwf_execute_dft_c2r).
+ *
+ * All methods are thread-safe. Since the FFTW planner is not, all FFTW plans in
+ * IDG are created through this cache, and other code in the process should not
+ * create or destroy FFTW plans concurrently. Neither should it call
+ * fftwf_cleanup, which invalidates the cached plans.
+ *
+ * On first use, the planner effort is read from the environment variable
+ * IDG_FFTW_PLANNER (estimate, measure or patient; estimate by default) and
+ * wisdom is imported from the file given by IDG_FFTW_WISDOM, if set. When new
+ * plans were created, the wisdom is exported to this file again at exit.
+ */
+class FFTPlanCache {
+ public:
+  static FFTPlanCache& get_instance();
+
+  ~FFTPlanCache();
+
+  FFTPlanCache(const FFTPlanCache&) = delete;
+  FFTPlanCache& operator=(const FFTPlanCache&) = delete;
+
+  /*
+   * Returns a plan for howmany in-place complex transforms of rank 1 or 2 with
+   * dimensions n, stored with the given stride (between elements) and dist
+   * (between transforms). Set aligned when all arrays that the plan is executed
+   * on are SIMD aligned, see is_aligned().
+   */
+  fftwf_plan get_plan_many_dft(int rank, const int* n, int howmany, int stride,
+                               int dist, int sign, bool aligned);
+
+  fftwf_plan get_plan_dft_1d(int n, int sign, bool aligned) {
+    return get_plan_many_dft(1, &n, 1, 1, n, sign, aligned);
+  }
+
+  fftwf_plan get_plan_dft_2d(int m, int n, int sign, bool aligned) {
+    const int dims[2] = {m, n};
+    return get_plan_many_dft(2, dims, 1, 1, m * n, sign, aligned);
+  }
+
+  /*
+   * Plans for real-to-complex and complex-to-real transforms. In-place
+   * transforms store the real (m-by-)n array with rows of 2 * (n / 2 + 1)
+   * floats.
+   */
+  fftwf_plan get_plan_dft_r2c_2d(int m, int n, bool aligned,
+                                 bool in_place = false);
+  fftwf_plan get_plan_dft_c2r_2d(int m, int n, bool aligned,
+                                 bool in_place = false);
+  fftwf_plan get_plan_dft_r2c_1d(int n, bool aligned, bool in_place = false);
+  fftwf_plan get_plan_dft_c2r_1d(int n, bool aligned, bool in_place = false);
+
+  // Returns whether ptr has the alignment that FFTW uses for SIMD
+  static bool is_aligned(const void* ptr);
+
+  /*
+   * Set the planning effort, this only applies to plans that are not yet in
+   * the cache. Plans can not be replaced, since other threads may be executing
+   * them.
+   */
+  void set_effort(FFTPlannerEffort effort);
+  FFTPlannerEffort get_effort();
+
+  /*
+   * Import wisdom from filename, and export the accumulated wisdom to this file
+   * at exit. Throws std::runtime_error when the file exists but can not be
+   * read.
+   */
+  void set_wisdom_file(const std::string& filename);
+
+  // Export the wisdom to filename, throws std::runtime_error on failure
+  void export_wisdom(const std::string& filename);
+
+  // Number of plans created by this cache
+  size_t get_nr_plans_created();
+
+ private:
+  FFTPlanCache();
+
+  enum class Kind { kComplex, kRealToComplex, kComplexToReal };
+
+  // kind, rank, n[0], n[1], howmany, stride, dist, sign, aligned, in_place
+  using Key = std::tuple<Kind, int, int, int, int, int, int, int, bool, bool>;
+
+  fftwf_plan get_plan(const Key& key);
+  fftwf_plan create_plan(const Key& key);
+
+  std::mutex mutex_;
+  std::map<Key, fftwf_plan> plans_;
+  FFTPlannerEffort effort_ = FFTPlannerEffort::kEstimate;
+  std::string wisdom_file_;
+  size_t nr_plans_created_ = 0;
+};
+
+}  // namespace idg
+
+#endif
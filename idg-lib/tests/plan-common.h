@@ -0,0 +1,82 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// This file contains common helper code for the plan tests, tPlan in idg-lib
+// and tPlanCache in idg-api.
+
+#ifndef IDG_TESTS_PLAN_COMMON_H_
+#define IDG_TESTS_PLAN_COMMON_H_
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/Types.h"
+
+#include <aocommon/xt/span.h>
+
+// Returns the serialized form of object, e.g. a Plan or WTiles
+template <typename T>
+std::string save(const T& object) {
+  std::ostringstream stream;
+  object.save(stream);
+  return stream.str();
+}
+
+// The visibilities of a few baselines on circular tracks in the uv-plane, the
+// track of baseline bl has radius baseline_length * (bl + 1). With w_rate, w
+// increases by w_rate every timestep.
+class Observation {
+ public:
+  Observation(size_t nr_baselines, size_t nr_timesteps, float rotation,
+              float baseline_length, float w_rate = 0.0f)
+      : frequencies_{150e6f, 151e6f},
+        uvw_(nr_baselines * nr_timesteps),
+        baselines_(nr_baselines),
+        aterm_offsets_{0, static_cast<unsigned int>(nr_timesteps)},
+        nr_baselines_(nr_baselines),
+        nr_timesteps_(nr_timesteps) {
+    for (size_t bl = 0; bl < nr_baselines; bl++) {
+      baselines_[bl] = {0, bl + 1};
+      const float length = baseline_length * (bl + 1);
+      for (size_t t = 0; t < nr_timesteps; t++) {
+        const float angle = rotation + 0.1f * t;
+        uvw_[bl * nr_timesteps + t] = {length * std::cos(angle),
+                                       length * std::sin(angle), w_rate * t};
+      }
+    }
+  }
+
+  aocommon::xt::Span<float, 1> get_frequencies() {
+    return aocommon::xt::CreateSpan<float, 1>(frequencies_.data(),
+                                              {frequencies_.size()});
+  }
+
+  aocommon::xt::Span<idg::UVW<float>, 2> get_uvw() {
+    return aocommon::xt::CreateSpan<idg::UVW<float>, 2>(
+        uvw_.data(), {nr_baselines_, nr_timesteps_});
+  }
+
+  aocommon::xt::Span<std::pair<unsigned int, unsigned int>, 1>
+  get_baselines() {
+    return aocommon::xt::CreateSpan<std::pair<unsigned int, unsigned int>, 1>(
+        baselines_.data(), {nr_baselines_});
+  }
+
+  aocommon::xt::Span<unsigned int, 1> get_aterm_offsets() {
+    return aocommon::xt::CreateSpan<unsigned int, 1>(aterm_offsets_.data(),
+                                                     {aterm_offsets_.size()});
+  }
+
+ private:
+  std::vector<float> frequencies_;
+  std::vector<idg::UVW<float>> uvw_;
+  std::vector<std::pair<unsigned int, unsigned int>> baselines_;
+  std::vector<unsigned int> aterm_offsets_;
+  size_t nr_baselines_;
+  size_t nr_timesteps_;
+};
+
+#endif
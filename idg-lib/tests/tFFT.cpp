@@ -0,0 +1,206 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <complex>
+#include <tuple>
+#include <vector>
+
+#include "fft/FFT.h"
+
+namespace {
+
+std::vector<std::complex<float>> make_input(size_t size) {
+  std::vector<std::complex<float>> input(size);
+  for (size_t i = 0; i < size; i++) {
+    input[i] = {float(i % 7) - 3.0f, float(i % 5) - 2.0f};
+  }
+  return input;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_fft)
+
+BOOST_AUTO_TEST_CASE(real) {
+  // The shifts require an even height and width
+  for (const auto& [m, n, shift] : {std::make_tuple(12, 10, true),
+                                   std::make_tuple(12, 10, false),
+                                   std::make_tuple(9, 7, false)}) {
+    const size_t stride = idg::get_real_fft_stride(n);
+    const std::vector<std::complex<float>> input = make_input(m * n);
+
+    // FFT of the real part of the input
+    std::vector<std::complex<float>> reference(m * n);
+    std::vector<std::complex<float>> result(m * n);
+    for (int y = 0; y < m; y++) {
+      for (int x = 0; x < n; x++) {
+        reference[y * n + x] = input[y * n + x].real();
+        reinterpret_cast<float*>(result.data())[y * stride + x] =
+            input[y * n + x].real();
+      }
+    }
+    idg::fft2f(1, m, n, reference.data(), shift);
+    idg::fft2f_real(m, n, result.data(), shift);
+    for (int i = 0; i < m * n; i++) {
+      BOOST_CHECK_SMALL(std::abs(result[i] - reference[i]), 1e-4f);
+    }
+
+    // Real part of the iFFT
+    reference = input;
+    result = input;
+    idg::ifft2f(1, m, n, reference.data(), shift);
+    idg::ifft2f_real(m, n, result.data(), shift);
+    const float* image = reinterpret_cast<const float*>(result.data());
+    for (int y = 0; y < m; y++) {
+      for (int x = 0; x < n; x++) {
+        BOOST_CHECK_SMALL(image[y * stride + x] - reference[y * n + x].real(),
+                          1e-3f);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pruned) {
+  // The image rows wrap around the end of the grid, for even and odd sizes
+  for (const auto& [m, n, first_row, nr_rows] :
+       {std::make_tuple(12, 10, 9, 6), std::make_tuple(9, 7, 6, 5)}) {
+    auto is_image_row = [m = m, first_row = first_row,
+                         nr_rows = nr_rows](int y) {
+      return (y - first_row + m) % m < nr_rows;
+    };
+    std::vector<std::complex<float>> input = make_input(m * n);
+    for (int y = 0; y < m; y++) {
+      if (!is_image_row(y)) {
+        std::fill_n(&input[y * n], n, std::complex<float>(0.0f, 0.0f));
+      }
+    }
+
+    // Complex FFT of an image with zero rows
+    std::vector<std::complex<float>> reference(input);
+    std::vector<std::complex<float>> result(input);
+    idg::fft2f(1, m, n, reference.data(), false);
+    idg::fft2f_pruned(m, n, result.data(), first_row, nr_rows);
+    for (int i = 0; i < m * n; i++) {
+      BOOST_CHECK_SMALL(std::abs(result[i] - reference[i]), 1e-4f);
+    }
+
+    // Complex iFFT, of which only the image rows are computed
+    reference = make_input(m * n);
+    result = reference;
+    idg::ifft2f(1, m, n, reference.data(), false);
+    idg::ifft2f_pruned(m, n, result.data(), first_row, nr_rows);
+    for (int y = 0; y < m; y++) {
+      for (int x = 0; x < n && is_image_row(y); x++) {
+        BOOST_CHECK_SMALL(std::abs(result[y * n + x] - reference[y * n + x]),
+                          1e-3f);
+      }
+    }
+
+    // Real FFT, the real image is stored with row stride
+    // get_real_fft_stride(n). The padding of the rows is zero as well.
+    const size_t stride = idg::get_real_fft_stride(n);
+    std::fill(result.begin(), result.end(), std::complex<float>(0.0f, 0.0f));
+    for (int y = 0; y < m; y++) {
+      for (int x = 0; x < n; x++) {
+        reference[y * n + x] = input[y * n + x].real();
+        reinterpret_cast<float*>(result.data())[y * stride + x] =
+            input[y * n + x].real();
+      }
+    }
+    idg::fft2f(1, m, n, reference.data(), false);
+    idg::fft2f_real_pruned(m, n, result.data(), first_row, nr_rows);
+    for (int i = 0; i < m * n; i++) {
+      BOOST_CHECK_SMALL(std::abs(result[i] - reference[i]), 1e-4f);
+    }
+
+    // Real part of the iFFT, of which only the image rows are computed
+    reference = make_input(m * n);
+    result = reference;
+    idg::ifft2f(1, m, n, reference.data(), false);
+    idg::ifft2f_real_pruned(m, n, result.data(), first_row, nr_rows);
+    const float* image = reinterpret_cast<const float*>(result.data());
+    for (int y = 0; y < m; y++) {
+      for (int x = 0; x < n && is_image_row(y); x++) {
+        BOOST_CHECK_SMALL(image[y * stride + x] - reference[y * n + x].real(),
+                          1e-3f);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(checkerboard) {
+  const int m = 12;
+  const int n = 10;
+  const std::vector<std::complex<float>> input = make_input(m * n);
+
+  // Without shifts, the FFT of the shifted image modulated by the
+  // checkerboard equals the FFT with shifts
+  std::vector<std::complex<float>> reference(input);
+  std::vector<std::complex<float>> result(m * n);
+  for (int y = 0; y < m; y++) {
+    for (int x = 0; x < n; x++) {
+      result[y * n + x] = idg::get_checkerboard_sign(y, x) *
+                          input[idg::get_shifted_index(y, m) * n +
+                                idg::get_shifted_index(x, n)];
+    }
+  }
+  idg::fft2f(1, m, n, reference.data(), true);
+  idg::fft2f(1, m, n, result.data(), false);
+  for (int i = 0; i < m * n; i++) {
+    BOOST_CHECK_SMALL(std::abs(result[i] - reference[i]), 1e-4f);
+  }
+
+  // The iFFT without shifts yields the shifted image, modulated by the
+  // checkerboard
+  reference = input;
+  result = input;
+  idg::ifft2f(1, m, n, reference.data(), true);
+  idg::ifft2f(1, m, n, result.data(), false);
+  for (int y = 0; y < m; y++) {
+    for (int x = 0; x < n; x++) {
+      const std::complex<float> pixel =
+          reference[idg::get_shifted_index(y, m) * n +
+                    idg::get_shifted_index(x, n)];
+      BOOST_CHECK_SMALL(
+          std::abs(idg::get_checkerboard_sign(y, x) * result[y * n + x] -
+                   pixel),
+          1e-3f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(out_of_core) {
+  const unsigned batch = 2;
+  const int m = 12;
+  const int n = 10;
+  const std::vector<std::complex<float>> input = make_input(batch * m * n);
+
+  // A small buffer size yields slabs of a few rows and columns
+  for (const size_t buffer_size : {size_t(256), size_t(1) << 20}) {
+    for (const bool shift : {false, true}) {
+      std::vector<std::complex<float>> reference(input);
+      std::vector<std::complex<float>> result(input);
+      idg::fft2f(batch, m, n, reference.data(), shift);
+      idg::fft2f_out_of_core(batch, m, n, result.data(), -1, shift,
+                             {1.0f, 1.0f}, buffer_size);
+      for (size_t i = 0; i < input.size(); i++) {
+        BOOST_CHECK_SMALL(std::abs(result[i] - reference[i]), 1e-4f);
+      }
+
+      idg::ifft2f(batch, m, n, reference.data(), shift);
+      idg::fft2f_out_of_core(batch, m, n, result.data(), 1, shift,
+                             {2.0f, 0.0f}, buffer_size);
+      for (size_t i = 0; i < input.size(); i++) {
+        BOOST_CHECK_SMALL(
+            std::abs(result[i] - std::complex<float>(2.0f * reference[i].real(),
+                                                     0.0f)),
+            1e-3f);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
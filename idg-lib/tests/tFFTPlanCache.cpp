@@ -0,0 +1,67 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+#include "fft/FFTPlanCache.h"
+
+BOOST_AUTO_TEST_SUITE(test_fft_plan_cache)
+
+BOOST_AUTO_TEST_CASE(reuse) {
+  idg::FFTPlanCache& cache = idg::FFTPlanCache::get_instance();
+
+  // Other tests may have created these plans already, therefore only the
+  // number of plans created by the repeated requests is checked
+  fftwf_plan plan = cache.get_plan_dft_2d(32, 32, FFTW_FORWARD, false);
+  size_t nr_plans = cache.get_nr_plans_created();
+  BOOST_CHECK_EQUAL(cache.get_plan_dft_2d(32, 32, FFTW_FORWARD, false), plan);
+  BOOST_CHECK_EQUAL(cache.get_nr_plans_created(), nr_plans);
+
+  // Every other direction, size or alignment requires a separate plan
+  const std::set<fftwf_plan> plans{
+      plan, cache.get_plan_dft_2d(32, 32, FFTW_BACKWARD, false),
+      cache.get_plan_dft_2d(32, 64, FFTW_FORWARD, false),
+      cache.get_plan_dft_2d(32, 32, FFTW_FORWARD, true),
+      cache.get_plan_dft_1d(32, FFTW_FORWARD, false)};
+  BOOST_CHECK_EQUAL(plans.size(), 5u);
+  BOOST_CHECK_LE(cache.get_nr_plans_created(), nr_plans + 4);
+
+  nr_plans = cache.get_nr_plans_created();
+  BOOST_CHECK(plans.count(cache.get_plan_dft_2d(32, 32, FFTW_BACKWARD, false)));
+  BOOST_CHECK(plans.count(cache.get_plan_dft_2d(32, 64, FFTW_FORWARD, false)));
+  BOOST_CHECK(plans.count(cache.get_plan_dft_2d(32, 32, FFTW_FORWARD, true)));
+  BOOST_CHECK(plans.count(cache.get_plan_dft_1d(32, FFTW_FORWARD, false)));
+  BOOST_CHECK_EQUAL(cache.get_nr_plans_created(), nr_plans);
+}
+
+BOOST_AUTO_TEST_CASE(execute) {
+  const int n = 16;
+  fftwf_complex* data = fftwf_alloc_complex(n * n);
+  for (int i = 0; i < n * n; i++) {
+    data[i][0] = i == 0;
+    data[i][1] = 0;
+  }
+
+  // The plans are created on scratch arrays and executed on data, the
+  // transform of a delta function is constant
+  const bool aligned = idg::FFTPlanCache::is_aligned(data);
+  fftwf_plan plan = idg::FFTPlanCache::get_instance().get_plan_dft_2d(
+      n, n, FFTW_FORWARD, aligned);
+  fftwf_execute_dft(plan, data, data);
+  for (int i = 0; i < n * n; i++) {
+    BOOST_CHECK_CLOSE(data[i][0], 1.0f, 1e-4);
+    BOOST_CHECK_SMALL(data[i][1], 1e-6f);
+  }
+
+  fftwf_free(data);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_rank) {
+  BOOST_CHECK_THROW(idg::FFTPlanCache::get_instance().get_plan_many_dft(
+                        3, nullptr, 1, 1, 1, FFTW_FORWARD, false),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
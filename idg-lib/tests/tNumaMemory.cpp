@@ -0,0 +1,85 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <unistd.h>
+
+#include "common/auxiliary.h"
+
+using idg::auxiliary::HugePages;
+using idg::auxiliary::NumaMemory;
+using idg::auxiliary::NumaPolicy;
+
+namespace {
+
+const size_t kHugePageSize = size_t(2) << 20;
+
+const std::vector<NumaPolicy> kNumaPolicies = {
+    NumaPolicy::kDefault, NumaPolicy::kInterleaved, NumaPolicy::kRowBands};
+const std::vector<HugePages> kHugePages = {
+    HugePages::kNone, HugePages::kTransparent, HugePages::kExplicit};
+
+bool is_aligned(void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+// Writes every byte of memory and reads it back
+void check_access(NumaMemory& memory) {
+  unsigned char* ptr = static_cast<unsigned char*>(memory.data());
+  for (size_t i = 0; i < memory.size(); i++) {
+    ptr[i] = i % 251;
+  }
+  for (size_t i = 0; i < memory.size(); i++) {
+    BOOST_REQUIRE_EQUAL(ptr[i], i % 251);
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(numa_memory)
+
+// Every combination succeeds, whether or not the system has NUMA nodes,
+// transparent huge pages or reserved huge pages
+BOOST_AUTO_TEST_CASE(policies) {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  for (NumaPolicy numa_policy : kNumaPolicies) {
+    for (HugePages huge_pages : kHugePages) {
+      for (size_t size : {size_t(0), size_t(1), page_size + 1,
+                          kHugePageSize - 1, 2 * kHugePageSize + 1}) {
+        NumaMemory memory(size, numa_policy, huge_pages);
+        BOOST_REQUIRE(memory.data());
+        BOOST_CHECK_EQUAL(memory.size(), size);
+        BOOST_CHECK(is_aligned(memory.data(), page_size));
+        check_access(memory);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(huge_page_alignment) {
+  for (HugePages huge_pages : {HugePages::kTransparent, HugePages::kExplicit}) {
+    NumaMemory memory(kHugePageSize, NumaPolicy::kDefault, huge_pages);
+    BOOST_CHECK(is_aligned(memory.data(), kHugePageSize));
+  }
+}
+
+// The memory reads as zeros, also after being reused
+BOOST_AUTO_TEST_CASE(zero) {
+  NumaMemory memory(3 * kHugePageSize, NumaPolicy::kInterleaved,
+                    HugePages::kTransparent);
+  const unsigned char* ptr = static_cast<unsigned char*>(memory.data());
+  for (size_t i = 0; i < memory.size(); i++) {
+    BOOST_REQUIRE_EQUAL(ptr[i], 0);
+  }
+  check_access(memory);
+  memory.zero();
+  for (size_t i = 0; i < memory.size(); i++) {
+    BOOST_REQUIRE_EQUAL(ptr[i], 0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
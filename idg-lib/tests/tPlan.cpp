@@ -0,0 +1,308 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <tuple>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/Plan.h"
+#include "common/Serialization.h"
+#include "common/WTiles.h"
+#include "plan-common.h"
+
+namespace {
+
+const int kKernelSize = 9;
+const int kSubgridSize = 32;
+const int kGridSize = 512;
+const float kCellSize = 0.001f;
+const int kNrWTiles = 4;
+const int kWTileSize = 32;
+const float kBaselineLength = 200.0f;
+
+// The baselines of the observation move through several w-tiles, such that
+// the four w-tiles do not suffice
+idg::Plan make_plan(Observation& observation, idg::WTiles& wtiles) {
+  idg::Plan::Options options;
+  options.w_step = 1.0f;
+  return idg::Plan(kKernelSize, kSubgridSize, kGridSize, kCellSize,
+                   {0.0f, 0.0f}, observation.get_frequencies(),
+                   observation.get_uvw(), observation.get_baselines(),
+                   observation.get_aterm_offsets(), wtiles, options);
+}
+
+// The subgrids of a plan, with the w-tile coordinates that the w-tiles are
+// assigned for
+std::vector<idg::Metadata> get_metadata(const idg::Plan& plan) {
+  const idg::Metadata* metadata = plan.get_metadata_ptr();
+  return std::vector<idg::Metadata>(metadata,
+                                    metadata + plan.get_nr_subgrids());
+}
+
+void check_equal(const idg::WTileUpdateSet& set,
+                 const idg::WTileUpdateSet& reference) {
+  BOOST_REQUIRE_EQUAL(set.size(), reference.size());
+  for (size_t i = 0; i < set.size(); i++) {
+    BOOST_CHECK_EQUAL(set[i].subgrid_index, reference[i].subgrid_index);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        set[i].wtile_ids.begin(), set[i].wtile_ids.end(),
+        reference[i].wtile_ids.begin(), reference[i].wtile_ids.end());
+    BOOST_REQUIRE_EQUAL(set[i].wtile_coordinates.size(),
+                        reference[i].wtile_coordinates.size());
+    for (size_t j = 0; j < set[i].wtile_coordinates.size(); j++) {
+      const idg::Coordinate& coordinate = set[i].wtile_coordinates[j];
+      const idg::Coordinate& reference_coordinate =
+          reference[i].wtile_coordinates[j];
+      BOOST_CHECK_EQUAL(coordinate.x, reference_coordinate.x);
+      BOOST_CHECK_EQUAL(coordinate.y, reference_coordinate.y);
+      BOOST_CHECK_EQUAL(coordinate.z, reference_coordinate.z);
+    }
+  }
+}
+
+// Position of (x, y) along the Z-order (Morton) curve, by interleaving bits
+uint64_t morton_key(uint32_t x, uint32_t y) {
+  uint64_t key = 0;
+  for (int bit = 0; bit < 32; bit++) {
+    key |= uint64_t((x >> bit) & 1) << (2 * bit);
+    key |= uint64_t((y >> bit) & 1) << (2 * bit + 1);
+  }
+  return key;
+}
+
+// Position of (x, y) along the Hilbert curve that fills an n x n square
+uint64_t hilbert_key(uint32_t n, uint32_t x, uint32_t y) {
+  uint64_t key = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    const uint32_t rx = (x & s) ? 1 : 0;
+    const uint32_t ry = (y & s) ? 1 : 0;
+    key += uint64_t(s) * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return key;
+}
+
+bool compare_bytes(const idg::Metadata& lhs, const idg::Metadata& rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(idg::Metadata)) < 0;
+}
+
+// Checks a plan with the given subgrid order against the plan of the same
+// observation in baseline order
+void check_subgrid_order(idg::Plan::SubgridOrder order) {
+  const int nr_baselines = 5;
+  const int nr_baselines_per_group = 2;
+  Observation observation(nr_baselines, 32, 0.0f, kBaselineLength, 0.5f);
+  idg::Plan::Options options;
+  options.w_step = 1.0f;
+  options.nr_w_layers = 16;
+  options.subgrid_order_nr_baselines = nr_baselines_per_group;
+  auto make_plan = [&](idg::Plan::SubgridOrder subgrid_order) {
+    options.subgrid_order = subgrid_order;
+    return idg::Plan(kKernelSize, kSubgridSize, kGridSize, kCellSize,
+                     {0.0f, 0.0f}, observation.get_frequencies(),
+                     observation.get_uvw(), observation.get_baselines(),
+                     observation.get_aterm_offsets(), options);
+  };
+  const idg::Plan reference_plan = make_plan(idg::Plan::BASELINE_ORDER);
+  const idg::Plan plan = make_plan(order);
+
+  BOOST_REQUIRE_EQUAL(plan.get_nr_subgrids(), reference_plan.get_nr_subgrids());
+  const std::vector<idg::Metadata> metadata = get_metadata(plan);
+  std::vector<idg::Metadata> reference_metadata = get_metadata(reference_plan);
+  std::set<int> w_indices;
+  int nr_subgrids = 0;
+  for (int bl = 0; bl < nr_baselines; bl += nr_baselines_per_group) {
+    const int n = std::min(nr_baselines_per_group, nr_baselines - bl);
+    const int first = plan.get_subgrid_offset(bl);
+    const int last = plan.get_subgrid_offset(bl + n);
+    BOOST_CHECK_EQUAL(first, reference_plan.get_subgrid_offset(bl));
+    BOOST_CHECK_EQUAL(last, reference_plan.get_subgrid_offset(bl + n));
+    BOOST_CHECK_EQUAL(plan.get_nr_subgrids(bl, n), last - first);
+    nr_subgrids += last - first;
+
+    // The group has the same subgrids
+    std::vector<idg::Metadata> group(metadata.begin() + first,
+                                     metadata.begin() + last);
+    std::sort(group.begin(), group.end(), compare_bytes);
+    std::sort(reference_metadata.begin() + first,
+              reference_metadata.begin() + last, compare_bytes);
+    BOOST_CHECK(std::equal(group.begin(), group.end(),
+                           reference_metadata.begin() + first,
+                           [](const idg::Metadata& a, const idg::Metadata& b) {
+                             return !compare_bytes(a, b) &&
+                                    !compare_bytes(b, a);
+                           }));
+
+    // Ordered by w index, then along the curve
+    std::tuple<int, uint64_t> previous_key(-1, 0);
+    for (int i = first; i < last; i++) {
+      const idg::Coordinate& coordinate = metadata[i].coordinate;
+      const uint32_t x = std::max(coordinate.x, 0);
+      const uint32_t y = std::max(coordinate.y, 0);
+      const std::tuple<int, uint64_t> key(
+          coordinate.z, order == idg::Plan::HILBERT_ORDER
+                            ? hilbert_key(kGridSize, x, y)
+                            : morton_key(x, y));
+      BOOST_CHECK(previous_key <= key);
+      previous_key = key;
+      w_indices.insert(coordinate.z);
+    }
+  }
+  BOOST_CHECK_EQUAL(nr_subgrids, plan.get_nr_subgrids());
+
+  // The observation covers several w-layers, such that the w index matters
+  BOOST_CHECK(w_indices.size() > 1);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_plan)
+
+BOOST_AUTO_TEST_CASE(save_load) {
+  Observation observation(3, 16, 0.0f, kBaselineLength);
+  idg::WTiles wtiles(kNrWTiles, kWTileSize);
+  const idg::Plan plan = make_plan(observation, wtiles);
+  BOOST_REQUIRE(plan.get_nr_subgrids() > 0);
+  BOOST_REQUIRE(plan.get_wtile_flush_set().size() > 0);
+
+  std::istringstream stream(save(plan));
+  idg::Plan loaded_plan;
+  loaded_plan.load(stream);
+  BOOST_CHECK_EQUAL(loaded_plan.get_nr_subgrids(), plan.get_nr_subgrids());
+  BOOST_CHECK_EQUAL(loaded_plan.get_nr_visibilities(),
+                    plan.get_nr_visibilities());
+  BOOST_CHECK_EQUAL(loaded_plan.get_wtile_flush_set().size(),
+                    plan.get_wtile_flush_set().size());
+  BOOST_CHECK(save(loaded_plan) == save(plan));
+}
+
+BOOST_AUTO_TEST_CASE(load_invalid_size) {
+  std::ostringstream output;
+  idg::serialization::write_vector(output, std::vector<int>{1, 2, 3});
+  std::string data = output.str();
+
+  // A size that exceeds the remaining data is rejected before allocating
+  const uint64_t invalid_size = uint64_t(1) << 62;
+  data.replace(0, sizeof(uint64_t),
+               reinterpret_cast<const char*>(&invalid_size), sizeof(uint64_t));
+  std::istringstream input(data);
+  std::vector<int> values;
+  BOOST_CHECK_THROW(idg::serialization::read_vector(input, values),
+                    std::runtime_error);
+
+  // A plan that ends prematurely is rejected as well
+  Observation observation(3, 16, 0.0f, kBaselineLength);
+  idg::WTiles wtiles(kNrWTiles, kWTileSize);
+  const std::string plan_data = save(make_plan(observation, wtiles));
+  std::istringstream plan_input(plan_data.substr(0, plan_data.size() / 2));
+  idg::Plan plan;
+  BOOST_CHECK_THROW(plan.load(plan_input), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(wtiles_save_load) {
+  Observation observation(3, 16, 0.0f, kBaselineLength);
+  Observation next_observation(3, 16, 1.0f, kBaselineLength);
+  idg::WTiles wtiles(kNrWTiles, kWTileSize);
+  make_plan(observation, wtiles);
+
+  std::istringstream stream(save(wtiles));
+  idg::WTiles loaded_wtiles;
+  loaded_wtiles.load(stream);
+  BOOST_CHECK_EQUAL(loaded_wtiles.get_wtile_buffer_size(), kNrWTiles);
+  BOOST_CHECK_EQUAL(loaded_wtiles.get_wtile_size(), kWTileSize);
+  BOOST_CHECK(save(loaded_wtiles) == save(wtiles));
+
+  // The restored state, including the order in which the w-tiles are
+  // retired, yields the same next plan
+  const idg::Plan plan = make_plan(next_observation, wtiles);
+  const idg::Plan loaded_plan = make_plan(next_observation, loaded_wtiles);
+  BOOST_CHECK(save(loaded_plan) == save(plan));
+  BOOST_CHECK(save(loaded_wtiles) == save(wtiles));
+}
+
+BOOST_AUTO_TEST_CASE(wtiles_add_subgrids) {
+  Observation observation(3, 16, 0.0f, kBaselineLength);
+  Observation next_observation(3, 16, 1.0f, kBaselineLength);
+  idg::WTiles plan_wtiles(kNrWTiles, kWTileSize);
+  const idg::Plan plan = make_plan(observation, plan_wtiles);
+  const idg::Plan next_plan = make_plan(next_observation, plan_wtiles);
+
+  // Assign the w-tiles of both plans in turn, the second plan starts with
+  // the w-tiles that are active after the first one
+  idg::WTiles wtiles(kNrWTiles, kWTileSize);
+  idg::WTiles reference_wtiles(kNrWTiles, kWTileSize);
+  for (const idg::Plan* p : {&plan, &next_plan}) {
+    std::vector<idg::Metadata> metadata = get_metadata(*p);
+    std::vector<idg::Metadata> reference_metadata = metadata;
+    wtiles.add_subgrids(metadata);
+    for (size_t i = 0; i < reference_metadata.size(); i++) {
+      reference_metadata[i].wtile_index = reference_wtiles.add_subgrid(
+          i, reference_metadata[i].wtile_coordinate);
+    }
+
+    for (size_t i = 0; i < metadata.size(); i++) {
+      BOOST_CHECK_EQUAL(metadata[i].wtile_index,
+                        reference_metadata[i].wtile_index);
+    }
+    const idg::WTileUpdateSet flush_set = wtiles.get_flush_set();
+    BOOST_CHECK(!flush_set.empty());
+    check_equal(flush_set, reference_wtiles.get_flush_set());
+    check_equal(wtiles.get_initialize_set(),
+                reference_wtiles.get_initialize_set());
+    BOOST_CHECK(save(wtiles) == save(reference_wtiles));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(wtiles_clear) {
+  Observation observation(3, 16, 0.0f, kBaselineLength);
+  idg::WTiles wtiles(kNrWTiles, kWTileSize);
+  const std::string initial_state = save(wtiles);
+
+  make_plan(observation, wtiles);
+  BOOST_CHECK(save(wtiles) != initial_state);
+
+  // The plans of the next major cycle see the same state as the first one
+  const idg::WTileUpdateInfo wtiles_to_flush = wtiles.clear();
+  BOOST_CHECK_EQUAL(wtiles_to_flush.wtile_ids.size(), size_t(kNrWTiles));
+  BOOST_CHECK(save(wtiles) == initial_state);
+}
+
+BOOST_AUTO_TEST_CASE(hilbert_key_reference) {
+  // Consecutive positions along the reference curve are neighbours
+  const uint32_t n = 16;
+  std::vector<std::pair<int, int>> positions(n * n);
+  for (uint32_t y = 0; y < n; y++) {
+    for (uint32_t x = 0; x < n; x++) {
+      positions[hilbert_key(n, x, y)] = {x, y};
+    }
+  }
+  for (size_t i = 1; i < positions.size(); i++) {
+    const int dx = positions[i].first - positions[i - 1].first;
+    const int dy = positions[i].second - positions[i - 1].second;
+    BOOST_CHECK_EQUAL(std::abs(dx) + std::abs(dy), 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(morton_order) {
+  check_subgrid_order(idg::Plan::MORTON_ORDER);
+}
+
+BOOST_AUTO_TEST_CASE(hilbert_order) {
+  check_subgrid_order(idg::Plan::HILBERT_ORDER);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
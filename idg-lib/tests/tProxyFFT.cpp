@@ -0,0 +1,51 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "CPU/Optimized/Optimized.h"
+#include "CPU/Reference/Reference.h"
+
+namespace {
+
+const unsigned int kNrCorrelations = 4;
+const unsigned int kGridSize = 64;
+
+// Transforms a point source in the centre of the image, which yields a
+// constant grid
+template <typename ProxyType>
+void check_transform() {
+  std::unique_ptr<idg::proxy::Proxy> proxy(new ProxyType());
+  std::vector<std::complex<float>> grid(kNrCorrelations * kGridSize *
+                                        kGridSize);
+  for (unsigned int pol = 0; pol < kNrCorrelations; pol++) {
+    const size_t centre = kGridSize / 2;
+    grid[(pol * kGridSize + centre) * kGridSize + centre] = 1.0f;
+  }
+
+  proxy->transform(idg::ImageDomainToFourierDomain, grid.data(),
+                   kNrCorrelations, kGridSize, kGridSize);
+  for (const std::complex<float>& pixel : grid) {
+    BOOST_REQUIRE_SMALL(std::abs(pixel - std::complex<float>(1.0f, 0.0f)),
+                        1e-4f);
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(proxy_fft)
+
+// The FFT plans are cached for the whole process, destroying a proxy must
+// leave them usable for the next proxy
+BOOST_AUTO_TEST_CASE(successive_proxies) {
+  for (int i = 0; i < 2; i++) {
+    check_transform<idg::proxy::cpu::Optimized>();
+    check_transform<idg::proxy::cpu::Reference>();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,76 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "CPU/Optimized/kernels/Isa.h"
+#include "CPU/Optimized/kernels/Sincos.h"
+
+using idg::kernel::cpu::optimized::IsaLevel;
+using idg::kernel::cpu::optimized::SincosAccuracy;
+
+namespace {
+
+// Returns the largest absolute error of sin and cos for phases in
+// [-range, range], compared to double precision
+double compute_sincos_error(SincosAccuracy accuracy, IsaLevel isa_level,
+                            double range) {
+  idg::kernel::cpu::optimized::set_sincos_accuracy(accuracy);
+  idg::kernel::cpu::optimized::set_isa_level(isa_level);
+
+  // Use an odd number of phases, to also exercise the remainder loop
+  const unsigned n = 100003;
+  std::vector<float> x(n);
+  std::vector<float> sin(n);
+  std::vector<float> cos(n);
+  for (unsigned i = 0; i < n; i++) {
+    x[i] = -range + (2 * range * i) / (n - 1);
+  }
+
+  idg::kernel::cpu::optimized::compute_sincos_polynomial(n, x.data(),
+                                                         sin.data(),
+                                                         cos.data());
+
+  double error = 0;
+  for (unsigned i = 0; i < n; i++) {
+    const double x_i = x[i];
+    error = std::max(error, std::abs(sin[i] - std::sin(x_i)));
+    error = std::max(error, std::abs(cos[i] - std::cos(x_i)));
+  }
+  return error;
+}
+
+void check_sincos_error(SincosAccuracy accuracy, double max_error) {
+  const IsaLevel detected = idg::kernel::cpu::optimized::detect_isa_level();
+  for (IsaLevel isa_level : {IsaLevel::kScalar, IsaLevel::kAvx,
+                             IsaLevel::kAvx2, IsaLevel::kAvx512}) {
+    if (isa_level > detected) {
+      continue;
+    }
+    for (double range : {M_PI, 1e3, 1e5}) {
+      BOOST_TEST_CONTEXT("isa " << get_isa_name(isa_level) << ", range "
+                                << range) {
+        BOOST_CHECK_LT(compute_sincos_error(accuracy, isa_level, range),
+                       max_error);
+      }
+    }
+  }
+  idg::kernel::cpu::optimized::set_isa_level(detected);
+  idg::kernel::cpu::optimized::set_sincos_accuracy(SincosAccuracy::kFull);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_sincos)
+
+BOOST_AUTO_TEST_CASE(full) { check_sincos_error(SincosAccuracy::kFull, 2e-6); }
+
+BOOST_AUTO_TEST_CASE(imaging) {
+  check_sincos_error(SincosAccuracy::kImaging, 2e-4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
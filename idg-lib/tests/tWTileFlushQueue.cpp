@@ -0,0 +1,212 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "CPU/Optimized/WTileFlushQueue.h"
+
+using idg::kernel::cpu::WTileFlushQueue;
+
+namespace {
+
+const size_t kNrWTiles = 8;
+const size_t kNrPolarizations = 4;
+const size_t kPaddedWTileSize = 6;
+const size_t kWTileSize =
+    kNrPolarizations * kPaddedWTileSize * kPaddedWTileSize;
+
+const WTileFlushQueue::Parameters kParameters{
+    int(kNrPolarizations), 16, 2, 4, 1.0f, 1.0f, {0.0f, 0.0f}};
+
+// Stub for the adder: adds every w-tile, summed over its pixels, to the grid
+// at index coordinate.x, and records the order of the calls by coordinate.y
+// of the first w-tile. A w-tile with coordinate.z == 1 raises an error.
+class StubAdder {
+ public:
+  WTileFlushQueue::AddFunction get_function() {
+    return [this](const WTileFlushQueue::Parameters&, int nr_tiles,
+                  const int* tile_ids, const idg::Coordinate* coordinates,
+                  std::complex<float>* tiles, std::complex<float>* grid) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [&] { return !blocked_; });
+        calls_.push_back(coordinates[0].y);
+      }
+      if (coordinates[0].z == 1) {
+        throw std::runtime_error("stub adder failed");
+      }
+      for (int i = 0; i < nr_tiles; i++) {
+        const std::complex<float>* tile = &tiles[tile_ids[i] * kWTileSize];
+        for (size_t j = 0; j < kWTileSize; j++) {
+          grid[coordinates[i].x] += tile[j];
+        }
+      }
+    };
+  }
+
+  // While blocked, the calls wait until release is called
+  void block() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocked_ = true;
+  }
+
+  void release() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      blocked_ = false;
+    }
+    released_.notify_all();
+  }
+
+  std::vector<int> get_calls() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return calls_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable released_;
+  bool blocked_ = false;
+  std::vector<int> calls_;
+};
+
+xt::xtensor<std::complex<float>, 4> make_wtiles_buffer() {
+  return xt::xtensor<std::complex<float>, 4>(
+      {kNrWTiles, kNrPolarizations, kPaddedWTileSize, kPaddedWTileSize},
+      std::complex<float>(0.0f, 0.0f));
+}
+
+// Fills w-tile wtile_id with value and returns the event that flushes it to
+// grid index grid_index
+idg::WTileUpdateInfo make_flush(xt::xtensor<std::complex<float>, 4>& buffer,
+                                int wtile_id, int grid_index, int call,
+                                float value, int z = 0) {
+  std::fill_n(&buffer(wtile_id, 0, 0, 0), kWTileSize,
+              std::complex<float>(value, 0.0f));
+  idg::WTileUpdateInfo flush;
+  flush.subgrid_index = 0;
+  flush.wtile_ids = {wtile_id};
+  flush.wtile_coordinates = {{grid_index, call, z}};
+  return flush;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(wtile_flush_queue)
+
+BOOST_AUTO_TEST_CASE(order) {
+  StubAdder adder;
+  xt::xtensor<std::complex<float>, 4> buffer = make_wtiles_buffer();
+  std::vector<std::complex<float>> grid(kNrWTiles, 0.0f);
+  std::vector<std::complex<float>> expected_grid(kNrWTiles, 0.0f);
+  std::vector<int> expected_calls;
+
+  WTileFlushQueue queue(2, 1, adder.get_function());
+  for (int call = 0; call < 20; call++) {
+    const int wtile_id = call % kNrWTiles;
+    const float value = call + 1;
+    queue.push(kParameters, make_flush(buffer, wtile_id, wtile_id, call, value),
+               buffer, grid.data());
+    expected_grid[wtile_id] += float(kWTileSize) * value;
+    expected_calls.push_back(call);
+
+    // The slot of the w-tile is reset right away
+    for (size_t j = 0; j < kWTileSize; j++) {
+      BOOST_CHECK_EQUAL((&buffer(wtile_id, 0, 0, 0))[j],
+                        std::complex<float>(0.0f, 0.0f));
+    }
+  }
+  queue.synchronize();
+
+  const std::vector<int> calls = adder.get_calls();
+  BOOST_CHECK_EQUAL_COLLECTIONS(calls.begin(), calls.end(),
+                                expected_calls.begin(), expected_calls.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(grid.begin(), grid.end(),
+                                expected_grid.begin(), expected_grid.end());
+}
+
+BOOST_AUTO_TEST_CASE(push_blocks) {
+  StubAdder adder;
+  xt::xtensor<std::complex<float>, 4> buffer = make_wtiles_buffer();
+  std::vector<std::complex<float>> grid(kNrWTiles, 0.0f);
+
+  WTileFlushQueue queue(2, 1, adder.get_function());
+  adder.block();
+
+  // The first flush is processed (and blocked) by the worker, the second one
+  // is pending, such that the third push has to wait
+  queue.push(kParameters, make_flush(buffer, 0, 0, 0, 1.0f), buffer,
+             grid.data());
+  queue.push(kParameters, make_flush(buffer, 1, 1, 1, 1.0f), buffer,
+             grid.data());
+  const idg::WTileUpdateInfo third_flush = make_flush(buffer, 2, 2, 2, 1.0f);
+  std::future<void> third_push = std::async(std::launch::async, [&] {
+    queue.push(kParameters, third_flush, buffer, grid.data());
+  });
+  BOOST_CHECK(third_push.wait_for(std::chrono::milliseconds(100)) ==
+              std::future_status::timeout);
+
+  adder.release();
+  third_push.get();
+  queue.synchronize();
+  BOOST_CHECK_EQUAL(adder.get_calls().size(), 3u);
+  for (int i = 0; i < 3; i++) {
+    BOOST_CHECK_EQUAL(grid[i], std::complex<float>(float(kWTileSize), 0.0f));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(errors) {
+  StubAdder adder;
+  xt::xtensor<std::complex<float>, 4> buffer = make_wtiles_buffer();
+  std::vector<std::complex<float>> grid(kNrWTiles, 0.0f);
+
+  WTileFlushQueue queue(2, 1, adder.get_function());
+  queue.push(kParameters, make_flush(buffer, 0, 0, 0, 1.0f, 1), buffer,
+             grid.data());
+  BOOST_CHECK_THROW(queue.synchronize(), std::runtime_error);
+
+  // The error is reported once, later flushes are still processed
+  BOOST_CHECK_NO_THROW(queue.synchronize());
+  queue.push(kParameters, make_flush(buffer, 1, 1, 1, 1.0f), buffer,
+             grid.data());
+  BOOST_CHECK_NO_THROW(queue.synchronize());
+  BOOST_CHECK_EQUAL(grid[1], std::complex<float>(float(kWTileSize), 0.0f));
+}
+
+BOOST_AUTO_TEST_CASE(destructor_drains) {
+  StubAdder adder;
+  xt::xtensor<std::complex<float>, 4> buffer = make_wtiles_buffer();
+  std::vector<std::complex<float>> grid(kNrWTiles, 0.0f);
+
+  std::future<void> release;
+  {
+    WTileFlushQueue queue(2, 1, adder.get_function());
+    adder.block();
+    queue.push(kParameters, make_flush(buffer, 0, 0, 0, 1.0f), buffer,
+               grid.data());
+    queue.push(kParameters, make_flush(buffer, 1, 1, 1, 1.0f), buffer,
+               grid.data());
+    release = std::async(std::launch::async, [&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      adder.release();
+    });
+  }
+
+  // The destructor has waited for both flushes
+  BOOST_CHECK_EQUAL(adder.get_calls().size(), 2u);
+  BOOST_CHECK_EQUAL(grid[0], std::complex<float>(float(kWTileSize), 0.0f));
+  BOOST_CHECK_EQUAL(grid[1], std::complex<float>(float(kWTileSize), 0.0f));
+  release.get();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
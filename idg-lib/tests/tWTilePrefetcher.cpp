@@ -0,0 +1,147 @@
+// Copyright (C) 2026 ASTRON (Netherlands Institute for Radio Astronomy)
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <complex>
+#include <vector>
+
+#include "CPU/common/InstanceCPU.h"
+#include "CPU/Optimized/WTilePrefetcher.h"
+#include "CPU/Optimized/kernels/Kernels.h"
+
+using idg::kernel::cpu::WTilePrefetcher;
+
+namespace {
+
+const size_t kNrWTiles = 8;
+const int kNrPolarizations = 4;
+const int kGridSize = 128;
+const int kSubgridSize = 8;
+const int kWTileSize = 16;
+const size_t kPaddedWTileSize = kWTileSize + kSubgridSize;
+
+const WTilePrefetcher::Parameters kParameters{
+    kNrPolarizations, kGridSize, kSubgridSize, kWTileSize, 0.05f, 2.0f,
+    {0.0f, 0.0f}};
+
+std::vector<std::complex<float>> make_grid(float offset) {
+  std::vector<std::complex<float>> grid(size_t(kNrPolarizations) * kGridSize *
+                                        kGridSize);
+  for (size_t i = 0; i < grid.size(); i++) {
+    grid[i] = {offset + float(i % 13), float(i % 7) - 3.0f};
+  }
+  return grid;
+}
+
+xt::xtensor<std::complex<float>, 4> make_wtiles_buffer() {
+  return xt::xtensor<std::complex<float>, 4>(
+      {kNrWTiles, size_t(kNrPolarizations), kPaddedWTileSize,
+       kPaddedWTileSize},
+      std::complex<float>(0.0f, 0.0f));
+}
+
+// Three initialize events of a few w-tiles each, with different w
+idg::WTileUpdateSet make_initialize_set() {
+  idg::WTileUpdateSet wtile_initialize_set(3);
+  int wtile_id = 0;
+  for (int event = 0; event < 3; event++) {
+    idg::WTileUpdateInfo& info = wtile_initialize_set[event];
+    info.subgrid_index = 10 * event;
+    for (int i = 0; i < 2 + event; i++) {
+      info.wtile_ids.push_back(wtile_id++ % kNrWTiles);
+      info.wtile_coordinates.push_back({i + 1, event + 2, event - 1});
+    }
+  }
+  return wtile_initialize_set;
+}
+
+// Initialize the w-tiles of info as the splitter does without prefetching
+void initialize_inline(const idg::WTileUpdateInfo& info,
+                       xt::xtensor<std::complex<float>, 4>& wtiles_buffer,
+                       const std::complex<float>* grid) {
+  const WTilePrefetcher::Parameters& p = kParameters;
+  idg::kernel::cpu::optimized::kernel_splitter_wtiles_from_grid(
+      p.nr_polarizations, p.grid_size, p.subgrid_size, p.wtile_size,
+      p.image_size, p.w_step, p.shift.data(), info.wtile_ids.size(),
+      info.wtile_ids.data(), info.wtile_coordinates.data(),
+      wtiles_buffer.data(), grid);
+}
+
+void check_wtiles(const idg::WTileUpdateInfo& info,
+                  xt::xtensor<std::complex<float>, 4>& wtiles_buffer,
+                  xt::xtensor<std::complex<float>, 4>& reference) {
+  const size_t sizeof_wtile =
+      kNrPolarizations * kPaddedWTileSize * kPaddedWTileSize;
+  for (int wtile_id : info.wtile_ids) {
+    const std::complex<float>* wtile = &wtiles_buffer(wtile_id, 0, 0, 0);
+    const std::complex<float>* reference_wtile =
+        &reference(wtile_id, 0, 0, 0);
+    for (size_t i = 0; i < sizeof_wtile; i++) {
+      BOOST_CHECK_SMALL(std::abs(wtile[i] - reference_wtile[i]), 1e-4f);
+    }
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(wtile_prefetcher)
+
+BOOST_AUTO_TEST_CASE(matches_inline) {
+  const std::vector<std::complex<float>> grid = make_grid(0.0f);
+  xt::xtensor<std::complex<float>, 4> wtiles_buffer = make_wtiles_buffer();
+  xt::xtensor<std::complex<float>, 4> reference = make_wtiles_buffer();
+
+  // As in the splitter: every event is fetched, after which the next events
+  // are prefetched
+  WTilePrefetcher prefetcher(2, 2);
+  idg::WTileUpdateSet wtile_initialize_set = make_initialize_set();
+  prefetcher.prefetch(kParameters, wtile_initialize_set, grid.data());
+  while (!wtile_initialize_set.empty()) {
+    const idg::WTileUpdateInfo& info = wtile_initialize_set.front();
+    BOOST_CHECK(prefetcher.fetch(info, wtiles_buffer));
+    initialize_inline(info, reference, grid.data());
+    check_wtiles(info, wtiles_buffer, reference);
+    wtile_initialize_set.pop_front();
+    prefetcher.prefetch(kParameters, wtile_initialize_set, grid.data());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(fallback) {
+  const std::vector<std::complex<float>> grid = make_grid(0.0f);
+  xt::xtensor<std::complex<float>, 4> wtiles_buffer = make_wtiles_buffer();
+  xt::xtensor<std::complex<float>, 4> reference = make_wtiles_buffer();
+  const idg::WTileUpdateSet wtile_initialize_set = make_initialize_set();
+
+  WTilePrefetcher prefetcher(2, 2);
+
+  // Nothing was prefetched
+  BOOST_CHECK(!prefetcher.fetch(wtile_initialize_set[0], wtiles_buffer));
+
+  // An event that does not match the prefetched one is initialized by the
+  // caller, and discards the prefetched w-tiles
+  prefetcher.prefetch(kParameters, wtile_initialize_set, grid.data());
+  idg::WTileUpdateInfo other_info = wtile_initialize_set[0];
+  other_info.wtile_coordinates[0].x++;
+  BOOST_CHECK(!prefetcher.fetch(other_info, wtiles_buffer));
+  BOOST_CHECK(!prefetcher.fetch(wtile_initialize_set[0], wtiles_buffer));
+
+  // An event that was skipped makes the prefetched events stale
+  prefetcher.prefetch(kParameters, wtile_initialize_set, grid.data());
+  BOOST_CHECK(!prefetcher.fetch(wtile_initialize_set[1], wtiles_buffer));
+
+  // After clear, nothing is prefetched
+  prefetcher.prefetch(kParameters, wtile_initialize_set, grid.data());
+  prefetcher.clear();
+  BOOST_CHECK(!prefetcher.fetch(wtile_initialize_set[0], wtiles_buffer));
+
+  // Prefetching for another grid replaces the prefetched w-tiles
+  const std::vector<std::complex<float>> other_grid = make_grid(1.0f);
+  prefetcher.prefetch(kParameters, wtile_initialize_set, grid.data());
+  prefetcher.prefetch(kParameters, wtile_initialize_set, other_grid.data());
+  BOOST_CHECK(prefetcher.fetch(wtile_initialize_set[0], wtiles_buffer));
+  initialize_inline(wtile_initialize_set[0], reference, other_grid.data());
+  check_wtiles(wtile_initialize_set[0], wtiles_buffer, reference);
+}
+
+BOOST_AUTO_TEST_SUITE_END()